@@ -35,6 +35,7 @@ Channel::Channel(Fluid* s, int num)
       _preset = 0;
       banknum = 0;
       prognum = 0;
+      synth->publishProgram(channum, banknum, prognum);
       reset();
       }
 
@@ -123,11 +124,11 @@ void Channel::setcc(int num, int value)
                   break;
 
             case ALL_NOTES_OFF:
-                  synth->allNotesOff(channum);
+                  synth->notesOff(channum);
                   break;
 
             case ALL_SOUND_OFF:
-                  synth->allSoundsOff(channum);
+                  synth->soundsOff(channum);
                   break;
 
             case ALL_CTRL_OFF:
@@ -213,15 +214,37 @@ void Channel::pitchWheelSens(int val)
       synth->modulate_voices(channum, false, FLUID_MOD_PITCHWHEELSENS);
       }
 
+//---------------------------------------------------------
+//   setBanknum
+//---------------------------------------------------------
+
+void Channel::setBanknum(unsigned int b)
+      {
+      banknum = b;
+      synth->publishProgram(channum, banknum, prognum);
+      }
+
+//---------------------------------------------------------
+//   setPrognum
+//---------------------------------------------------------
+
+void Channel::setPrognum(int p)
+      {
+      prognum = p;
+      synth->publishProgram(channum, banknum, prognum);
+      }
+
 //---------------------------------------------------------
 //   setPreset
+//    load is false for presets whose samples a control
+//    thread has already loaded
 //---------------------------------------------------------
 
-void Channel::setPreset(Preset* p)
+void Channel::setPreset(Preset* p, bool load)
       {
       if (_preset != p) {
-            if (p)
-                  p->loadSamples();
+            if (p && load)
+                  synth->loadSamples(p);
             _preset = p;
             }
       }
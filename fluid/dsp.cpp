@@ -21,6 +21,7 @@
 #include "fluid.h"
 #include "voice.h"
 #include "sfont.h"
+#include "dspkernels.h"
 
 namespace FluidS {
 
@@ -107,6 +108,20 @@ void Voice::dsp_float_config()
       fluid_check_fpe("interpolation table calculation");
       }
 
+//---------------------------------------------------------
+//   loadedPoint
+//    a point at the loop or sample boundary, read before
+//    the phase gets there; while the sample streams in it
+//    may not be loaded yet. Voice::write() holds blocks
+//    which would reach it, so the last loaded frame is
+//    read instead.
+//---------------------------------------------------------
+
+static inline short loadedPoint(const short* data, int i, unsigned last)
+      {
+      return data[unsigned(i) < last ? unsigned(i) : last];
+      }
+
 //-------------------------------------------------------------------
 //   fluid_dsp_float_interpolate_none
 //    No interpolation. Just take the sample, which is closest to
@@ -208,14 +223,21 @@ int Voice::dsp_float_interpolate_linear(unsigned n)
 
       /* 2nd interpolation point to use at end of loop or sample */
       if (looping)
-            point = dsp_data[voice->loopstart];      /* loop start */
+            point = loadedPoint(dsp_data, voice->loopstart, voice->dsp_last);      /* loop start */
       else
-            point = dsp_data[voice->end];             /* duplicate end for samples no longer looping */
+            point = loadedPoint(dsp_data, voice->end, voice->dsp_last);             /* duplicate end for samples no longer looping */
 
       while (1) {
             dsp_phase_index = dsp_phase.index();
 
-            /* interpolate the sequence of sample points */
+            /* interpolate the sequence of sample points; the kernel renders
+             * all of them, the loop only runs if it cannot be used */
+            if (unsigned k = DspKernels::frames(dsp_phase, dsp_phase_incr, end_index, n - dsp_i)) {
+                  DspKernels::active()->linear(dsp_data, interp_coeff_linear[0], &dsp_phase,
+                     dsp_phase_incr.data, &dsp_amp, dsp_amp_incr, dsp_buf + dsp_i, k);
+                  dsp_i += k;
+                  dsp_phase_index = dsp_phase.index();
+                  }
             for ( ; dsp_i < n && dsp_phase_index <= end_index; dsp_i++) {
                   coeffs = interp_coeff_linear[fluid_phase_fract_to_tablerow (dsp_phase)];
                   dsp_buf[dsp_i] = dsp_amp * (coeffs[0] * dsp_data[dsp_phase_index]
@@ -296,20 +318,20 @@ int Voice::dsp_float_interpolate_4th_order(unsigned n)
 
       if (has_looped) {	/* set start_index and start point if looped or not */
             start_index = loopstart;
-            start_point = dsp_data[loopend - 1];	/* last point in loop (wrap around) */
+            start_point = loadedPoint(dsp_data, loopend - 1, dsp_last);	/* last point in loop (wrap around) */
             }
       else {
             start_index = start;
-            start_point = dsp_data[start];	/* just duplicate the point */
+            start_point = loadedPoint(dsp_data, start, dsp_last);	/* just duplicate the point */
             }
 
       /* get points off the end (loop start if looping, duplicate point if end) */
       if (looping) {
-            end_point1 = dsp_data[loopstart];
-            end_point2 = dsp_data[loopstart + 1];
+            end_point1 = loadedPoint(dsp_data, loopstart, dsp_last);
+            end_point2 = loadedPoint(dsp_data, loopstart + 1, dsp_last);
             }
       else {
-            end_point1 = dsp_data[end];
+            end_point1 = loadedPoint(dsp_data, end, dsp_last);
             end_point2 = end_point1;
             }
 
@@ -330,7 +352,14 @@ int Voice::dsp_float_interpolate_4th_order(unsigned n)
                   amp += dsp_amp_incr;
                   }
 
-            /* interpolate the sequence of sample points */
+            /* interpolate the sequence of sample points; the kernel renders
+             * all of them, the loop only runs if it cannot be used */
+            if (unsigned k = DspKernels::frames(phase, dsp_phase_incr, end_index, n - dsp_i)) {
+                  DspKernels::active()->fourthOrder(dsp_data, interp_coeff[0], &phase,
+                     dsp_phase_incr.data, &amp, dsp_amp_incr, dsp_buf + dsp_i, k);
+                  dsp_i += k;
+                  dsp_phase_index = phase.index();
+                  }
             for ( ; dsp_i < n && dsp_phase_index <= end_index; dsp_i++) {
                   coeffs = interp_coeff[fluid_phase_fract_to_tablerow (phase)];
                   dsp_buf[dsp_i] = amp * (coeffs[0] * dsp_data[dsp_phase_index-1]
@@ -442,25 +471,25 @@ int Voice::dsp_float_interpolate_7th_order(unsigned n)
 
       if (voice->has_looped) { /* set start_index and start point if looped or not */
             start_index = voice->loopstart;
-            start_points[0] = dsp_data[voice->loopend - 1];
-            start_points[1] = dsp_data[voice->loopend - 2];
-            start_points[2] = dsp_data[voice->loopend - 3];
+            start_points[0] = loadedPoint(dsp_data, voice->loopend - 1, voice->dsp_last);
+            start_points[1] = loadedPoint(dsp_data, voice->loopend - 2, voice->dsp_last);
+            start_points[2] = loadedPoint(dsp_data, voice->loopend - 3, voice->dsp_last);
             }
       else {
             start_index = voice->start;
-            start_points[0] = dsp_data[voice->start];	/* just duplicate the start point */
+            start_points[0] = loadedPoint(dsp_data, voice->start, voice->dsp_last);	/* just duplicate the start point */
             start_points[1] = start_points[0];
             start_points[2] = start_points[0];
             }
 
       /* get the 3 points off the end (loop start if looping, duplicate point if end) */
       if (looping) {
-            end_points[0] = dsp_data[voice->loopstart];
-            end_points[1] = dsp_data[voice->loopstart + 1];
-            end_points[2] = dsp_data[voice->loopstart + 2];
+            end_points[0] = loadedPoint(dsp_data, voice->loopstart, voice->dsp_last);
+            end_points[1] = loadedPoint(dsp_data, voice->loopstart + 1, voice->dsp_last);
+            end_points[2] = loadedPoint(dsp_data, voice->loopstart + 2, voice->dsp_last);
             }
       else {
-            end_points[0] = dsp_data[voice->end];
+            end_points[0] = loadedPoint(dsp_data, voice->end, voice->dsp_last);
             end_points[1] = end_points[0];
             end_points[2] = end_points[0];
             }
@@ -528,7 +557,14 @@ int Voice::dsp_float_interpolate_7th_order(unsigned n)
 
             start_index -= 2;	/* set back to original start index */
 
-            /* interpolate the sequence of sample points */
+            /* interpolate the sequence of sample points; the kernel renders
+             * all of them, the loop only runs if it cannot be used */
+            if (unsigned k = DspKernels::frames(dsp_phase, dsp_phase_incr, end_index, n - dsp_i)) {
+                  DspKernels::active()->seventhOrder(dsp_data, sinc_table7[0], &dsp_phase,
+                     dsp_phase_incr.data, &dsp_amp, dsp_amp_incr, dsp_buf + dsp_i, k);
+                  dsp_i += k;
+                  dsp_phase_index = dsp_phase.index();
+                  }
             for ( ; dsp_i < n && dsp_phase_index <= end_index; dsp_i++) {
                   coeffs = sinc_table7[fluid_phase_fract_to_tablerow (dsp_phase)];
 
@@ -0,0 +1,429 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2016 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <string.h>
+#include "dspkernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLUID_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 code is compiled with a function target attribute and only
+// called after a cpu check, so no special compiler flags are needed
+#if defined(FLUID_SSE2) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define FLUID_AVX2
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace FluidS {
+
+//---------------------------------------------------------
+//   frames
+//    number of frames, at most n, for which the phase
+//    index stays <= endIndex
+//---------------------------------------------------------
+
+unsigned DspKernels::frames(Phase phase, Phase incr, unsigned endIndex, unsigned n)
+      {
+      if (incr.data <= 0 || endIndex >= 0x7fffffff)
+            return 0;
+      qint64 limit = (qint64(endIndex) + 1) << 32;    // first phase past endIndex
+      if (phase.data >= limit)
+            return 0;
+      qint64 steps = (limit - 1 - phase.data) / incr.data + 1;
+      return steps < n ? unsigned(steps) : n;
+      }
+
+//---------------------------------------------------------
+//   interpolateScalar
+//    TAPS coefficients per table row, the first tap is at
+//    index + FIRST
+//---------------------------------------------------------
+
+template <int TAPS, int FIRST>
+static void interpolateScalar(const short* data, const float* table, Phase* phase, qint64 incr,
+   float* amp, float ampIncr, float* out, unsigned n)
+      {
+      Phase p = *phase;
+      float a = *amp;
+      for (unsigned i = 0; i < n; ++i) {
+            const float* c = table + fluid_phase_fract_to_tablerow(p) * TAPS;
+            const short* d = data + p.index() + FIRST;
+            float v = c[0] * (float)d[0];
+            for (int k = 1; k < TAPS; ++k)
+                  v += c[k] * (float)d[k];
+            out[i] = a * v;
+            p.data += incr;
+            a      += ampIncr;
+            }
+      *phase = p;
+      *amp   = a;
+      }
+
+//---------------------------------------------------------
+//   mixScalar
+//---------------------------------------------------------
+
+static void mixScalar(const float* in, unsigned n, float left, float right,
+   float reverb, float chorus, float* out, float* reverbOut, float* chorusOut)
+      {
+      for (unsigned i = 0; i < n; ++i) {
+            float v    = in[i];
+
+            float vv   = v * left;
+            *out++       += vv;
+            *reverbOut++ += vv * reverb;
+            *chorusOut++ += vv * chorus;
+
+            vv         = v * right;
+            *out++       += vv;
+            *reverbOut++ += vv * reverb;
+            *chorusOut++ += vv * chorus;
+            }
+      }
+
+static const DspKernels scalarKernels = {
+      DspKernels::Type::SCALAR, "scalar",
+      interpolateScalar<2, 0>,
+      interpolateScalar<4, -1>,
+      interpolateScalar<7, -3>,
+      mixScalar
+      };
+
+#ifdef FLUID_SSE2
+
+//---------------------------------------------------------
+//   loadQuad
+//    four consecutive shorts as floats
+//---------------------------------------------------------
+
+static inline __m128 loadQuad(const short* p)
+      {
+      __m128i v = _mm_loadl_epi64((const __m128i*)p);
+      return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+      }
+
+//---------------------------------------------------------
+//   loadPair
+//    two consecutive shorts as 32 bit word
+//---------------------------------------------------------
+
+static inline int loadPair(const short* p)
+      {
+      int v;
+      memcpy(&v, p, sizeof(v));
+      return v;
+      }
+
+//---------------------------------------------------------
+//   Sse2Sum
+//    the interpolation sums of four frames. idx is the
+//    first sample point, row the first coefficient of
+//    each frame. Points and coefficients are loaded per
+//    frame and transposed into one vector per tap.
+//---------------------------------------------------------
+
+template <int TAPS> struct Sse2Sum;
+
+template <> struct Sse2Sum<2> {
+      static inline __m128 sum(const short* data, const float* table, const int* idx, const int* row) {
+            __m128 c01 = _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd((const double*)(table + row[0])), (const double*)(table + row[1])));
+            __m128 c23 = _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd((const double*)(table + row[2])), (const double*)(table + row[3])));
+            __m128 c0  = _mm_shuffle_ps(c01, c23, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 c1  = _mm_shuffle_ps(c01, c23, _MM_SHUFFLE(3, 1, 3, 1));
+            __m128i w  = _mm_setr_epi32(loadPair(data + idx[0]), loadPair(data + idx[1]),
+                                        loadPair(data + idx[2]), loadPair(data + idx[3]));
+            __m128 d0  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(w, 16), 16));
+            __m128 d1  = _mm_cvtepi32_ps(_mm_srai_epi32(w, 16));
+            return _mm_add_ps(_mm_mul_ps(c0, d0), _mm_mul_ps(c1, d1));
+            }
+      };
+
+template <> struct Sse2Sum<4> {
+      static inline __m128 sum(const short* data, const float* table, const int* idx, const int* row) {
+            __m128 c0 = _mm_loadu_ps(table + row[0]);
+            __m128 c1 = _mm_loadu_ps(table + row[1]);
+            __m128 c2 = _mm_loadu_ps(table + row[2]);
+            __m128 c3 = _mm_loadu_ps(table + row[3]);
+            __m128 d0 = loadQuad(data + idx[0]);
+            __m128 d1 = loadQuad(data + idx[1]);
+            __m128 d2 = loadQuad(data + idx[2]);
+            __m128 d3 = loadQuad(data + idx[3]);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _MM_TRANSPOSE4_PS(d0, d1, d2, d3);
+            __m128 v = _mm_mul_ps(c0, d0);
+            v = _mm_add_ps(v, _mm_mul_ps(c1, d1));
+            v = _mm_add_ps(v, _mm_mul_ps(c2, d2));
+            return _mm_add_ps(v, _mm_mul_ps(c3, d3));
+            }
+      };
+
+// taps 0-3 and 3-6 are transposed separately, tap 3 is used once
+template <> struct Sse2Sum<7> {
+      static inline __m128 sum(const short* data, const float* table, const int* idx, const int* row) {
+            __m128 v = Sse2Sum<4>::sum(data, table, idx, row);
+            __m128 c0 = _mm_loadu_ps(table + row[0] + 3);
+            __m128 c1 = _mm_loadu_ps(table + row[1] + 3);
+            __m128 c2 = _mm_loadu_ps(table + row[2] + 3);
+            __m128 c3 = _mm_loadu_ps(table + row[3] + 3);
+            __m128 d0 = loadQuad(data + idx[0] + 3);
+            __m128 d1 = loadQuad(data + idx[1] + 3);
+            __m128 d2 = loadQuad(data + idx[2] + 3);
+            __m128 d3 = loadQuad(data + idx[3] + 3);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _MM_TRANSPOSE4_PS(d0, d1, d2, d3);
+            v = _mm_add_ps(v, _mm_mul_ps(c1, d1));
+            v = _mm_add_ps(v, _mm_mul_ps(c2, d2));
+            return _mm_add_ps(v, _mm_mul_ps(c3, d3));
+            }
+      };
+
+//---------------------------------------------------------
+//   interpolateSse2
+//    four frames at a time; the phase is advanced in
+//    scalar code, it is a 64 bit fixed point value
+//---------------------------------------------------------
+
+template <int TAPS, int FIRST>
+static void interpolateSse2(const short* data, const float* table, Phase* phase, qint64 incr,
+   float* amp, float ampIncr, float* out, unsigned n)
+      {
+      Phase p = *phase;
+      float a = *amp;
+      unsigned i = 0;
+      for (; i + 4 <= n; i += 4) {
+            int idx[4];
+            int row[4];
+            float av[4];
+            for (int l = 0; l < 4; ++l) {
+                  idx[l] = p.index() + FIRST;
+                  row[l] = fluid_phase_fract_to_tablerow(p) * TAPS;
+                  av[l]  = a;
+                  p.data += incr;
+                  a      += ampIncr;
+                  }
+            __m128 v = Sse2Sum<TAPS>::sum(data, table, idx, row);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(av), v));
+            }
+      *phase = p;
+      *amp   = a;
+      if (i < n)
+            interpolateScalar<TAPS, FIRST>(data, table, phase, incr, amp, ampIncr, out + i, n - i);
+      }
+
+//---------------------------------------------------------
+//   mixSse2
+//---------------------------------------------------------
+
+static void mixSse2(const float* in, unsigned n, float left, float right,
+   float reverb, float chorus, float* out, float* reverbOut, float* chorusOut)
+      {
+      __m128 gain = _mm_setr_ps(left, right, left, right);
+      __m128 rv   = _mm_set1_ps(reverb);
+      __m128 ch   = _mm_set1_ps(chorus);
+      unsigned i  = 0;
+      for (; i + 4 <= n; i += 4) {
+            __m128 v  = _mm_loadu_ps(in + i);
+            __m128 lo = _mm_mul_ps(_mm_unpacklo_ps(v, v), gain);
+            __m128 hi = _mm_mul_ps(_mm_unpackhi_ps(v, v), gain);
+            float* o  = out + i * 2;
+            float* r  = reverbOut + i * 2;
+            float* c  = chorusOut + i * 2;
+            _mm_storeu_ps(o,     _mm_add_ps(_mm_loadu_ps(o), lo));
+            _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), hi));
+            _mm_storeu_ps(r,     _mm_add_ps(_mm_loadu_ps(r), _mm_mul_ps(lo, rv)));
+            _mm_storeu_ps(r + 4, _mm_add_ps(_mm_loadu_ps(r + 4), _mm_mul_ps(hi, rv)));
+            _mm_storeu_ps(c,     _mm_add_ps(_mm_loadu_ps(c), _mm_mul_ps(lo, ch)));
+            _mm_storeu_ps(c + 4, _mm_add_ps(_mm_loadu_ps(c + 4), _mm_mul_ps(hi, ch)));
+            }
+      if (i < n)
+            mixScalar(in + i, n - i, left, right, reverb, chorus, out + i * 2, reverbOut + i * 2, chorusOut + i * 2);
+      }
+
+static const DspKernels sse2Kernels = {
+      DspKernels::Type::SSE2, "sse2",
+      interpolateSse2<2, 0>,
+      interpolateSse2<4, -1>,
+      interpolateSse2<7, -3>,
+      mixSse2
+      };
+
+#endif
+
+#ifdef FLUID_AVX2
+
+//---------------------------------------------------------
+//   AVX2 helpers
+//    eight frames are handled as two groups of four in
+//    the lower and upper 128 bit lanes
+//---------------------------------------------------------
+
+AVX2_TARGET static inline __m256 loadRows(const float* table, const int* row, int l, int tap)
+      {
+      return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(table + row[l] + tap)),
+         _mm_loadu_ps(table + row[l + 4] + tap), 1);
+      }
+
+AVX2_TARGET static inline __m256 loadQuads(const short* data, const int* idx, int l, int tap)
+      {
+      __m128i lo = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(data + idx[l] + tap)));
+      __m128i hi = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(data + idx[l + 4] + tap)));
+      return _mm256_cvtepi32_ps(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1));
+      }
+
+AVX2_TARGET static inline void transpose(__m256& r0, __m256& r1, __m256& r2, __m256& r3)
+      {
+      __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+      __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+      __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+      __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+      r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+      r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+      r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+      r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+      }
+
+//---------------------------------------------------------
+//   sumAvx2
+//    like Sse2Sum for eight frames and four or seven taps
+//---------------------------------------------------------
+
+template <int TAPS>
+AVX2_TARGET static inline __m256 sumAvx2(const short* data, const float* table, const int* idx, const int* row)
+      {
+      __m256 c0 = loadRows(table, row, 0, 0);
+      __m256 c1 = loadRows(table, row, 1, 0);
+      __m256 c2 = loadRows(table, row, 2, 0);
+      __m256 c3 = loadRows(table, row, 3, 0);
+      __m256 d0 = loadQuads(data, idx, 0, 0);
+      __m256 d1 = loadQuads(data, idx, 1, 0);
+      __m256 d2 = loadQuads(data, idx, 2, 0);
+      __m256 d3 = loadQuads(data, idx, 3, 0);
+      transpose(c0, c1, c2, c3);
+      transpose(d0, d1, d2, d3);
+      __m256 v = _mm256_mul_ps(c0, d0);
+      v = _mm256_add_ps(v, _mm256_mul_ps(c1, d1));
+      v = _mm256_add_ps(v, _mm256_mul_ps(c2, d2));
+      v = _mm256_add_ps(v, _mm256_mul_ps(c3, d3));
+      if (TAPS == 7) {
+            c0 = loadRows(table, row, 0, 3);
+            c1 = loadRows(table, row, 1, 3);
+            c2 = loadRows(table, row, 2, 3);
+            c3 = loadRows(table, row, 3, 3);
+            d0 = loadQuads(data, idx, 0, 3);
+            d1 = loadQuads(data, idx, 1, 3);
+            d2 = loadQuads(data, idx, 2, 3);
+            d3 = loadQuads(data, idx, 3, 3);
+            transpose(c0, c1, c2, c3);
+            transpose(d0, d1, d2, d3);
+            v = _mm256_add_ps(v, _mm256_mul_ps(c1, d1));
+            v = _mm256_add_ps(v, _mm256_mul_ps(c2, d2));
+            v = _mm256_add_ps(v, _mm256_mul_ps(c3, d3));
+            }
+      return v;
+      }
+
+//---------------------------------------------------------
+//   interpolateAvx2
+//    eight frames at a time
+//---------------------------------------------------------
+
+template <int TAPS, int FIRST>
+AVX2_TARGET static void interpolateAvx2(const short* data, const float* table, Phase* phase, qint64 incr,
+   float* amp, float ampIncr, float* out, unsigned n)
+      {
+      Phase p = *phase;
+      float a = *amp;
+      unsigned i = 0;
+      for (; i + 8 <= n; i += 8) {
+            int idx[8];
+            int row[8];
+            float av[8];
+            for (int l = 0; l < 8; ++l) {
+                  idx[l] = p.index() + FIRST;
+                  row[l] = fluid_phase_fract_to_tablerow(p) * TAPS;
+                  av[l]  = a;
+                  p.data += incr;
+                  a      += ampIncr;
+                  }
+            __m256 v = sumAvx2<TAPS>(data, table, idx, row);
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(av), v));
+            }
+      *phase = p;
+      *amp   = a;
+      if (i < n)
+            interpolateScalar<TAPS, FIRST>(data, table, phase, incr, amp, ampIncr, out + i, n - i);
+      }
+
+// linear interpolation and mixing gain nothing from the wider
+// registers, the SSE2 versions are used
+static const DspKernels avx2Kernels = {
+      DspKernels::Type::AVX2, "avx2",
+      interpolateSse2<2, 0>,
+      interpolateAvx2<4, -1>,
+      interpolateAvx2<7, -3>,
+      mixSse2
+      };
+
+#endif
+
+//---------------------------------------------------------
+//   get
+//---------------------------------------------------------
+
+const DspKernels* DspKernels::get(Type t)
+      {
+      switch (t) {
+            case Type::AUTO:
+                  if (const DspKernels* k = get(Type::AVX2))
+                        return k;
+                  if (const DspKernels* k = get(Type::SSE2))
+                        return k;
+                  break;
+            case Type::SCALAR:
+                  break;
+            case Type::SSE2:
+#ifdef FLUID_SSE2
+                  return &sse2Kernels;
+#else
+                  return 0;
+#endif
+            case Type::AVX2:
+#ifdef FLUID_AVX2
+                  __builtin_cpu_init();
+                  if (__builtin_cpu_supports("avx2"))
+                        return &avx2Kernels;
+#endif
+                  return 0;
+            }
+      return &scalarKernels;
+      }
+
+const DspKernels* DspKernels::_active = DspKernels::get(DspKernels::Type::AUTO);
+
+//---------------------------------------------------------
+//   select
+//    use other kernels, for testing and benchmarks
+//---------------------------------------------------------
+
+bool DspKernels::select(Type t)
+      {
+      const DspKernels* k = get(t);
+      if (!k)
+            return false;
+      _active = k;
+      return true;
+      }
+
+}
@@ -0,0 +1,63 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2016 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __DSPKERNELS_H__
+#define __DSPKERNELS_H__
+
+#include "fluid.h"
+
+namespace FluidS {
+
+//---------------------------------------------------------
+//   DspKernels
+//    inner loops of the voice rendering in scalar, SSE2
+//    and AVX2 versions; the best one supported by the cpu
+//    is selected at runtime.
+//
+//    The interpolation kernels render n frames which all
+//    lie between the start and end handling of the loops
+//    in dsp.cpp, advancing phase and amp like them. They
+//    compute the same sums in the same order as the scalar
+//    code, so all versions give identical results.
+//---------------------------------------------------------
+
+struct DspKernels {
+      enum class Type : char {
+            AUTO, SCALAR, SSE2, AVX2
+            };
+
+      // table: FLUID_INTERP_MAX rows of coefficients, one per tap
+      typedef void (*Interpolate)(const short* data, const float* table, Phase* phase, qint64 incr,
+         float* amp, float ampIncr, float* out, unsigned n);
+      // add the mono signal in to the interleaved stereo buffers
+      typedef void (*Mix)(const float* in, unsigned n, float left, float right,
+         float reverb, float chorus, float* out, float* reverbOut, float* chorusOut);
+
+      Type type;
+      const char* name;
+      Interpolate linear;           // taps index .. index + 1
+      Interpolate fourthOrder;      // taps index - 1 .. index + 2
+      Interpolate seventhOrder;     // taps index - 3 .. index + 3
+      Mix mix;
+
+      static const DspKernels* get(Type);   // 0 if not supported on this cpu
+      static const DspKernels* active()     { return _active; }
+      static bool select(Type);
+
+      static unsigned frames(Phase phase, Phase incr, unsigned endIndex, unsigned n);
+
+   private:
+      static const DspKernels* _active;
+      };
+
+}
+#endif
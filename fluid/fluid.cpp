@@ -18,7 +18,6 @@
  * 02111-1307, USA
  */
 
-#include "synthesizer/event.h"
 #include "synthesizer/msynthesizer.h"
 #include "mscore/preferences.h"
 
@@ -27,6 +26,7 @@
 #include "conv.h"
 #include "gen.h"
 #include "voice.h"
+#include "sampleloader.h"
 
 namespace FluidS {
 using namespace Ms;
@@ -73,6 +73,8 @@ static const Mod forcePanMod = { GEN_PAN, 10, FLUID_MOD_CC | FLUID_MOD_LINEAR |
 Fluid::Fluid()
    : Synthesizer()
       {
+      for (std::atomic<int>& p : programs)
+            p = -1;
       }
 
 //---------------------------------------------------------
@@ -108,6 +110,19 @@ void Fluid::init(float sampleRate)
 Fluid::~Fluid()
       {
       _state = FLUID_SYNTH_STOPPED;
+      if (_streaming)
+            SampleLoader::instance()->detach(&sampleRequests);
+      // soundfont lists never seen by the audio thread
+      while (!cmdFifo.isEmpty()) {
+            FluidCmd cmd = cmdFifo.dequeue();
+            if (cmd.type == FluidCmd::Type::SFONTS)
+                  execute(cmd);
+            }
+      for (const FluidCmd& cmd : cmdOverflow) {
+            if (cmd.type == FluidCmd::Type::SFONTS)
+                  execute(cmd);
+            }
+      collectGarbage();
       foreach(Voice* v, activeVoices)
             delete v;
       foreach(Voice* v, freeVoices)
@@ -133,6 +148,23 @@ void Fluid::freeVoice(Voice* v)
 //---------------------------------------------------------
 
 void Fluid::play(const PlayEvent& event)
+      {
+      if (deferred()) {
+            FluidCmd cmd;
+            cmd.type  = FluidCmd::Type::EVENT;
+            cmd.event = event;
+            post(cmd);
+            return;
+            }
+      playEvent(event);
+      }
+
+//---------------------------------------------------------
+//   playEvent
+//    called by the thread owning the channels
+//---------------------------------------------------------
+
+void Fluid::playEvent(const PlayEvent& event)
       {
       bool err = false;
       int ch   = event.channel();
@@ -216,6 +248,23 @@ void Fluid::damp_voices(int chan)
 //---------------------------------------------------------
 
 void Fluid::allNotesOff(int chan)
+      {
+      if (deferred()) {
+            FluidCmd cmd;
+            cmd.type    = FluidCmd::Type::NOTES_OFF;
+            cmd.channel = chan;
+            post(cmd);
+            return;
+            }
+      notesOff(chan);
+      }
+
+//---------------------------------------------------------
+//   notesOff
+//    called by the thread owning the channels
+//---------------------------------------------------------
+
+void Fluid::notesOff(int chan)
       {
       foreach(Voice* v, activeVoices) {
             if (chan == -1 || v->chan == chan)
@@ -230,6 +279,23 @@ void Fluid::allNotesOff(int chan)
 //---------------------------------------------------------
 
 void Fluid::allSoundsOff(int chan)
+      {
+      if (deferred()) {
+            FluidCmd cmd;
+            cmd.type    = FluidCmd::Type::SOUNDS_OFF;
+            cmd.channel = chan;
+            post(cmd);
+            return;
+            }
+      soundsOff(chan);
+      }
+
+//---------------------------------------------------------
+//   soundsOff
+//    called by the thread owning the channels
+//---------------------------------------------------------
+
+void Fluid::soundsOff(int chan)
       {
       foreach(Voice* v, activeVoices) {
             if (chan == -1 || v->chan == chan)
@@ -389,17 +455,205 @@ void Fluid::update_presets()
             c->setPreset(get_preset(c->getSfontnum(), c->getBanknum(), c->getPrognum()));
       }
 
+//---------------------------------------------------------
+//   loadSamples
+//    load the samples of a preset selected for a channel;
+//    without streaming they are read right away. While
+//    rendering, this runs in process() and queues them
+//    without locking.
+//---------------------------------------------------------
+
+void Fluid::loadSamples(Preset* p)
+      {
+      if (!_streaming)
+            p->loadSamples(false);
+      else if (_rendering)
+            p->loadSamples(true, &sampleRequests);
+      else
+            p->loadSamples(true);
+      }
+
+//---------------------------------------------------------
+//   setStreaming
+//---------------------------------------------------------
+
+void Fluid::setStreaming(bool val)
+      {
+      if (_streaming == val)
+            return;
+      _streaming = val;
+      if (val)
+            SampleLoader::instance()->attach(&sampleRequests);
+      else
+            SampleLoader::instance()->detach(&sampleRequests);
+      }
+
+//---------------------------------------------------------
+//   publishProgram
+//    called by the thread owning the channels when the
+//    program of a channel changes
+//---------------------------------------------------------
+
+void Fluid::publishProgram(int chan, int bank, int prog)
+      {
+      if (chan < FLUID_PUBLISHED_CHANNELS)
+            programs[chan] = bank << 8 | prog;
+      }
+
+//---------------------------------------------------------
+//   FluidCmdFifo
+//---------------------------------------------------------
+
+FluidCmdFifo::FluidCmdFifo()
+      {
+      maxCount = FLUID_CMD_FIFO_SIZE;
+      clear();
+      }
+
+//---------------------------------------------------------
+//   enqueue
+//---------------------------------------------------------
+
+bool FluidCmdFifo::enqueue(const FluidCmd& cmd)
+      {
+      if (isFull())
+            return false;
+      cmds[widx] = cmd;
+      push();
+      return true;
+      }
+
+//---------------------------------------------------------
+//   dequeue
+//---------------------------------------------------------
+
+FluidCmd FluidCmdFifo::dequeue()
+      {
+      FluidCmd cmd = cmds[ridx];
+      pop();
+      return cmd;
+      }
+
+//---------------------------------------------------------
+//   deferred
+//    true while a driver calls process(); the channels
+//    and voices then belong to process(), which may run
+//    on a different thread for every block, and all
+//    changes are posted to it instead of being applied
+//    directly
+//---------------------------------------------------------
+
+bool Fluid::deferred() const
+      {
+      return _rendering;
+      }
+
+//---------------------------------------------------------
+//   post
+//    queue a request for process(); nothing is lost: a
+//    request which does not fit into the fifo goes to
+//    the overflow list, as do all later ones until
+//    process() has taken the list
+//---------------------------------------------------------
+
+void Fluid::post(const FluidCmd& cmd)
+      {
+      cmdMutex.lock();
+      if (_overflow || !cmdFifo.enqueue(cmd)) {
+            cmdOverflow.append(cmd);
+            _overflow = true;
+            }
+      cmdMutex.unlock();
+      }
+
+//---------------------------------------------------------
+//   executeCommands
+//    run the posted requests in order. process() does
+//    not wait for the overflow list if a control thread
+//    is posting and takes it with the next block.
+//---------------------------------------------------------
+
+void Fluid::executeCommands(bool wait)
+      {
+      while (!cmdFifo.isEmpty())
+            execute(cmdFifo.dequeue());
+      if (!_overflow)
+            return;
+      if (wait)
+            cmdMutex.lock();
+      else if (!cmdMutex.tryLock())
+            return;
+      // requests in the fifo were posted before the list was used
+      int n = cmdFifo.count();
+      QList<FluidCmd> l;
+      l.swap(cmdOverflow);
+      _overflow = false;
+      cmdMutex.unlock();
+      while (n--)
+            execute(cmdFifo.dequeue());
+      for (const FluidCmd& cmd : l)
+            execute(cmd);
+      }
+
+//---------------------------------------------------------
+//   execute
+//    run a posted request in the audio thread
+//---------------------------------------------------------
+
+void Fluid::execute(const FluidCmd& cmd)
+      {
+      switch (cmd.type) {
+            case FluidCmd::Type::EVENT:
+                  playEvent(cmd.event);
+                  break;
+            case FluidCmd::Type::NOTES_OFF:
+                  notesOff(cmd.channel);
+                  break;
+            case FluidCmd::Type::SOUNDS_OFF:
+                  soundsOff(cmd.channel);
+                  break;
+            case FluidCmd::Type::SFONTS:
+                  applySoundFonts(cmd);
+                  // fonts are deleted by the next control thread request
+                  if (!garbageFifo.enqueue(cmd))
+                        qDebug("Fluid: garbage fifo overflow");
+                  break;
+            }
+      }
+
+//---------------------------------------------------------
+//   audioStopped
+//    the driver does not call process() anymore; queued
+//    requests are applied here and later ones directly
+//---------------------------------------------------------
+
+void Fluid::audioStopped()
+      {
+      mutex.lock();
+      _rendering = false;
+      executeCommands(true);
+      collectGarbage();
+      mutex.unlock();
+      }
+
 //---------------------------------------------------------
 //   process
+//    never blocks; requests from control threads are
+//    applied first
 //---------------------------------------------------------
 
 void Fluid::process(unsigned len, float* out, float* effect1, float* effect2)
       {
-      if (mutex.tryLock()) {
-            foreach (Voice* v, activeVoices)
-                  v->write(len, out, effect1, effect2);
-            mutex.unlock();
-            }
+      _rendering = true;
+      executeCommands(false);
+
+      QElapsedTimer timer;
+      timer.start();
+      foreach (Voice* v, activeVoices)
+            v->write(len, out, effect1, effect2);
+      // count blocks which took longer to render than to play
+      if (timer.nsecsElapsed() * sample_rate > len * 1e9)
+            ++_dropouts;
       }
 
 /*
@@ -555,8 +809,44 @@ void Fluid::start_voice(Voice* voice)
       voice->voice_start();
       }
 
+//---------------------------------------------------------
+//   bankCount
+//---------------------------------------------------------
+
+static int bankCount(const SFont* sf)
+      {
+      int banks = 0;
+      for (Preset* p : sf->getPresets()) {
+            if (p->get_banknum() > banks)
+                  banks = p->get_banknum();
+            }
+      return banks + 1;
+      }
+
+//---------------------------------------------------------
+//   findPreset
+//    find_preset() for a soundfont list which is not
+//    installed yet, with the bank offsets which
+//    updateBankOffsets() will assign
+//---------------------------------------------------------
+
+static Preset* findPreset(const QList<SFont*>& fonts, int bank, int prog)
+      {
+      int bankOffset = 0;
+      for (SFont* sf : fonts) {
+            for (Preset* p : sf->getPresets()) {
+                  if (p->get_banknum() + bankOffset == bank && p->get_num() == prog)
+                        return p;
+                  }
+            bankOffset += bankCount(sf);
+            }
+      return 0;
+      }
+
 //---------------------------------------------------------
 //   updatePatchList
+//    control thread side, uses the same bank offsets as
+//    updateBankOffsets()
 //---------------------------------------------------------
 
 void Fluid::updatePatchList()
@@ -565,26 +855,31 @@ void Fluid::updatePatchList()
       patches.clear();
 
       int bankOffset = 0;
-      for (SFont* sf : sfonts) {
-            sf->setBankOffset(bankOffset);
-            int banks = 0;
+      for (SFont* sf : sfontList) {
             for (Preset* p : sf->getPresets()) {
                   MidiPatch* patch = new MidiPatch;
                   patch->drum = (p->get_banknum() == 128);
                   patch->synti = name();
-                  if (p->get_banknum() > banks)
-                        banks = p->get_banknum();
                   patch->bank = p->get_banknum() + bankOffset;
                   patch->prog = p->get_num();
                   patch->name = p->get_name();
                   patches.append(patch);
                   }
-            bankOffset += (banks + 1);
+            bankOffset += bankCount(sf);
+            }
+      }
+
+//---------------------------------------------------------
+//   updateBankOffsets
+//---------------------------------------------------------
+
+void Fluid::updateBankOffsets()
+      {
+      int bankOffset = 0;
+      for (SFont* sf : sfonts) {
+            sf->setBankOffset(bankOffset);
+            bankOffset += bankCount(sf);
             }
-      /* try to set the correct presets */
-      int n = channel.size();
-      for (int i = 0; i < n; i++)
-            program_change(i, channel[i]->getPrognum());
       }
 
 //---------------------------------------------------------
@@ -594,7 +889,7 @@ void Fluid::updatePatchList()
 QStringList Fluid::soundFonts() const
       {
       QStringList sf;
-      foreach (SFont* f, sfonts)
+      foreach (SFont* f, sfontList)
             sf.append(QFileInfo(f->get_name()).fileName());
       return sf;
       }
@@ -606,21 +901,16 @@ QStringList Fluid::soundFonts() const
 
 bool Fluid::loadSoundFonts(const QStringList& sl)
       {
+      mutex.lock();
       QStringList ol = soundFonts();
       if (ol == sl) {
+            mutex.unlock();
             qDebug("Fluid:loadSoundFonts: already loaded");
             return true;
             }
-      mutex.lock();
-      foreach(Voice* v, activeVoices)
-            v->off();
-      foreach(Channel* c, channel)
-            c->reset();
-      foreach (SFont* sf, sfonts)
-            sfunload(sf->id());
+      QList<SFont*> fonts;
       bool ok = true;
 
-
       QFileInfoList l = sfFiles();
 
       for (int i = sl.size() - 1; i >= 0; --i) {
@@ -641,12 +931,16 @@ bool Fluid::loadSoundFonts(const QStringList& sl)
                   ok = false;
                   }
             else {
-                  if (sfload(path) == -1) {
+                  SFont* sf = sfload(path);
+                  if (sf)
+                        fonts.prepend(sf);
+                  else {
                         qDebug("loading sf failed: <%s>", qPrintable(path));
                         ok = false;
                         }
                   }
             }
+      setSoundFonts(fonts, true);
       mutex.unlock();
       return ok;
       }
@@ -659,7 +953,15 @@ bool Fluid::loadSoundFonts(const QStringList& sl)
 bool Fluid::addSoundFont(const QString& s)
       {
       mutex.lock();
-      bool rv = (sfload(s) == -1) ? false : true;
+      bool rv = false;
+      SFont* sf = sfload(s);
+      if (sf) {
+            /* insert the sfont as the first one on the list */
+            QList<SFont*> fonts(sfontList);
+            fonts.prepend(sf);
+            setSoundFonts(fonts, false);
+            rv = true;
+            }
       mutex.unlock();
       return rv;
       }
@@ -672,66 +974,156 @@ bool Fluid::addSoundFont(const QString& s)
 bool Fluid::removeSoundFont(const QString& s)
       {
       mutex.lock();
-      foreach(Voice* v, activeVoices)
-            v->off();
+      bool rv = false;
       SFont* sf = get_sfont_by_name(s);
-      sfunload(sf->id());
+      if (sf) {
+            QList<SFont*> fonts(sfontList);
+            fonts.removeAll(sf);
+            setSoundFonts(fonts, false);
+            rv = true;
+            }
       mutex.unlock();
-      return true;
+      return rv;
       }
 
 //---------------------------------------------------------
 //   sfload
+//    read a soundfont; it is not used before it is
+//    passed to setSoundFonts()
 //---------------------------------------------------------
 
-int Fluid::sfload(const QString& filename)
+SFont* Fluid::sfload(const QString& filename)
       {
       if (filename.isEmpty())
-            return -1;
+            return 0;
 
       SFont* sf = new SFont(this);
       try {
             if (!sf->read(filename)) {
                   delete sf;
-                  sf = 0;
-                  return -1;
+                  return 0;
                   }
             }
       catch(...) {
             delete sf;
-            sf = 0;
-            return -1;
+            return 0;
             }
-
       sf->setId(++sfont_id);
+      if (_streaming)
+            SampleLoader::instance()->preload(sf->samples());
+      return sf;
+      }
 
-      /* insert the sfont as the first one on the list */
-      sfonts.prepend(sf);
-
-      /* reset the presets for all channels */
+//---------------------------------------------------------
+//   setSoundFonts
+//    replace the list of soundfonts; called with mutex
+//    locked. While rendering, the new list is posted to
+//    process() and the old fonts are returned to be
+//    deleted later.
+//---------------------------------------------------------
 
+void Fluid::setSoundFonts(const QList<SFont*>& l, bool reset)
+      {
+      collectGarbage();
+
+      FluidCmd cmd;
+      cmd.type    = FluidCmd::Type::SFONTS;
+      cmd.reset   = reset;
+      cmd.sfonts  = new QList<SFont*>(l);
+      cmd.presets = preparePresets(l);
+
+      if (deferred())
+            post(cmd);
+      else {
+            applySoundFonts(cmd);
+            qDeleteAll(*cmd.sfonts);
+            delete cmd.sfonts;
+            delete cmd.presets;
+            }
+      sfontList = l;
       updatePatchList();
-      return sf->id();
       }
 
 //---------------------------------------------------------
-//   sfunload
+//   preparePresets
+//    control thread side of setSoundFonts(): select the
+//    presets program_change() will select from fonts for
+//    the channels and load their samples, so that the
+//    audio thread does not read sample data when the
+//    fonts are installed
+//---------------------------------------------------------
+
+QVector<ChannelPreset>* Fluid::preparePresets(const QList<SFont*>& fonts)
+      {
+      QVector<ChannelPreset>* pl = new QVector<ChannelPreset>;
+      for (const std::atomic<int>& p : programs) {
+            int program = p;
+            if (program < 0)
+                  break;
+            Preset* preset = findPreset(fonts, program >> 8, program & 0xff);
+            if (!preset)
+                  preset = findPreset(fonts, 0, 0);
+            if (preset)
+                  preset->loadSamples(_streaming);
+            pl->append(ChannelPreset { program, preset });
+            }
+      return pl;
+      }
+
+//---------------------------------------------------------
+//   applySoundFonts
+//    audio thread side of setSoundFonts(); on return
+//    cmd.sfonts holds the fonts which are not used anymore
 //---------------------------------------------------------
 
-bool Fluid::sfunload(int id)
+void Fluid::applySoundFonts(const FluidCmd& cmd)
       {
-      SFont* sf = get_sfont_by_id(id);
+      QList<SFont*>* l = cmd.sfonts;
+      sfonts.swap(*l);
+      for (int i = l->size() - 1; i >= 0; --i) {
+            if (sfonts.contains(l->at(i)))
+                  l->removeAt(i);
+            }
+      // voices may play samples of removed fonts
+      if (cmd.reset || !l->isEmpty()) {
+            while (!activeVoices.isEmpty())
+                  activeVoices.first()->off();
+            }
+      updateBankOffsets();
+      if (cmd.reset) {
+            foreach(Channel* c, channel)
+                  c->reset();
+            }
 
-      if (!sf) {
-            qDebug("No SoundFont with id = %d", id);
-            return false;
+      // install the presets prepared by the control thread; a
+      // channel whose program changed since then, or which
+      // was not published, selects its preset here
+      int n = channel.size();
+      for (int i = 0; i < n; i++) {
+            Channel* c = channel[i];
+            const ChannelPreset* cp = i < cmd.presets->size() ? &cmd.presets->at(i) : 0;
+            if (cp && cp->program == int(c->getBanknum() << 8 | c->getPrognum())) {
+                  c->setSfontnum(cp->preset ? cp->preset->sfont->id() : 0);
+                  c->setPreset(cp->preset, false);
+                  }
+            else
+                  program_change(i, c->getPrognum());
             }
+      }
 
-      sfonts.removeAll(sf);   // remove the SoundFont from the list
-      updatePatchList();
+//---------------------------------------------------------
+//   collectGarbage
+//    delete fonts returned by the audio thread
+//---------------------------------------------------------
 
-      delete sf;
-      return true;
+void Fluid::collectGarbage()
+      {
+      while (!garbageFifo.isEmpty()) {
+            FluidCmd cmd = garbageFifo.dequeue();
+            qDeleteAll(*cmd.sfonts);
+            delete cmd.sfonts;
+            delete cmd.presets;
+            }
       }
 
 //---------------------------------------------------------
@@ -753,7 +1145,7 @@ SFont* Fluid::get_sfont_by_id(int id)
 
 SFont* Fluid::get_sfont_by_name(const QString& name)
       {
-      foreach(SFont* sf, sfonts) {
+      foreach(SFont* sf, sfontList) {
             if (QFileInfo(sf->get_name()).fileName() == name)
                   return sf;
             }
@@ -22,8 +22,12 @@
 #ifndef __FLUID_S_H__
 #define __FLUID_S_H__
 
+#include <atomic>
 #include "synthesizer/synthesizer.h"
 #include "synthesizer/midipatch.h"
+#include "synthesizer/event.h"
+#include "libmscore/fifo.h"
+#include "sampleloader.h"
 
 namespace FluidS {
 
@@ -267,13 +271,13 @@ class Channel {
       void initCtrl();
       void setCC(int n, int val)          { cc[n] = val; }
       void reset();
-      void setPreset(Preset* p);
+      void setPreset(Preset* p, bool load = true);
       Preset* preset() const              { return _preset;  }
       unsigned int getSfontnum() const    { return sfontnum; }
       void setSfontnum(unsigned int s)    { sfontnum = s;    }
       unsigned int getBanknum() const     { return banknum;  }
-      void setBanknum(unsigned int b)     { banknum = b;     }
-      void setPrognum(int p)              { prognum = p;     }
+      void setBanknum(unsigned int b);
+      void setPrognum(int p);
       int getPrognum() const              { return prognum;  }
       void setcc(int ctrl, int val);
       void pitchBend(int val);
@@ -290,12 +294,58 @@ enum {
       FLUID_GROUP  = 0,
       };
 
+//---------------------------------------------------------
+//   ChannelPreset
+//    preset selected by a control thread for a channel
+//---------------------------------------------------------
+
+struct ChannelPreset {
+      int program;                  // bank << 8 | program the preset was selected for
+      Preset* preset;
+      };
+
+//---------------------------------------------------------
+//   FluidCmd
+//    request from a control thread, executed by the
+//    audio thread at the start of the next process()
+//---------------------------------------------------------
+
+struct FluidCmd {
+      enum class Type : char { EVENT, NOTES_OFF, SOUNDS_OFF, SFONTS };
+      Type type;
+      int channel;                  // NOTES_OFF, SOUNDS_OFF
+      bool reset;                   // SFONTS: reset all channels
+      PlayEvent event;              // EVENT
+      QList<SFont*>* sfonts;        // SFONTS: new soundfont list, returned
+                                    // with the fonts no longer used
+      QVector<ChannelPreset>* presets;    // SFONTS: channel presets selected
+                                          // by the control thread
+      };
+
+//---------------------------------------------------------
+//   FluidCmdFifo
+//---------------------------------------------------------
+
+static const int FLUID_CMD_FIFO_SIZE = 1024;
+
+class FluidCmdFifo : public FifoBase {
+      FluidCmd cmds[FLUID_CMD_FIFO_SIZE];
+
+   public:
+      FluidCmdFifo();
+      bool enqueue(const FluidCmd&);      // returns false if full
+      FluidCmd dequeue();
+      };
+
 //---------------------------------------------------------
 //   Fluid
 //---------------------------------------------------------
 
+static const int FLUID_PUBLISHED_CHANNELS = 1024;    // channels whose program is seen by control threads
+
 class Fluid : public Synthesizer {
-      QList<SFont*> sfonts;               // the loaded soundfonts
+      QList<SFont*> sfonts;               // the loaded soundfonts, used by the audio thread
+      QList<SFont*> sfontList;            // the loaded soundfonts as seen by control threads
       QList<MidiPatch*> patches;
 
       QList<Voice*> freeVoices;           // unused synthesis processes
@@ -308,8 +358,30 @@ class Fluid : public Synthesizer {
       float _masterTuning;                // usually 440.0
       double _tuning[128];                // the pitch of every key, in cents
 
-      QMutex mutex;
+      QMutex mutex;                       // serializes control threads, never locked in process()
+      QMutex cmdMutex;                    // serializes post(), held only briefly; process() only tries it
+      FluidCmdFifo cmdFifo;               // control threads -> audio thread
+      QList<FluidCmd> cmdOverflow;        // requests which did not fit into cmdFifo, guarded by cmdMutex
+      std::atomic<bool> _overflow { false };    // cmdOverflow is in use
+      FluidCmdFifo garbageFifo;           // audio thread -> control threads: unused soundfonts
+      std::atomic<bool> _rendering { false };   // a driver calls process(), changes are posted
+      std::atomic<int> _dropouts { 0 };
+      bool _streaming { false };          // load samples in the background
+      SampleRequestFifo sampleRequests;   // audio thread -> loader thread
+      std::atomic<int> programs[FLUID_PUBLISHED_CHANNELS];  // bank << 8 | program of the channels,
+                                                            // -1 for none; read by control threads
+
       void updatePatchList();
+      void updateBankOffsets();
+      bool deferred() const;
+      void post(const FluidCmd&);
+      void execute(const FluidCmd&);
+      void executeCommands(bool wait);
+      void playEvent(const PlayEvent&);
+      void setSoundFonts(const QList<SFont*>&, bool reset);
+      QVector<ChannelPreset>* preparePresets(const QList<SFont*>&);
+      void applySoundFonts(const FluidCmd&);
+      void collectGarbage();
 
    protected:
       int _state;                         // the synthesizer state
@@ -323,8 +395,7 @@ class Fluid : public Synthesizer {
       SFont* get_sfont_by_name(const QString& name);
       SFont* get_sfont_by_id(int id);
       SFont* get_sfont(int idx) const     { return sfonts[idx];   }
-      bool sfunload(int id);
-      int sfload(const QString& filename);
+      SFont* sfload(const QString& filename);
 
    public:
       Fluid();
@@ -378,6 +449,14 @@ class Fluid : public Synthesizer {
       void free_voice_by_kill();
 
       virtual void process(unsigned len, float* out, float* effect1, float* effect2);
+      virtual int dropouts() const { return _dropouts; }
+      virtual void audioStopped();
+      virtual void setStreaming(bool);
+      bool streaming() const              { return _streaming; }
+      void loadSamples(Preset*);
+      void publishProgram(int chan, int bank, int prog);
+      void notesOff(int chan);
+      void soundsOff(int chan);
 
       bool program_select(int chan, unsigned sfont_id, unsigned bank_num, unsigned preset_num);
       void get_program(int chan, unsigned* sfont_id, unsigned* bank_num, unsigned* preset_num);
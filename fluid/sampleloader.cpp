@@ -0,0 +1,254 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2016 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "sampleloader.h"
+#include "sfont.h"
+
+namespace FluidS {
+
+//---------------------------------------------------------
+//   SampleRequestFifo
+//---------------------------------------------------------
+
+SampleRequestFifo::SampleRequestFifo()
+      {
+      maxCount = SAMPLE_REQUEST_FIFO_SIZE;
+      clear();
+      }
+
+//---------------------------------------------------------
+//   enqueue
+//---------------------------------------------------------
+
+bool SampleRequestFifo::enqueue(Sample* s, qint64 time)
+      {
+      if (isFull())
+            return false;
+      samples[widx] = s;
+      times[widx]   = time;
+      push();
+      return true;
+      }
+
+//---------------------------------------------------------
+//   dequeue
+//---------------------------------------------------------
+
+Sample* SampleRequestFifo::dequeue(qint64* time)
+      {
+      Sample* s = samples[ridx];
+      *time     = times[ridx];
+      pop();
+      return s;
+      }
+
+//---------------------------------------------------------
+//   SampleLoader
+//---------------------------------------------------------
+
+SampleLoader::SampleLoader()
+      {
+      clock.start();
+      }
+
+SampleLoader::~SampleLoader()
+      {
+      mutex.lock();
+      _stop = true;
+      wakeup.wakeAll();
+      mutex.unlock();
+      wait();
+      }
+
+//---------------------------------------------------------
+//   instance
+//---------------------------------------------------------
+
+SampleLoader* SampleLoader::instance()
+      {
+      static SampleLoader loader;
+      return &loader;
+      }
+
+//---------------------------------------------------------
+//   startThread
+//    called with mutex locked
+//---------------------------------------------------------
+
+void SampleLoader::startThread()
+      {
+      if (!isRunning())
+            start(QThread::LowPriority);
+      wakeup.wakeAll();
+      }
+
+//---------------------------------------------------------
+//   attach
+//    poll the requests of an audio thread
+//---------------------------------------------------------
+
+void SampleLoader::attach(SampleRequestFifo* fifo)
+      {
+      mutex.lock();
+      fifos.append(fifo);
+      startThread();
+      mutex.unlock();
+      }
+
+//---------------------------------------------------------
+//   detach
+//    the requests already in the fifo are kept
+//---------------------------------------------------------
+
+void SampleLoader::detach(SampleRequestFifo* fifo)
+      {
+      mutex.lock();
+      takeRequests();
+      fifos.removeOne(fifo);
+      mutex.unlock();
+      }
+
+//---------------------------------------------------------
+//   takeRequests
+//    move the requests of the attached fifos to the
+//    queue; called with mutex locked
+//---------------------------------------------------------
+
+void SampleLoader::takeRequests()
+      {
+      for (SampleRequestFifo* fifo : fifos) {
+            while (!fifo->isEmpty()) {
+                  Request r;
+                  r.sample = fifo->dequeue(&r.time);
+                  requests.append(r);
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   load
+//    queue a full load of the sample; called from control
+//    threads, audio threads use a SampleRequestFifo
+//---------------------------------------------------------
+
+void SampleLoader::load(Sample* s)
+      {
+      mutex.lock();
+      requests.append(Request { s, clock.nsecsElapsed() });
+      startThread();
+      mutex.unlock();
+      }
+
+//---------------------------------------------------------
+//   preload
+//    queue the heads of the samples
+//---------------------------------------------------------
+
+void SampleLoader::preload(const QList<Sample*>& sl)
+      {
+      mutex.lock();
+      for (Sample* s : sl) {
+            if (s->valid())
+                  heads.append(s);
+            }
+      startThread();
+      mutex.unlock();
+      }
+
+//---------------------------------------------------------
+//   remove
+//    drop all requests for samples of sf and wait until
+//    the sample being loaded does not belong to it;
+//    called before the soundfont is deleted
+//---------------------------------------------------------
+
+void SampleLoader::remove(const SFont* sf)
+      {
+      mutex.lock();
+      takeRequests();
+      for (auto i = requests.begin(); i != requests.end();) {
+            if (i->sample->sf == sf)
+                  i = requests.erase(i);
+            else
+                  ++i;
+            }
+      for (auto i = heads.begin(); i != heads.end();) {
+            if ((*i)->sf == sf)
+                  i = heads.erase(i);
+            else
+                  ++i;
+            }
+      while (current && current->sf == sf)
+            idle.wait(&mutex);
+      mutex.unlock();
+      }
+
+//---------------------------------------------------------
+//   run
+//---------------------------------------------------------
+
+void SampleLoader::run()
+      {
+      mutex.lock();
+      for (;;) {
+            takeRequests();
+            while (!_stop && requests.isEmpty() && heads.isEmpty()) {
+                  if (fifos.isEmpty())
+                        wakeup.wait(&mutex);
+                  else
+                        wakeup.wait(&mutex, POLL_INTERVAL);
+                  takeRequests();
+                  }
+            if (_stop)
+                  break;
+            bool full = !requests.isEmpty();
+            Request r = full ? requests.takeFirst() : Request { heads.takeFirst(), 0 };
+            current = r.sample;
+            mutex.unlock();
+
+            if (full)
+                  r.sample->load();
+            else
+                  r.sample->loadHead();
+
+            mutex.lock();
+            current = 0;
+            if (full) {
+                  qint64 latency = clock.nsecsElapsed() - r.time;
+                  ++_loads;
+                  _totalLatency += latency;
+                  _maxLatency = qMax(_maxLatency, latency);
+                  }
+            idle.wakeAll();
+            }
+      mutex.unlock();
+      }
+
+//---------------------------------------------------------
+//   statistics
+//---------------------------------------------------------
+
+SampleLoader::Statistics SampleLoader::statistics() const
+      {
+      QMutexLocker locker(&mutex);
+      Statistics s;
+      s.loads          = _loads;
+      s.pending        = requests.size();
+      for (const SampleRequestFifo* fifo : fifos)
+            s.pending += fifo->count();
+      s.averageLatency = _loads ? _totalLatency / (_loads * 1e6) : 0.0;
+      s.maxLatency     = _maxLatency / 1e6;
+      s.stalls         = _stalls;
+      return s;
+      }
+
+}
@@ -0,0 +1,105 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2016 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __SAMPLELOADER_H__
+#define __SAMPLELOADER_H__
+
+#include <atomic>
+#include "libmscore/fifo.h"
+
+namespace FluidS {
+
+class Sample;
+class SFont;
+
+//---------------------------------------------------------
+//   SampleRequestFifo
+//    full load requests of one audio thread; preallocated
+//    so that requesting a sample neither locks nor
+//    allocates
+//---------------------------------------------------------
+
+static const int SAMPLE_REQUEST_FIFO_SIZE = 4096;
+
+class SampleRequestFifo : public Ms::FifoBase {
+      Sample* samples[SAMPLE_REQUEST_FIFO_SIZE];
+      qint64 times[SAMPLE_REQUEST_FIFO_SIZE];
+
+   public:
+      SampleRequestFifo();
+      bool enqueue(Sample*, qint64 time);       // returns false if fifo is full
+      Sample* dequeue(qint64* time);
+      };
+
+//---------------------------------------------------------
+//   SampleLoader
+//    background thread which reads and decodes sample data
+//    for the realtime synthesizer. Full loads requested
+//    by a program change are served first, the heads of
+//    all samples of a soundfont are preloaded when idle.
+//    Audio threads queue their requests in an attached
+//    SampleRequestFifo, which the thread polls as it
+//    cannot be woken up without a lock.
+//---------------------------------------------------------
+
+class SampleLoader : public QThread {
+      struct Request {
+            Sample* sample;
+            qint64 time;            // request time, for latency statistics
+            };
+
+      mutable QMutex mutex;
+      QWaitCondition wakeup;        // new requests
+      QWaitCondition idle;          // current request finished
+      QList<Request> requests;      // full loads, first come first served
+      QList<Sample*> heads;         // head preloads, done when nothing else is pending
+      QList<SampleRequestFifo*> fifos;    // attached audio thread requests
+      Sample* current { 0 };
+      bool _stop      { false };
+      QElapsedTimer clock;
+
+      int _loads            { 0 };
+      qint64 _totalLatency  { 0 };  // nanoseconds
+      qint64 _maxLatency    { 0 };
+      std::atomic<int> _stalls { 0 };
+
+      SampleLoader();
+      ~SampleLoader();
+      void startThread();
+      void takeRequests();
+      virtual void run();
+
+   public:
+      struct Statistics {
+            int loads;              // completed full loads
+            int pending;            // queued full loads
+            double averageLatency;  // ms from request to loaded
+            double maxLatency;      // ms
+            int stalls;             // voice blocks held waiting for data
+            };
+
+      static const int POLL_INTERVAL = 5;     // ms between looks into attached fifos
+
+      static SampleLoader* instance();
+
+      qint64 time() const           { return clock.nsecsElapsed(); }
+      void attach(SampleRequestFifo*);
+      void detach(SampleRequestFifo*);
+      void load(Sample*);
+      void preload(const QList<Sample*>&);
+      void remove(const SFont*);
+      void stall()                  { ++_stalls; }
+      Statistics statistics() const;
+      };
+
+}
+#endif
@@ -0,0 +1,174 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2016 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "samplepool.h"
+
+namespace FluidS {
+
+//---------------------------------------------------------
+//   SamplePool
+//---------------------------------------------------------
+
+SamplePool::~SamplePool()
+      {
+      for (MappedFile* f : files)
+            delete f;
+      for (DecodedSample* s : samples) {
+            delete[] s->data;
+            delete s;
+            }
+      }
+
+//---------------------------------------------------------
+//   instance
+//---------------------------------------------------------
+
+SamplePool* SamplePool::instance()
+      {
+      static SamplePool pool;
+      return &pool;
+      }
+
+//---------------------------------------------------------
+//   key
+//    identifies a soundfont file; includes the modification
+//    time so that a file replaced on disk is not confused
+//    with the version still in use
+//---------------------------------------------------------
+
+QString SamplePool::key(const QString& path)
+      {
+      QFileInfo fi(path);
+      return QString("%1:%2").arg(fi.canonicalFilePath()).arg(fi.lastModified().toMSecsSinceEpoch());
+      }
+
+//---------------------------------------------------------
+//   mapFile
+//    map the whole file read only; returns 0 if mapping
+//    is not possible
+//---------------------------------------------------------
+
+const uchar* SamplePool::mapFile(const QString& key, const QString& path)
+      {
+      QMutexLocker locker(&mutex);
+      MappedFile* f = files.value(key);
+      if (f) {
+            ++f->refCount;
+            return f->data;
+            }
+      f = new MappedFile;
+      f->file.setFileName(path);
+      f->data = 0;
+      if (f->file.open(QIODevice::ReadOnly))
+            f->data = f->file.map(0, f->file.size());
+      if (!f->data) {
+            qDebug("SamplePool: cannot map <%s>", qPrintable(path));
+            delete f;
+            return 0;
+            }
+      f->refCount = 1;
+      files.insert(key, f);
+      return f->data;
+      }
+
+//---------------------------------------------------------
+//   unmapFile
+//---------------------------------------------------------
+
+void SamplePool::unmapFile(const QString& key)
+      {
+      QMutexLocker locker(&mutex);
+      MappedFile* f = files.value(key);
+      if (f && --f->refCount == 0) {
+            files.remove(key);
+            delete f;               // QFile unmaps on close
+            }
+      }
+
+//---------------------------------------------------------
+//   decoded
+//    return the decoded sample and take a reference,
+//    0 if it is not in the pool
+//---------------------------------------------------------
+
+short* SamplePool::decoded(const QString& key, unsigned offset, unsigned* frames)
+      {
+      QMutexLocker locker(&mutex);
+      DecodedSample* s = samples.value(SampleKey(key, offset));
+      if (!s)
+            return 0;
+      ++s->refCount;
+      *frames = s->frames;
+      return s->data;
+      }
+
+//---------------------------------------------------------
+//   addDecoded
+//    hand a decoded sample over to the pool and take a
+//    reference; if another instance was faster, data is
+//    deleted and the pooled copy returned
+//---------------------------------------------------------
+
+short* SamplePool::addDecoded(const QString& key, unsigned offset, short* data, unsigned frames)
+      {
+      QMutexLocker locker(&mutex);
+      SampleKey k(key, offset);
+      DecodedSample* s = samples.value(k);
+      if (s) {
+            delete[] data;
+            ++s->refCount;
+            return s->data;
+            }
+      s = new DecodedSample { data, frames, 1 };
+      samples.insert(k, s);
+      return data;
+      }
+
+//---------------------------------------------------------
+//   releaseDecoded
+//---------------------------------------------------------
+
+void SamplePool::releaseDecoded(const QString& key, unsigned offset)
+      {
+      QMutexLocker locker(&mutex);
+      SampleKey k(key, offset);
+      DecodedSample* s = samples.value(k);
+      if (s && --s->refCount == 0) {
+            samples.remove(k);
+            delete[] s->data;
+            delete s;
+            }
+      }
+
+//---------------------------------------------------------
+//   mappedFiles
+//    number of soundfont files currently mapped
+//---------------------------------------------------------
+
+int SamplePool::mappedFiles()
+      {
+      QMutexLocker locker(&mutex);
+      return files.size();
+      }
+
+//---------------------------------------------------------
+//   decodedSamples
+//    number of decoded samples currently in the pool
+//---------------------------------------------------------
+
+int SamplePool::decodedSamples()
+      {
+      QMutexLocker locker(&mutex);
+      return samples.size();
+      }
+
+}
@@ -0,0 +1,63 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2016 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __SAMPLEPOOL_H__
+#define __SAMPLEPOOL_H__
+
+namespace FluidS {
+
+//---------------------------------------------------------
+//   SamplePool
+//    sample data shared by all synthesizer instances of the
+//    process: soundfont files are memory mapped once and
+//    decoded sf3 samples are kept once per (file, sample).
+//    Entries are reference counted and released when the
+//    last soundfont or sample using them is deleted.
+//---------------------------------------------------------
+
+class SamplePool {
+      struct MappedFile {
+            QFile file;
+            uchar* data;
+            int refCount;
+            };
+      struct DecodedSample {
+            short* data;
+            unsigned frames;
+            int refCount;
+            };
+      typedef QPair<QString, unsigned> SampleKey;
+
+      QMutex mutex;
+      QHash<QString, MappedFile*> files;
+      QHash<SampleKey, DecodedSample*> samples;
+
+      SamplePool() {}
+      ~SamplePool();
+
+   public:
+      static SamplePool* instance();
+      static QString key(const QString& path);
+
+      const uchar* mapFile(const QString& key, const QString& path);
+      void unmapFile(const QString& key);
+
+      short* decoded(const QString& key, unsigned offset, unsigned* frames);
+      short* addDecoded(const QString& key, unsigned offset, short* data, unsigned frames);
+      void releaseDecoded(const QString& key, unsigned offset);
+
+      int mappedFiles();
+      int decodedSamples();
+      };
+
+}
+#endif
@@ -24,6 +24,8 @@
 #include "sfont.h"
 #include "fluid.h"
 #include "voice.h"
+#include "sampleloader.h"
+#include "samplepool.h"
 
 // #define DEBUG_SFONT
 
@@ -53,10 +55,12 @@ SFont::SFont(Fluid* f)
       samplepos   = 0;
       samplesize  = 0;
       _bankOffset = 0;
+      _map        = 0;
       }
 
 SFont::~SFont()
       {
+      SampleLoader::instance()->remove(this);
       foreach(Sample* s, sample)
             delete s;
       foreach(Preset* p, presets)
@@ -68,6 +72,8 @@ SFont::~SFont()
 //                  delete z;
             delete i;
             }
+      if (_map)
+            SamplePool::instance()->unmapFile(_poolKey);
       }
 
 //---------------------------------------------------------
@@ -79,6 +85,8 @@ bool SFont::read(const QString& s)
       f.setFileName(s);
       if (!load())
             return false;
+      _poolKey = SamplePool::key(s);
+      _map     = SamplePool::instance()->mapFile(_poolKey, s);
 
       foreach(Instrument* i, instruments) {
             if (!i->import_sfont())
@@ -129,31 +137,43 @@ Preset::~Preset()
             delete z;
       }
 
+//---------------------------------------------------------
+//   loadSample
+//---------------------------------------------------------
+
+static void loadSample(Sample* s, bool async, SampleRequestFifo* fifo)
+      {
+      if (async)
+            s->request(fifo);
+      else
+            s->load();
+      }
+
 //---------------------------------------------------------
 //   loadSamples
 //    this is called if the preset is associated with a
-//    channel
+//    channel; with async set the samples are queued for
+//    the loader thread, through fifo if given, and voices
+//    play what is available
 //---------------------------------------------------------
 
-void Preset::loadSamples()
+void Preset::loadSamples(bool async, SampleRequestFifo* fifo)
       {
-//      sfont->synth->mutex.lock();
       if (_global_zone && _global_zone->instrument) {
             Instrument* i = _global_zone->instrument;
             if (i->global_zone && i->global_zone->sample)
-                  i->global_zone->sample->load();
+                  loadSample(i->global_zone->sample, async, fifo);
             foreach(Zone* iz, i->zones)
-                  iz->sample->load();
+                  loadSample(iz->sample, async, fifo);
             }
 
       foreach(Zone* z, zones) {
             Instrument* i = z->instrument;
             if (i->global_zone && i->global_zone->sample)
-                  i->global_zone->sample->load();
+                  loadSample(i->global_zone->sample, async, fifo);
             foreach(Zone* iz, i->zones)
-                  iz->sample->load();
+                  loadSample(iz->sample, async, fifo);
             }
-//      sfont->synth->mutex.unlock();
       }
 
 //---------------------------------------------------------
@@ -180,7 +200,7 @@ bool Preset::noteon(Fluid* synth, unsigned id, int chan, int key, int vel, doubl
                   foreach(Zone* inst_zone, inst->get_zone()) {
                         /* make sure this instrument zone has a valid sample */
                         Sample* sample = inst_zone->get_sample();
-                        if (sample == 0 || sample->inRom())
+                        if (sample == 0 || sample->inRom() || !sample->ready())
                               continue;
                         /* check if the note falls into the key and velocity range of this
                            instrument */
@@ -577,6 +597,14 @@ Sample::Sample(SFont* s)
       {
       sf          = s;
       _valid      = false;
+      _ready      = false;
+      _loaded     = false;
+      _queued     = false;
+      _available  = 0;
+      _head       = 0;
+      _storage    = Storage::OWNED;
+      offset      = 0;
+      size        = 0;
       start       = 0;
       end         = 0;
       loopstart   = 0;
@@ -596,67 +624,207 @@ Sample::Sample(SFont* s)
 
 Sample::~Sample()
       {
-      delete[] data;
+      short* p = data;
+      switch (_storage) {
+            case Storage::OWNED:
+                  if (p != _head)
+                        delete[] p;
+                  break;
+            case Storage::MAPPED:         // part of the soundfont mapping
+                  break;
+            case Storage::POOLED:
+                  SamplePool::instance()->releaseDecoded(sf->poolKey(), offset);
+                  break;
+            }
+      delete[] _head;
       }
 
 //---------------------------------------------------------
-//   load
+//   mappedData
+//    the sample in the memory mapped soundfont, usable
+//    directly as the file is little endian like the host
 //---------------------------------------------------------
 
-void Sample::load()
+const short* Sample::mappedData() const
       {
-      if (!_valid || data)
-            return;
-      QFile fd(sf->get_name());
-      if (!fd.open(QIODevice::ReadOnly))
-            return;
-      if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
-            if (!fd.seek(sf->samplePos() + start))
-                  return;
-            }
-      else {
-            if (!fd.seek(sf->samplePos() + start * sizeof(short)))
-                  return;
-            }
-      unsigned int size = end - start;
+      const uchar* map = sf->map();
+      if (!map || (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) || QSysInfo::ByteOrder != QSysInfo::LittleEndian)
+            return 0;
+      return reinterpret_cast<const short*>(map + sf->samplePos()) + offset;
+      }
 
+//---------------------------------------------------------
+//   prefault
+//    touch every page of mapped data once so that the
+//    first notes do not wait for the disk. The pages are
+//    not locked: clean pages can be evicted again under
+//    memory pressure and are then read back on the audio
+//    thread.
+//---------------------------------------------------------
+
+static void prefault(const short* p, unsigned frames)
+      {
+      volatile short sink = 0;
+      for (unsigned i = 0; i < frames; i += 2048)
+            sink += p[i];
+      if (frames)
+            sink += p[frames - 1];
+      }
+
+//---------------------------------------------------------
+//   read
+//    read up to maxFrames frames (all if 0) of the sample
+//    from the soundfont file; returns a new buffer or 0
+//---------------------------------------------------------
+
+short* Sample::read(unsigned* frames, unsigned maxFrames)
+      {
+      const uchar* map = sf->map();
       if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
 #ifdef SOUNDFONT3
-            char* p = new char[size];
-            if (fd.read(p, size) != size) {
-                  printf("  read %d failed\n", size);
-                  delete[] p;
-                  return;
+            if (map) {
+                  QByteArray ba = QByteArray::fromRawData((const char*)map + sf->samplePos() + offset, size);
+                  return decompressOggVorbis(ba, frames, maxFrames);
                   }
-            decompressOggVorbis(p, size);
-            delete[] p;
+            QFile fd(sf->get_name());
+            if (!fd.open(QIODevice::ReadOnly) || !fd.seek(sf->samplePos() + offset))
+                  return 0;
+            QByteArray ba = fd.read(size);
+            if (ba.size() != int(size)) {
+                  qDebug("Sample::read: read %d failed", size);
+                  return 0;
+                  }
+            return decompressOggVorbis(ba, frames, maxFrames);
+#else
+            return 0;
 #endif
             }
-      else {
-            data = new short[size];
-            size *= sizeof(short);
-
-            if (fd.read((char*)data, size) != size)
-                  return;
-
-            if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
-                  unsigned char hi, lo;
-                  unsigned int i, j;
-                  short s;
-                  uchar* cbuf = (uchar*) data;
-                  for (i = 0, j = 0; j < size; i++) {
-                        lo = cbuf[j++];
-                        hi = cbuf[j++];
-                        s = (hi << 8) | lo;
-                        data[i] = s;
-                        }
+      QFile fd(sf->get_name());
+      if (!fd.open(QIODevice::ReadOnly) || !fd.seek(sf->samplePos() + offset * sizeof(short)))
+            return 0;
+      unsigned n = (maxFrames && maxFrames < size) ? maxFrames : size;
+      short* p   = new short[n];
+      qint64 len = n * sizeof(short);
+      if (fd.read((char*)p, len) != len) {
+            delete[] p;
+            return 0;
+            }
+      if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
+            uchar* cbuf = (uchar*) p;
+            for (unsigned i = 0; i < n; ++i)
+                  p[i] = (cbuf[i * 2 + 1] << 8) | cbuf[i * 2];
+            }
+      *frames = n;
+      return p;
+      }
+
+//---------------------------------------------------------
+//   publish
+//    make the first frames of the sample available to the
+//    voices; data is stored before _available so that a
+//    reader never sees frames without the buffer
+//---------------------------------------------------------
+
+void Sample::publish(short* p, unsigned frames)
+      {
+      data = p;
+      if (frames == end + 1) {
+            optimize();
+            _available = frames;
+            _loaded    = true;
+            }
+      else
+            _available = frames;
+      _ready = true;
+      }
+
+//---------------------------------------------------------
+//   loadShared
+//    use the mapped sample or a sample another synthesizer
+//    instance has already decoded; returns false if the
+//    sample has to be read
+//---------------------------------------------------------
+
+bool Sample::loadShared(unsigned maxFrames)
+      {
+      if (const short* p = mappedData()) {
+            unsigned n = (maxFrames && maxFrames < size) ? maxFrames : size;
+            prefault(p, n);
+            _storage = Storage::MAPPED;
+            publish(const_cast<short*>(p), n);
+            return true;
+            }
+#ifdef SOUNDFONT3
+      if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
+            unsigned frames;
+            short* p = SamplePool::instance()->decoded(sf->poolKey(), offset, &frames);
+            if (!p)
+                  return false;
+            if (!ready() && !setFrames(frames)) {
+                  SamplePool::instance()->releaseDecoded(sf->poolKey(), offset);
+                  return true;
                   }
-            end       -= (start + 1);       // marks last sample, contrary to SF spec.
-            loopstart -= start;
-            loopend   -= start;
-            start      = 0;
+            _storage = Storage::POOLED;
+            publish(p, frames);
+            return true;
+            }
+#endif
+      return false;
+      }
+
+//---------------------------------------------------------
+//   load
+//    read the whole sample; called by the loader thread or
+//    synchronously when not streaming
+//---------------------------------------------------------
+
+void Sample::load()
+      {
+      if (!_valid || _loaded || loadShared(0))
+            return;
+      unsigned frames;
+      short* p = read(&frames, 0);
+      if (!p)
+            return;
+      if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
+            p = SamplePool::instance()->addDecoded(sf->poolKey(), offset, p, frames);
+            _storage = Storage::POOLED;
             }
-      optimize();
+      publish(p, frames);
+      }
+
+//---------------------------------------------------------
+//   loadHead
+//    read the attack of the sample so that a note can start
+//    before the rest is loaded; called by the loader thread
+//---------------------------------------------------------
+
+void Sample::loadHead()
+      {
+      if (!_valid || _available || loadShared(HEAD_FRAMES))
+            return;
+      unsigned frames;
+      short* p = read(&frames, HEAD_FRAMES);
+      if (!p)
+            return;
+      _head = p;
+      publish(p, frames);
+      }
+
+//---------------------------------------------------------
+//   request
+//    queue the sample for background loading; audio
+//    threads pass their fifo
+//---------------------------------------------------------
+
+void Sample::request(SampleRequestFifo* fifo)
+      {
+      if (!_valid || _loaded || _queued.exchange(true))
+            return;
+      if (!fifo)
+            SampleLoader::instance()->load(this);
+      else if (!fifo->enqueue(this, SampleLoader::instance()->time()))
+            _queued = false;        // requested again by the next program change
       }
 
 //---------------------------------------------------------
@@ -1638,6 +1806,18 @@ void SFont::load_shdr (int size)
                   if ((p->end - p->start) < 8)
                         p->setValid(false);
                   }
+            p->offset = p->start;
+            p->size   = p->end - p->start;
+            if (!(p->sampletype & FLUID_SAMPLETYPE_OGG_VORBIS)) {
+                  // the final points are known before the data is
+                  // loaded, a voice can start while it streams in
+                  p->end       -= (p->start + 1);       // marks last sample, contrary to SF spec.
+                  p->loopstart -= p->start;
+                  p->loopend   -= p->start;
+                  p->start      = 0;
+                  if (p->valid())
+                        p->setReady();
+                  }
             }
       FSKIP (SFSHDRSIZE);	/* skip terminal shdr */
       }
@@ -23,6 +23,7 @@
 #ifndef _FLUID_DEFSFONT_H
 #define _FLUID_DEFSFONT_H
 
+#include <atomic>
 #include "config.h"
 #include "fluid.h"
 
@@ -54,6 +55,8 @@ class SFont {
       QFile f;
       unsigned samplepos;           // the position in the file at which the sample data starts
       unsigned samplesize;          // the size of the sample data
+      QString _poolKey;             // identifies the file in the SamplePool
+      const uchar* _map;            // the mapped file, 0 if not mapped
 
       QList<Instrument*> instruments;
       QList<Preset*> presets;
@@ -110,12 +113,15 @@ class SFont {
 
       int load_sampledata();
       unsigned int samplePos() const            { return samplepos;  }
+      const uchar* map() const                  { return _map; }
+      const QString& poolKey() const            { return _poolKey; }
       int id() const                            { return _id; }
       void setId(int i)                         { _id = i;    }
       void setSamplepos(unsigned v)             { samplepos = v; }
       void setSamplesize(unsigned v)            { samplesize = v; }
       unsigned getSamplesize() const            { return samplesize; }
       const QList<Preset*> getPresets() const   { return presets; }
+      const QList<Sample*>& samples() const     { return sample; }
       SFVersion version() const                 { return _version; }
       int bankOffset() const                    { return _bankOffset; }
       void setBankOffset(int val)               { _bankOffset = val; }
@@ -128,9 +134,27 @@ class SFont {
 
 class Sample {
       bool _valid;
+      std::atomic<bool> _ready;           // start, end and loop points are final
+      std::atomic<bool> _loaded;          // all frames are in data
+      std::atomic<bool> _queued;          // full load requested
+      std::atomic<unsigned> _available;   // frames in data
+      short* _head;                       // first frames, played until the sample is loaded
+      enum class Storage : char {
+            OWNED, MAPPED, POOLED
+            };
+      Storage _storage;                   // who owns data
+
+      const short* mappedData() const;
+      short* read(unsigned* frames, unsigned maxFrames);
+      void publish(short* p, unsigned frames);
+      bool loadShared(unsigned maxFrames);
 
    public:
+      static const unsigned HEAD_FRAMES = 8192;
+
       SFont* sf;
+      unsigned int offset;          // position in the sample chunk, frames (sf2) or bytes (sf3)
+      unsigned int size;            // frames (sf2) or compressed bytes (sf3)
       unsigned int start;
       unsigned int end;
       unsigned int loopstart;
@@ -140,14 +164,14 @@ class Sample {
       int pitchadj;
       int sampletype;
 
-      short* data;
+      std::atomic<short*> data;     // stored before _available is raised
 
       /** The amplitude, that will lower the level of the sample's loop to
           the noise floor. Needed for note turnoff optimization, will be
           filled out automatically */
       /* Set this to zero, when submitting a new sample. */
 
-      bool amplitude_that_reaches_noise_floor_is_valid;
+      std::atomic<bool> amplitude_that_reaches_noise_floor_is_valid;
       double amplitude_that_reaches_noise_floor;
 
       Sample(SFont*);
@@ -156,10 +180,17 @@ class Sample {
       bool inRom() const;
       void optimize();
       void load();
+      void loadHead();
+      void request(SampleRequestFifo* fifo = 0);
+      bool ready() const          { return _ready;     }
+      void setReady()             { _ready = true;     }
+      bool loaded() const         { return _loaded;    }
+      unsigned available() const  { return _available; }
       bool valid() const    { return _valid; }
       void setValid(bool v) { _valid = v; }
 #ifdef SOUNDFONT3
-      bool decompressOggVorbis(char* p, int size);
+      bool setFrames(unsigned frames);
+      short* decompressOggVorbis(const QByteArray&, unsigned* frames, unsigned maxFrames);
 #endif
       };
 
@@ -236,7 +267,7 @@ class Preset {
       bool importSfont();
 
       Zone* global_zone()                       { return _global_zone; }
-      void loadSamples();
+      void loadSamples(bool async, SampleRequestFifo* fifo = 0);
       QList<Zone*> getZones()                   { return zones; }
       };
 
@@ -7,28 +7,15 @@
 namespace FluidS {
 
 //---------------------------------------------------------
-//   decompressOggVorbis
+//   setFrames
+//    set the final start, end and loop points once the
+//    length of the decoded sample is known
 //---------------------------------------------------------
 
-bool Sample::decompressOggVorbis(char* src, int size)
+bool Sample::setFrames(unsigned frames)
       {
-      AudioFile af;
-      QByteArray ba(src, size);
-
       start = 0;
-      end   = 0;
-      if (!af.open(ba)) {
-            qDebug("Sample::decompressOggVorbis: open failed: %s", af.error());
-            return false;
-            }
-      int frames = af.frames();
-      data = new short[frames * af.channels()];
-      if (frames != af.read(data, frames)) {
-            qDebug("Sample read failed: %s", af.error());
-            delete[] data;
-            data = 0;
-            }
-      end = frames - 1;
+      end   = frames - 1;
 
       if (loopend > end ||loopstart >= loopend || loopstart <= start) {
             /* can pad loop by 8 samples and ensure at least 4 for loop (2*8+4) */
@@ -41,11 +28,38 @@ bool Sample::decompressOggVorbis(char* src, int size)
                   loopend = end - 1;
                   }
             }
-      if ((end - start) < 8) {
+      if (frames < 8 || (end - start) < 8) {
             qDebug("invalid sample");
             setValid(false);
+            return false;
             }
-
       return true;
       }
+
+//---------------------------------------------------------
+//   decompressOggVorbis
+//    decode up to maxFrames frames (all if 0)
+//---------------------------------------------------------
+
+short* Sample::decompressOggVorbis(const QByteArray& ba, unsigned* frames, unsigned maxFrames)
+      {
+      AudioFile af;
+
+      if (!af.open(ba)) {
+            qDebug("Sample::decompressOggVorbis: open failed: %s", af.error());
+            return 0;
+            }
+      unsigned total = af.frames();
+      if (!ready() && !setFrames(total))
+            return 0;
+      unsigned n = (maxFrames && maxFrames < total) ? maxFrames : total;
+      short* p   = new short[n * af.channels()];
+      if (int(n) != af.read(p, n)) {
+            qDebug("Sample read failed: %s", af.error());
+            delete[] p;
+            return 0;
+            }
+      *frames = n;
+      return p;
+      }
 } // namespace
@@ -23,6 +23,8 @@
 #include "sfont.h"
 #include "gen.h"
 #include "voice.h"
+#include "sampleloader.h"
+#include "dspkernels.h"
 
 namespace FluidS {
 
@@ -225,6 +227,12 @@ void Voice::write(unsigned n, float* out, float* reverb, float* chorus)
        * Initial phase is calculated here*/
       check_sample_sanity();
 
+      /* While the sample streams in, save the envelopes and LFOs: the
+       * block is held if it would read past the loaded frames with its
+       * final pitch, which is only known after they are advanced. */
+      const bool streaming = !sample->loaded();
+      const ModState saved = streaming ? modState() : ModState();
+
       /******************* vol env **********************/
 
       env_data = &volenv_data[volenv_section];
@@ -415,6 +423,17 @@ void Voice::write(unsigned n, float* out, float* reverb, float* chorus)
       if (phase_incr == 0)
             phase_incr = 1;
 
+      /* hold the voice if the sample is not loaded as far as this
+       * block reads; the data is published before the frame count,
+       * so the data read by the dsp is at least as far loaded */
+      unsigned available = sample->available();
+      if (streaming && lastFrame(n) >= available) {
+            setModState(saved);
+            SampleLoader::instance()->stall();
+            return;
+            }
+      dsp_last = available - 1;
+
       /*************** resonant filter ******************/
 
       /* calculate the frequency of the resonant filter in Hz */
@@ -552,6 +571,71 @@ void Voice::write(unsigned n, float* out, float* reverb, float* chorus)
       }
 
 
+//---------------------------------------------------------
+//   modState
+//---------------------------------------------------------
+
+Voice::ModState Voice::modState() const
+      {
+      ModState st;
+      st.volenv_count   = volenv_count;
+      st.volenv_section = volenv_section;
+      st.volenv_val     = volenv_val;
+      st.modenv_count   = modenv_count;
+      st.modenv_section = modenv_section;
+      st.modenv_val     = modenv_val;
+      st.modlfo_val     = modlfo_val;
+      st.modlfo_incr    = modlfo_incr;
+      st.viblfo_val     = viblfo_val;
+      st.viblfo_incr    = viblfo_incr;
+      return st;
+      }
+
+//---------------------------------------------------------
+//   setModState
+//---------------------------------------------------------
+
+void Voice::setModState(const ModState& st)
+      {
+      volenv_count   = st.volenv_count;
+      volenv_section = st.volenv_section;
+      volenv_val     = st.volenv_val;
+      modenv_count   = st.modenv_count;
+      modenv_section = st.modenv_section;
+      modenv_val     = st.modenv_val;
+      modlfo_val     = st.modlfo_val;
+      modlfo_incr    = st.modlfo_incr;
+      viblfo_val     = st.viblfo_val;
+      viblfo_incr    = st.viblfo_incr;
+      }
+
+//---------------------------------------------------------
+//   lastFrame
+//    the highest sample frame the interpolation reads when
+//    rendering n frames with the current phase_incr
+//---------------------------------------------------------
+
+unsigned Voice::lastFrame(unsigned n) const
+      {
+      // the phase of the last rendered frame is less than
+      // phase_incr * n + 1 frames ahead; the 7th order
+      // interpolation adds half a frame and reads three
+      // frames ahead of it
+      unsigned last = phase.index() + unsigned(phase_incr * n) + 6;
+
+      // the interpolation wraps around at the loop end or
+      // repeats the last frame at the sample end
+      bool looping = SAMPLEMODE() == FLUID_LOOP_DURING_RELEASE
+         || (SAMPLEMODE() == FLUID_LOOP_UNTIL_RELEASE
+         && volenv_section < FLUID_VOICE_ENVRELEASE);
+      unsigned limit = unsigned(looping ? loopend - 1 : end);
+      if (last > limit)
+            last = limit;
+      if (has_looped)         // points before the loop start
+            last = qMax(last, unsigned(loopend - 1));
+      return last;
+      }
+
 //---------------------------------------------------------
 //   voice_start
 //---------------------------------------------------------
@@ -1718,19 +1802,8 @@ void Voice::effects(int count, float* out, float* reverb, float* chorus)
                   }
             }
 
-      for (int i = 0; i < count; i++) {
-            float v    = dsp_buf[i];
-
-            float vv   = v  * amp_left;
-            *out++    += vv;
-            *reverb++ += vv * amp_reverb;
-            *chorus++ += vv * amp_chorus;
-
-            vv         = v  * amp_right;
-            *out++    += vv;
-            *reverb++ += vv * amp_reverb;
-            *chorus++ += vv * amp_chorus;
-            }
+      DspKernels::active()->mix(dsp_buf, count, amp_left, amp_right, amp_reverb, amp_chorus,
+         out, reverb, chorus);
       }
 }
 
@@ -70,7 +70,23 @@ class Voice
       Fluid* _fluid;
       double _noteTuning;             // +/- in midicent
 
+      // envelope and LFO state, restored when a block of a
+      // streaming sample is held
+      struct ModState {
+            unsigned volenv_count;
+            int volenv_section;
+            float volenv_val;
+            unsigned modenv_count;
+            int modenv_section;
+            float modenv_val;
+            float modlfo_val, modlfo_incr;
+            float viblfo_val, viblfo_incr;
+            };
+
       void effects(int count, float* out, float* effect1, float* effect2);
+      ModState modState() const;
+      void setModState(const ModState&);
+      unsigned lastFrame(unsigned n) const;
 
    public:
 	unsigned int id;                // the id is incremented for every new noteon.
@@ -98,6 +114,7 @@ class Voice
 	float phase_incr;	      /* the phase increment for the next 64 samples */
 	float amp_incr;		/* amplitude increment value */
 	float* dsp_buf;	      /* buffer to store interpolated sample data to */
+	unsigned dsp_last;      /* last loaded sample frame, points beyond are not read */
 
 	/* basic parameters */
 	float pitch;              /* the pitch in midicents */
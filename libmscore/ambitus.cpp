@@ -196,7 +196,7 @@ void Ambitus::write(Xml& xml) const
 void Ambitus::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "head")
                   setProperty(P_ID::HEAD_GROUP, Ms::getProperty(P_ID::HEAD_GROUP, e));
             else if (tag == "headType")
@@ -258,7 +258,7 @@ void Articulation::read(XmlReader& e)
       {
       setArticulationType(ArticulationType::Fermata);    // default // backward compatibility (no type = ufermata in 1.2)
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype")
                   setSubtype(e.readElementText());
             else if (tag == "channel") {
@@ -485,7 +485,7 @@ void Articulation::canvasBoundingRectChanged()
       {
       Page* p = page();
       if (p)
-            p->rebuildBspTree();
+            p->updateBspTree(this);
       }
 
 //---------------------------------------------------------
@@ -12,6 +12,7 @@
 
 #include "audio.h"
 #include "xml.h"
+#include "scorearchive.h"
 
 namespace Ms {
 
@@ -23,6 +24,16 @@ Audio::Audio()
       {
       }
 
+//---------------------------------------------------------
+//   loadFromArchive
+//---------------------------------------------------------
+
+void Audio::loadFromArchive() const
+      {
+      _data = _archive->fileData("audio.ogg");
+      _archive.clear();
+      }
+
 //---------------------------------------------------------
 //   read
 //---------------------------------------------------------
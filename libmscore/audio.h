@@ -17,22 +17,29 @@ namespace Ms {
 
 class Xml;
 class XmlReader;
+class ScoreArchive;
 
 //---------------------------------------------------------
 //   Audio
+//    audio of a .mscz file is decompressed on the first
+//    call to data()
 //---------------------------------------------------------
 
 class Audio {
       QString _path;
-      QByteArray _data;
+      mutable QByteArray _data;
+      mutable QSharedPointer<ScoreArchive> _archive;
+
+      void loadFromArchive() const;
 
    public:
       Audio();
       const QString& path() const        { return _path; }
       void setPath(const QString& s)     { _path = s;    }
-      const QByteArray& data() const     { return _data; }
-      QByteArray data()                  { return _data; }
-      void setData(const QByteArray& ba) { _data = ba;   }
+      const QByteArray& data() const     { if (_archive) loadFromArchive(); return _data; }
+      QByteArray data()                  { if (_archive) loadFromArchive(); return _data; }
+      void setData(const QByteArray& ba) { _data = ba; _archive.clear(); }
+      void setData(QSharedPointer<ScoreArchive> archive) { _archive = archive; }
 
       void read(XmlReader&);
       void write(Xml&) const;
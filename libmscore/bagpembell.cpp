@@ -370,7 +370,7 @@ void BagpipeEmbellishment::write(Xml& xml) const
 void BagpipeEmbellishment::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype")
                   _embelType = e.readInt();
             else
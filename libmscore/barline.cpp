@@ -521,7 +521,7 @@ void BarLine::read(XmlReader& e)
             _spanTo   = staff()->barLineTo();
             }
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype") {
                   bool ok;
                   const QString& val(e.readElementText());
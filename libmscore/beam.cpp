@@ -2017,7 +2017,7 @@ void Beam::read(XmlReader& e)
       qreal _spatium = spatium();
       _id = e.intAttribute("id");
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "StemDirection") {
                   setProperty(P_ID::STEM_DIRECTION, Ms::getProperty(P_ID::STEM_DIRECTION, e));
                   e.readNext();
@@ -2055,7 +2055,7 @@ void Beam::read(XmlReader& e)
                   qreal _spatium = spatium();
 
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "y1")
                               f->py1[idx] = e.readDouble() * _spatium;
                         else if (tag == "y2")
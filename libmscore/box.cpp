@@ -208,7 +208,7 @@ void Box::read(XmlReader& e)
       bool keepMargins = false;        // whether original margins have to be kept when reading old file
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "HBox") {
                   HBox* hb = new HBox(score());
                   hb->read(e);
@@ -239,7 +239,7 @@ void Box::read(XmlReader& e)
 
 bool Box::readProperties(XmlReader& e)
       {
-      const QStringRef& tag(e.name());
+      const XmlTag& tag(e.name());
       if (tag == "height")
             _boxHeight = Spatium(e.readDouble());
       else if (tag == "width")
@@ -70,7 +70,7 @@ void Breath::write(Xml& xml) const
 void Breath::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype")
                   _breathType = e.readInt();
             else if (tag == "pause")
@@ -8,9 +8,6 @@
 //  it under the terms of the GNU General Public License version 2
 //  as published by the Free Software Foundation and appearing in
 //  the file LICENCE.GPL
-//
-//  This code is from Qt implementation of QGraphicsItem
-//    Copyright (C) 1992-2007 Trolltech ASA. All rights reserved.
 //=============================================================================
 
 #include "bsp.h"
@@ -18,94 +15,157 @@
 
 namespace Ms {
 
+static const int MAX_GRID = 256;          // max cells per row/column
+
 //---------------------------------------------------------
-//   InsertItemBspTreeVisitor
+//   BspTree
 //---------------------------------------------------------
 
-class InsertItemBspTreeVisitor : public BspTreeVisitor
+BspTree::BspTree()
       {
-   public:
-      Element* item;
-
-      inline void visit(QList<Element*> *items) { items->prepend(item); }
-      };
+      cols      = 1;
+      rows      = 1;
+      sx        = 0.0;
+      sy        = 0.0;
+      gridValid = false;
+      curStamp  = 0;
+      }
 
 //---------------------------------------------------------
-//   RemoveItemBspTreeVisitor
+//   initialize
+//    set up an empty grid for about n elements
+//    in rect
 //---------------------------------------------------------
 
-class RemoveItemBspTreeVisitor : public BspTreeVisitor
+void BspTree::initialize(const QRectF& r, int n)
       {
-   public:
-      Element* item;
-
-      inline void visit(QList<Element*> *items) { items->removeAll(item); }
-      };
+      clear();
+      rect = r.normalized();
+
+      // aim for a few elements per cell, with cells about
+      // as wide as they are high
+      qreal w = rect.width();
+      qreal h = rect.height();
+      if (w > 0.0 && h > 0.0 && n > 0) {
+            qreal cells = qMax(qreal(n) / 4.0, 1.0);
+            cols = qBound(1, int(ceil(sqrt(cells * w / h))), MAX_GRID);
+            rows = qBound(1, int(ceil(cells / cols)), MAX_GRID);
+            sx   = cols / w;
+            sy   = rows / h;
+            }
+      elements.reserve(n);
+      x1.reserve(n);
+      y1.reserve(n);
+      x2.reserve(n);
+      y2.reserve(n);
+      stamp.reserve(n);
+      slotIndex.reserve(n);
+      }
 
 //---------------------------------------------------------
-//   FindItemBspTreeVisitor
+//   clear
 //---------------------------------------------------------
 
-class FindItemBspTreeVisitor : public BspTreeVisitor
+void BspTree::clear()
       {
-   public:
-      QList<Element*> foundItems;
-
-      void visit(QList<Element*>* items) {
-            for (int i = 0; i < items->size(); ++i) {
-                  Element* item = items->at(i);
-                  if (!item->itemDiscovered) {
-                        item->itemDiscovered = true;
-                        foundItems.prepend(item);
-                        }
-                  }
-            }
-      };
+      cols = 1;
+      rows = 1;
+      sx   = 0.0;
+      sy   = 0.0;
+      elements.clear();
+      x1.clear();
+      y1.clear();
+      x2.clear();
+      y2.clear();
+      stamp.clear();
+      freeSlots.clear();
+      slotIndex.clear();
+      cellStart.clear();
+      cellItems.clear();
+      gridValid = false;
+      curStamp  = 0;
+      }
 
 //---------------------------------------------------------
-//   BspTree
+//   cellRange
+//    grid cells covered by the box (l, t, r, b); boxes
+//    outside of rect are clamped to the border cells
 //---------------------------------------------------------
 
-BspTree::BspTree()
-   : leafCnt(0)
+void BspTree::cellRange(qreal l, qreal t, qreal r, qreal b, int* c1, int* r1, int* c2, int* r2) const
       {
-      depth = 0;
+      *c1 = qBound(0, int((l - rect.x()) * sx), cols - 1);
+      *c2 = qBound(0, int((r - rect.x()) * sx), cols - 1);
+      *r1 = qBound(0, int((t - rect.y()) * sy), rows - 1);
+      *r2 = qBound(0, int((b - rect.y()) * sy), rows - 1);
       }
 
 //---------------------------------------------------------
-//   intmaxlog
+//   setBox
 //---------------------------------------------------------
 
-static inline int intmaxlog(int n)
+void BspTree::setBox(int slot, const QRectF& br)
       {
-      return (n > 0 ? qMax(int(::ceil(::log(qreal(n))/::log(qreal(2)))), 5) : 0);
+      QRectF r(br.normalized());
+      x1[slot] = r.left();
+      y1[slot] = r.top();
+      x2[slot] = r.right();
+      y2[slot] = r.bottom();
       }
 
 //---------------------------------------------------------
-//   initialize
+//   buildGrid
+//    counting sort of all slots into the grid cells
 //---------------------------------------------------------
 
-void BspTree::initialize(const QRectF& rect, int n)
+void BspTree::buildGrid()
       {
-      depth      = intmaxlog(n);
-      this->rect = rect;
-      leafCnt    = 0;
-
-      nodes.resize((1 << (depth+1)) - 1);
-      leaves.resize(1 << depth);
-      leaves.fill(QList<Element*>());
-      initialize(rect, depth, 0);
+      int ncells = cols * rows;
+      int n      = elements.size();
+      cellStart.fill(0, ncells + 1);
+      int* start = cellStart.data();
+
+      for (int i = 0; i < n; ++i) {
+            if (!elements[i])
+                  continue;
+            int c1, r1, c2, r2;
+            cellRange(x1[i], y1[i], x2[i], y2[i], &c1, &r1, &c2, &r2);
+            for (int row = r1; row <= r2; ++row) {
+                  for (int col = c1; col <= c2; ++col)
+                        ++start[row * cols + col + 1];
+                  }
+            }
+      for (int c = 0; c < ncells; ++c)
+            start[c + 1] += start[c];
+
+      cellItems.resize(start[ncells]);
+      int* items = cellItems.data();
+      QVector<int> fill(cellStart);
+      int* pos = fill.data();
+      for (int i = 0; i < n; ++i) {
+            if (!elements[i])
+                  continue;
+            int c1, r1, c2, r2;
+            cellRange(x1[i], y1[i], x2[i], y2[i], &c1, &r1, &c2, &r2);
+            for (int row = r1; row <= r2; ++row) {
+                  for (int col = c1; col <= c2; ++col)
+                        items[pos[row * cols + col]++] = i;
+                  }
+            }
+      gridValid = true;
       }
 
 //---------------------------------------------------------
-//   clear
+//   nextStamp
 //---------------------------------------------------------
 
-void BspTree::clear()
+uint BspTree::nextStamp()
       {
-      leafCnt = 0;
-      nodes.clear();
-      leaves.clear();
+      if (++curStamp == 0) {
+            stamp.fill(0);
+            curStamp = 1;
+            }
+      return curStamp;
       }
 
 //---------------------------------------------------------
@@ -114,37 +174,88 @@ void BspTree::clear()
 
 void BspTree::insert(Element* element)
       {
-      InsertItemBspTreeVisitor insertVisitor;
-      insertVisitor.item = element;
-      climbTree(&insertVisitor, element->pageBoundingRect());
+      if (slotIndex.contains(element)) {
+            update(element);
+            return;
+            }
+      int slot;
+      if (!freeSlots.isEmpty()) {
+            slot = freeSlots.takeLast();
+            elements[slot] = element;
+            }
+      else {
+            slot = elements.size();
+            elements.append(element);
+            x1.append(0.0);
+            y1.append(0.0);
+            x2.append(0.0);
+            y2.append(0.0);
+            stamp.append(0);
+            }
+      setBox(slot, element->pageBoundingRect());
+      slotIndex.insert(element, slot);
+      gridValid = false;
       }
 
 //---------------------------------------------------------
 //   remove
+//    the grid stays valid; it may still list the free
+//    slot, which is skipped on lookup
 //---------------------------------------------------------
 
 void BspTree::remove(Element* element)
       {
-      RemoveItemBspTreeVisitor removeVisitor;
-      removeVisitor.item = element;
-      climbTree(&removeVisitor, element->pageBoundingRect());
+      auto i = slotIndex.find(element);
+      if (i == slotIndex.end())
+            return;
+      int slot = i.value();
+      slotIndex.erase(i);
+      elements[slot] = 0;
+      freeSlots.append(slot);
+      }
+
+//---------------------------------------------------------
+//   update
+//    element bounding box has changed
+//---------------------------------------------------------
+
+void BspTree::update(Element* element)
+      {
+      auto i = slotIndex.find(element);
+      if (i == slotIndex.end()) {
+            insert(element);
+            return;
+            }
+      int slot = i.value();
+      int oc1, or1, oc2, or2;
+      cellRange(x1[slot], y1[slot], x2[slot], y2[slot], &oc1, &or1, &oc2, &or2);
+      setBox(slot, element->pageBoundingRect());
+      int c1, r1, c2, r2;
+      cellRange(x1[slot], y1[slot], x2[slot], y2[slot], &c1, &r1, &c2, &r2);
+      // the grid only needs to be rebuilt if the element
+      // moved into other cells
+      if (c1 != oc1 || r1 != or1 || c2 != oc2 || r2 != or2)
+            gridValid = false;
       }
 
 //---------------------------------------------------------
 //   items
+//    returns elements ordered by slot, so that the result
+//    does not depend on the cells they were found in.
+//    Slots of removed elements are reused, this is not
+//    the insertion order; painters sort by z anyway.
 //---------------------------------------------------------
 
-QList<Element*> BspTree::items(const QRectF& rect)
+QList<Element*> BspTree::items(const QRectF& r)
       {
-      FindItemBspTreeVisitor findVisitor;
-      climbTree(&findVisitor, rect);
+      QVector<int> found;
+      visitSlots(r, [&found](int i) { found.append(i); });
+      std::sort(found.begin(), found.end());
       QList<Element*> l;
-      for (Element * e : findVisitor.foundItems) {
-          e->itemDiscovered = false;
-          if (e->pageBoundingRect().intersects(rect))
-                l.append(e);
-          }
-          return l;
+      l.reserve(found.size());
+      for (int i : found)
+            l.append(elements[i]);
+      return l;
       }
 
 //---------------------------------------------------------
@@ -153,15 +264,11 @@ QList<Element*> BspTree::items(const QRectF& rect)
 
 QList<Element*> BspTree::items(const QPointF& pos)
       {
-      FindItemBspTreeVisitor findVisitor;
-      climbTree(&findVisitor, pos);
-
       QList<Element*> l;
-      for (Element* e : findVisitor.foundItems) {
-            e->itemDiscovered = false;
+      visit(pos, [&l, pos](Element* e) {
             if (e->contains(pos))
                   l.append(e);
-            }
+            });
       return l;
       }
 
@@ -170,182 +277,26 @@ QList<Element*> BspTree::items(const QPointF& pos)
 //   debug
 //---------------------------------------------------------
 
-QString BspTree::debug(int index) const
+QString BspTree::debug() const
       {
-      const Node* node = &nodes.at(index);
-
       QString tmp;
-      if (node->type == Node::Type::LEAF) {
-            QRectF rect = rectForIndex(index);
-            if (!leaves[node->leafIndex].isEmpty()) {
+      if (!gridValid)
+            return tmp;
+      qreal cw = rect.width() / cols;
+      qreal ch = rect.height() / rows;
+      for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                  int c = row * cols + col;
+                  int n = cellStart[c + 1] - cellStart[c];
+                  if (n == 0)
+                        continue;
                   tmp += QString::fromLatin1("[%1, %2, %3, %4] contains %5 items\n")
-                   .arg(rect.left()).arg(rect.top())
-                   .arg(rect.width()).arg(rect.height())
-                   .arg(leaves[node->leafIndex].size());
-                  }
-            }
-      else {
-            if (node->type == Node::Type::HORIZONTAL) {
-                  tmp += debug(firstChildIndex(index));
-                  tmp += debug(firstChildIndex(index) + 1);
-                  }
-            else {
-                  tmp += debug(firstChildIndex(index));
-                  tmp += debug(firstChildIndex(index) + 1);
+                   .arg(rect.left() + col * cw).arg(rect.top() + row * ch)
+                   .arg(cw).arg(ch).arg(n);
                   }
             }
       return tmp;
       }
 #endif
 
-//---------------------------------------------------------
-//   initialize
-//---------------------------------------------------------
-
-void BspTree::initialize(const QRectF& rect, int depth, int index)
-      {
-      Node* node = &nodes[index];
-      if (index == 0) {
-            node->type = Node::Type::HORIZONTAL;
-            node->offset = rect.center().x();
-            }
-
-      if (depth) {
-            Node::Type type;
-            QRectF rect1, rect2;
-            qreal offset1, offset2;
-
-            if (node->type == Node::Type::HORIZONTAL) {
-                  type = Node::Type::VERTICAL;
-                  rect1.setRect(rect.left(), rect.top(), rect.width(), rect.height() * .5);
-                  rect2.setRect(rect1.left(), rect1.bottom(), rect1.width(), rect.height() - rect1.height());
-                  offset1 = rect1.center().x();
-                  offset2 = rect2.center().x();
-                  }
-            else {
-                  type = Node::Type::HORIZONTAL;
-                  rect1.setRect(rect.left(), rect.top(), rect.width() * .5, rect.height());
-                  rect2.setRect(rect1.right(), rect1.top(), rect.width() - rect1.width(), rect1.height());
-                  offset1 = rect1.center().y();
-                  offset2 = rect2.center().y();
-                  }
-
-            int childIndex = firstChildIndex(index);
-
-            Node* child   = &nodes[childIndex];
-            child->offset = offset1;
-            child->type   = type;
-
-            child = &nodes[childIndex + 1];
-            child->offset = offset2;
-            child->type   = type;
-
-            initialize(rect1, depth - 1, childIndex);
-            initialize(rect2, depth - 1, childIndex + 1);
-            }
-      else {
-            node->type      = Node::Type::LEAF;
-            node->leafIndex = leafCnt++;
-            }
-      }
-
-//---------------------------------------------------------
-//   climbTree
-//---------------------------------------------------------
-
-void BspTree::climbTree(BspTreeVisitor* visitor, const QPointF& pos, int index)
-      {
-      if (nodes.isEmpty())
-            return;
-
-      Node* node = &nodes[index];
-      int childIndex = firstChildIndex(index);
-
-      switch (node->type) {
-            case Node::Type::LEAF:
-                  visitor->visit(&leaves[node->leafIndex]);
-                  break;
-            case Node::Type::VERTICAL:
-                  if (pos.x() < node->offset)
-                        climbTree(visitor, pos, childIndex);
-                  else
-                        climbTree(visitor, pos, childIndex + 1);
-                  break;
-            case Node::Type::HORIZONTAL:
-                  if (pos.y() < node->offset)
-                        climbTree(visitor, pos, childIndex);
-                  else
-                        climbTree(visitor, pos, childIndex + 1);
-                  break;
-            }
-      }
-
-//---------------------------------------------------------
-//   climbTree
-//---------------------------------------------------------
-
-void BspTree::climbTree(BspTreeVisitor* visitor, const QRectF& rect, int index)
-      {
-      if (nodes.isEmpty())
-            return;
-
-      Node* node = &nodes[index];
-      int childIndex = firstChildIndex(index);
-
-      switch (node->type) {
-            case Node::Type::LEAF:
-                  visitor->visit(&leaves[node->leafIndex]);
-                  break;
-            case Node::Type::VERTICAL:
-                  if (rect.left() < node->offset) {
-                        climbTree(visitor, rect, childIndex);
-                        if (rect.right() >= node->offset)
-                              climbTree(visitor, rect, childIndex + 1);
-                        }
-                  else {
-                        climbTree(visitor, rect, childIndex + 1);
-                        }
-                  break;
-            case Node::Type::HORIZONTAL:
-                  int childIndex = firstChildIndex(index);
-                  if (rect.top() < node->offset) {
-                        climbTree(visitor, rect, childIndex);
-                        if (rect.bottom() >= node->offset)
-                              climbTree(visitor, rect, childIndex + 1);
-                        }
-                  else {
-                        climbTree(visitor, rect, childIndex + 1);
-                        }
-            }
-      }
-
-//---------------------------------------------------------
-//   rectForIndex
-//---------------------------------------------------------
-
-QRectF BspTree::rectForIndex(int index) const
-      {
-      if (index <= 0)
-            return rect;
-
-      int parentIdx = parentIndex(index);
-      QRectF rect   = rectForIndex(parentIdx);
-      const Node *parent = &nodes.at(parentIdx);
-
-      if (parent->type == Node::Type::HORIZONTAL) {
-            if (index & 1)
-                  rect.setRight(parent->offset);
-            else
-                  rect.setLeft(parent->offset);
-            }
-      else {
-            if (index & 1)
-                  rect.setBottom(parent->offset);
-            else
-                  rect.setTop(parent->offset);
-            }
-      return rect;
-      }
-
 }
-
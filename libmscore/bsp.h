@@ -8,9 +8,6 @@
 //  it under the terms of the GNU General Public License version 2
 //  as published by the Free Software Foundation and appearing in
 //  the file LICENCE.GPL
-//
-//  This code is from Qt implementation of QGraphicsItem
-//    Copyright (C) 1992-2007 Trolltech ASA. All rights reserved.
 //=============================================================================
 
 #ifndef __BSP_H__
@@ -18,77 +15,166 @@
 
 namespace Ms {
 
-class BspTreeVisitor;
-class InsertItemBspTreeVisitor;
-class RemoveItemBspTreeVisitor;
-class FindItemBspTreeVisitor;
-
 class Element;
 
 //---------------------------------------------------------
 //   BspTree
-//    binary space partitioning
+//    spatial index of the elements of a page
+//
+//    The page rectangle is divided into a uniform grid.
+//    Element bounding boxes are kept in flat arrays
+//    (one array per coordinate), indexed by slot. The grid
+//    stores slot numbers in one contiguous array
+//    (cell c holds cellItems[cellStart[c]..cellStart[c+1]-1])
+//    and is rebuilt lazily from the box arrays after
+//    elements were inserted.
 //---------------------------------------------------------
 
 class BspTree
       {
-   public:
-      struct Node {
-            enum class Type : char { HORIZONTAL, VERTICAL, LEAF };
-            union {
-                  qreal offset;
-                  int leafIndex;
-                  };
-            Type type;
-            };
-   private:
-      uint depth;
-      void initialize(const QRectF& rect, int depth, int index);
-      void climbTree(BspTreeVisitor* visitor, const QPointF& pos, int index = 0);
-      void climbTree(BspTreeVisitor* visitor, const QRectF& rect, int index = 0);
-
-      void findItems(QList<Element*>* foundItems, const QRectF& rect, int index);
-      void findItems(QList<Element*>* foundItems, const QPointF& pos, int index);
-      QRectF rectForIndex(int index) const;
-
-      QVector<Node> nodes;
-      QVector<QList<Element*> > leaves;
-      int leafCnt;
       QRectF rect;
+      int cols;
+      int rows;
+      qreal sx;                     // cells per unit
+      qreal sy;
+
+      QVector<Element*> elements;   // 0 for a free slot
+      QVector<qreal> x1;
+      QVector<qreal> y1;
+      QVector<qreal> x2;
+      QVector<qreal> y2;
+      QVector<int> freeSlots;
+      QHash<Element*, int> slotIndex;
+
+      QVector<int> cellStart;
+      QVector<int> cellItems;
+      bool gridValid;
+
+      QVector<uint> stamp;          // last query which visited a slot
+      uint curStamp;
+
+      void cellRange(qreal l, qreal t, qreal r, qreal b, int* c1, int* r1, int* c2, int* r2) const;
+      void setBox(int slot, const QRectF&);
+      void buildGrid();
+      uint nextStamp();
+      template <typename F> void visitSlots(const QRectF& rect, F f);
 
    public:
       BspTree();
 
-      void initialize(const QRectF& rect, int depth);
+      void initialize(const QRectF& rect, int n);
       void clear();
 
       void insert(Element* item);
       void remove(Element* item);
+      void update(Element* item);
+
+      template <typename F> void visit(const QRectF& rect, F f);
+      template <typename F> void visit(const QPointF& pos, F f);
 
       QList<Element*> items(const QRectF& rect);
       QList<Element*> items(const QPointF& pos);
 
-      int leafCount() const                       { return leafCnt; }
-      inline int firstChildIndex(int index) const { return index * 2 + 1; }
-
-      inline int parentIndex(int index) const {
-            return index > 0 ? ((index & 1) ? ((index - 1) / 2) : ((index - 2) / 2)) : -1;
-            }
+      int count() const             { return slotIndex.size(); }
+      int cellCount() const         { return cols * rows;      }
 #ifndef NDEBUG
-      QString debug(int index) const;
+      QString debug() const;
 #endif
       };
 
 //---------------------------------------------------------
-//   BspTreeVisitor
+//   visitSlots
+//    call f(int) once for every slot whose bounding
+//    box intersects rect
 //---------------------------------------------------------
 
-class BspTreeVisitor
+template <typename F>
+void BspTree::visitSlots(const QRectF& r, F f)
       {
-   public:
-      virtual ~BspTreeVisitor() {}
-      virtual void visit(QList<Element*>* items) = 0;
-      };
+      QRectF nr(r.normalized());
+      if (slotIndex.isEmpty() || nr.width() == 0.0 || nr.height() == 0.0)
+            return;
+      if (!gridValid)
+            buildGrid();
+
+      const qreal l = nr.left();
+      const qreal t = nr.top();
+      const qreal rr = nr.right();
+      const qreal b = nr.bottom();
+      int c1, r1, c2, r2;
+      cellRange(l, t, rr, b, &c1, &r1, &c2, &r2);
+
+      // an element spanning several cells is listed in each of them
+      bool dedup = c1 != c2 || r1 != r2;
+      uint s     = dedup ? nextStamp() : 0;
+
+      Element* const* el = elements.constData();
+      const qreal* px1   = x1.constData();
+      const qreal* py1   = y1.constData();
+      const qreal* px2   = x2.constData();
+      const qreal* py2   = y2.constData();
+      const int* start   = cellStart.constData();
+      const int* items   = cellItems.constData();
+      uint* st           = stamp.data();
+
+      for (int row = r1; row <= r2; ++row) {
+            for (int col = c1; col <= c2; ++col) {
+                  int c = row * cols + col;
+                  for (int k = start[c]; k < start[c + 1]; ++k) {
+                        int i = items[k];
+                        if (dedup) {
+                              if (st[i] == s)
+                                    continue;
+                              st[i] = s;
+                              }
+                        // same semantics as QRectF::intersects()
+                        if (el[i] && px1[i] < px2[i] && py1[i] < py2[i]
+                           && px1[i] < rr && l < px2[i] && py1[i] < b && t < py2[i])
+                              f(i);
+                        }
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   visit
+//    call f(Element*) once for every element whose bounding
+//    box intersects rect; does not allocate
+//    f must not modify the tree
+//---------------------------------------------------------
+
+template <typename F>
+void BspTree::visit(const QRectF& r, F f)
+      {
+      Element* const* el = elements.constData();
+      visitSlots(r, [el, &f](int i) { f(el[i]); });
+      }
+
+//---------------------------------------------------------
+//   visit
+//    call f(Element*) for every element whose bounding
+//    box contains pos; callers refine with Element::contains()
+//---------------------------------------------------------
+
+template <typename F>
+void BspTree::visit(const QPointF& pos, F f)
+      {
+      if (slotIndex.isEmpty())
+            return;
+      if (!gridValid)
+            buildGrid();
+      const qreal x = pos.x();
+      const qreal y = pos.y();
+      int c1, r1, c2, r2;
+      cellRange(x, y, x, y, &c1, &r1, &c2, &r2);
+      int c = r1 * cols + c1;
+      for (int k = cellStart[c]; k < cellStart[c + 1]; ++k) {
+            int i = cellItems[k];
+            Element* e = elements[i];
+            if (e && x1[i] <= x && x <= x2[i] && y1[i] <= y && y <= y2[i])
+                  f(e);
+            }
+      }
 
 }     // namespace Ms
 #endif
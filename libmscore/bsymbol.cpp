@@ -59,7 +59,7 @@ void BSymbol::writeProperties(Xml& xml) const
 
 bool BSymbol::readProperties(XmlReader& e)
       {
-      const QStringRef& tag = e.name();
+      const XmlTag& tag = e.name();
 
       if (Element::readProperties(e))
             return true;
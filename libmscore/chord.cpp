@@ -969,7 +969,7 @@ void Chord::write(Xml& xml) const
 void Chord::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "Note") {
                   Note* note = new Note(score());
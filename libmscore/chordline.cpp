@@ -147,14 +147,14 @@ void ChordLine::read(XmlReader& e)
       {
       path = QPainterPath();
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "Path") {
                   path = QPainterPath();
                   QPointF curveTo;
                   QPointF p1;
                   int state = 0;
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "Element") {
                               int type = e.intAttribute("type");
                               qreal x  = e.doubleAttribute("x");
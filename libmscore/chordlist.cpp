@@ -376,7 +376,7 @@ void ChordToken::read(XmlReader& e)
       else
             tokenClass = ChordTokenClass::ALL;
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "name")
                   names += e.readElementText();
             else if (tag == "render")
@@ -1507,7 +1507,7 @@ void ChordDescription::read(XmlReader& e)
       int ni = 0;
       id = e.attribute("id").toInt();
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "name") {
                   QString n = e.readElementText();
                   // stack names for this file on top of the list
@@ -1565,7 +1565,7 @@ void ChordList::read(XmlReader& e)
       {
       int fontIdx = 0;
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "font") {
                   ChordFont f;
                   f.family = e.attribute("family", "default");
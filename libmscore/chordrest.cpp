@@ -246,7 +246,7 @@ void ChordRest::writeProperties(Xml& xml) const
 
 bool ChordRest::readProperties(XmlReader& e)
       {
-      const QStringRef& tag(e.name());
+      const XmlTag& tag(e.name());
 
       if (tag == "durationType") {
             setDurationType(e.readElementText());
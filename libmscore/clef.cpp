@@ -412,7 +412,7 @@ void Clef::setSmall(bool val)
 void Clef::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype")
                   setClefType(clefType(e.readElementText()));
             else if (tag == "concertClefType")
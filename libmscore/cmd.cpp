@@ -141,6 +141,7 @@ void Score::endCmd(bool rollback)
       if (MScore::debugMode)
             qDebug("===endCmd() %d", undo()->current()->childCount());
       bool noUndo = (undo()->current()->childCount() <= 1);       // nothing to undo?
+      invalidateMidiCache(undo()->current());
       undo()->endMacro(noUndo);
       end();      // DEBUG
 
@@ -208,6 +209,7 @@ void Score::end1()
 
 void Score::endUndoRedo()
       {
+      invalidateMidiCache(undo()->last());
       updateSelection();
       for (Score* score : scoreList()) {
             if (score->layoutAll()) {
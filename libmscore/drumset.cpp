@@ -71,7 +71,7 @@ void Drumset::load(XmlReader& e)
             return;
             }
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "head")
                   _drum[pitch].notehead = NoteHead::Group(e.readInt());
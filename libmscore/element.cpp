@@ -685,7 +685,7 @@ void Element::writeProperties(Xml& xml) const
 
 bool Element::readProperties(XmlReader& e)
       {
-      const QStringRef& tag(e.name());
+      const XmlTag& tag(e.name());
 
       if (tag == "track")
             setTrack(e.readInt() + e.trackOffset());
@@ -1048,7 +1048,7 @@ void Line::writeProperties(Xml& xml) const
 
 bool Line::readProperties(XmlReader& e)
       {
-      const QStringRef& tag(e.name());
+      const XmlTag& tag(e.name());
 
       if (tag == "lineWidth")
             _width = Spatium(e.readDouble());
@@ -1205,7 +1205,7 @@ Element::Type Element::readType(XmlReader& e, QPointF* dragOffset,
       while (e.readNextStartElement()) {
             if (e.name() == "Element")
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag = e.name();
+                        const XmlTag& tag = e.name();
                         if (tag == "dragOffset")
                               *dragOffset = e.readPoint();
                         else if (tag == "duration")
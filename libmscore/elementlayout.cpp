@@ -167,7 +167,7 @@ void ElementLayout::writeProperties(Xml& xml) const
 
 bool ElementLayout::readProperties(XmlReader& e)
       {
-      const QStringRef& tag(e.name());
+      const XmlTag& tag(e.name());
 
       if (tag == "halign") {
             const QString& val(e.readElementText());
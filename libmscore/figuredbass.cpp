@@ -408,7 +408,7 @@ void FiguredBassItem::write(Xml& xml) const
 void FiguredBassItem::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "brackets") {
                   parenth[0] = (Parenthesis)e.intAttribute("b0");
@@ -835,7 +835,7 @@ void FiguredBassItem::readMusicXML(XmlReader& e, bool paren)
       {
       // read the <figure> node de
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "figure-number") {
                   // MusicXML spec states figure-number is a number
                   // MuseScore can only handle single digit
@@ -1012,7 +1012,7 @@ void FiguredBass::read(XmlReader& e)
       QString normalizedText;
       int idx = 0;
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "ticks")
                   setTicks(e.readInt());
             else if (tag == "onNote")
@@ -1466,7 +1466,7 @@ FiguredBass * FiguredBass::addFiguredBassToSegment(Segment * seg, int track, int
 bool FiguredBassFont::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "family")
                   family = e.readElementText();
@@ -1505,7 +1505,7 @@ bool FiguredBassFont::read(XmlReader& e)
                   if (digit < 0 || digit > 9)
                         return false;
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "simple")
                               displayDigit[int(FiguredBassItem::Style::MODERN)]  [digit][int(FiguredBassItem::Combination::SIMPLE)]      = e.readElementText()[0];
                         else if (tag == "crossed")
@@ -1653,7 +1653,7 @@ bool FiguredBass::readMusicXML(XmlReader& e, int divisions)
       QString normalizedText;
       int idx = 0;
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "duration") {
                   QString val(e.readElementText());
                   bool ok = true;
@@ -370,7 +370,7 @@ void FretDiagram::write(Xml& xml) const
 void FretDiagram::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "strings")
                   _strings = e.readInt();
             else if (tag == "frets")
@@ -380,7 +380,7 @@ void FretDiagram::read(XmlReader& e)
             else if (tag == "string") {
                   int no = e.intAttribute("no");
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "dot")
                               setDot(no, e.readInt());
                         else if (tag == "marker")
@@ -529,7 +529,7 @@ void FretDiagram::readMusicXML(XmlReader& e)
       qDebug("FretDiagram::readMusicXML");
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "frame-frets") {
                   int val = e.readInt();
                   if (val > 0)
@@ -541,7 +541,7 @@ void FretDiagram::readMusicXML(XmlReader& e)
                   int fret   = -1;
                   int string = -1;
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         int val = e.readInt();
                         if (tag == "fret")
                               fret = val;
@@ -353,7 +353,7 @@ void Hairpin::read(XmlReader& e)
       e.addSpanner(id, this);
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype")
                   _hairpinType = Type(e.readInt());
             else if (tag == "lineWidth") {
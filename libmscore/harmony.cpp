@@ -268,7 +268,7 @@ void Harmony::read(XmlReader& e)
             };
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "base") {
                   if (score()->mscVersion() >= 106)
                         setBaseTpc(e.readInt());
@@ -294,7 +294,7 @@ void Harmony::read(XmlReader& e)
                   int degreeAlter = 0;
                   QString degreeType = "";
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "degree-value")
                               degreeValue = e.readInt();
                         else if (tag == "degree-alter")
@@ -35,7 +35,7 @@ void Icon::write(Xml& xml) const
 void Icon::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "action")
                   _action = e.readElementText().toLocal8Bit();
             else if (tag == "subtype")
@@ -374,7 +374,7 @@ void Image::read(XmlReader& e)
             _sizeIsSpatium = false;
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "autoScale")
                   setProperty(P_ID::AUTOSCALE, Ms::getProperty(P_ID::AUTOSCALE, e));
             else if (tag == "size")
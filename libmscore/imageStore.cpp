@@ -14,11 +14,14 @@
 #include "imageStore.h"
 #include "score.h"
 #include "image.h"
+#include "scorearchive.h"
 
 namespace Ms {
 
 ImageStore imageStore;  // the global image store
 
+static QMutex archiveMutex;   // serializes lazy loads from concurrent layouts
+
 //---------------------------------------------------------
 //   ImageStoreItem
 //---------------------------------------------------------
@@ -68,6 +71,10 @@ bool ImageStoreItem::isUsed(Score* score) const
 
 void ImageStoreItem::load()
       {
+      if (_pending.loadAcquire()) {
+            loadFromArchive();
+            return;
+            }
       if (!_buffer.isEmpty())
             return;
       QFile inFile(_path);
@@ -82,6 +89,34 @@ void ImageStoreItem::load()
       _hash = h.result();
       }
 
+//---------------------------------------------------------
+//   setArchive
+//    h is the hash taken from the file name of the picture
+//---------------------------------------------------------
+
+void ImageStoreItem::setArchive(QSharedPointer<ScoreArchive> archive, const QByteArray& h)
+      {
+      _archive = archive;
+      _hash    = h;
+      _pending.storeRelease(1);
+      }
+
+//---------------------------------------------------------
+//   loadFromArchive
+//---------------------------------------------------------
+
+void ImageStoreItem::loadFromArchive()
+      {
+      QMutexLocker locker(&archiveMutex);
+      if (!_pending.loadAcquire())
+            return;
+      _buffer = _archive->fileData(_path);
+      if (_buffer.isEmpty())
+            qDebug("ImageStoreItem: cannot read <%s> from archive", qPrintable(_path));
+      _archive.clear();
+      _pending.storeRelease(0);
+      }
+
 //---------------------------------------------------------
 //   hashName
 //---------------------------------------------------------
@@ -139,14 +174,36 @@ static void dumpHash(const QByteArray& _hash)
       }
 #endif
 
+//---------------------------------------------------------
+//   hashFromName
+//    pictures are stored under the hex coded hash of
+//    their contents
+//---------------------------------------------------------
+
+static bool hashFromName(const QString& path, QByteArray* hash)
+      {
+      QString s = QFileInfo(path).baseName();
+      if (s.size() != 32)
+            return false;
+      for (const QChar& c : s) {
+            if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+                  return false;
+            }
+      hash->resize(16);
+      for (int i = 0; i < 16; ++i)
+            (*hash)[i] = toInt(s[i * 2].toLatin1()) * 16 + toInt(s[i * 2 + 1].toLatin1());
+      return true;
+      }
+
 //---------------------------------------------------------
 //   getImage
 //---------------------------------------------------------
 
 ImageStoreItem* ImageStore::getImage(const QString& path) const
       {
-      QString s = QFileInfo(path).baseName();
-      if (s.size() != 32) {
+      QByteArray hash;
+      if (!hashFromName(path, &hash)) {
+            QString s = QFileInfo(path).baseName();
             //
             // some limited support for backward compatibility
             //
@@ -161,10 +218,6 @@ ImageStoreItem* ImageStore::getImage(const QString& path) const
 
             return 0;
             }
-      QByteArray hash(16, 0);
-      for (int i = 0; i < 16; ++i) {
-            hash[i] = toInt(s[i * 2].toLatin1()) * 16 + toInt(s[i * 2 + 1].toLatin1());
-            }
       foreach(ImageStoreItem* item, *this) {
             if (item->hash() == hash)
                   return item;
@@ -192,5 +245,26 @@ ImageStoreItem* ImageStore::add(const QString& path, const QByteArray& ba)
       return item;
       }
 
-}
+//---------------------------------------------------------
+//   add
+//    add a picture of a .mscz file without decompressing
+//    it; pictures not stored under their hash name are
+//    loaded at once
+//---------------------------------------------------------
 
+ImageStoreItem* ImageStore::add(const QString& path, QSharedPointer<ScoreArchive> archive)
+      {
+      QByteArray hash;
+      if (!hashFromName(path, &hash))
+            return add(path, archive->fileData(path));
+      foreach(ImageStoreItem* item, *this) {
+            if (item->hash() == hash)
+                  return item;
+            }
+      ImageStoreItem* item = new ImageStoreItem(path);
+      item->setArchive(archive, hash);
+      append(item);
+      return item;
+      }
+
+}
@@ -17,9 +17,12 @@ namespace Ms {
 
 class Image;
 class Score;
+class ScoreArchive;
 
 //---------------------------------------------------------
 //   ImageStoreItem
+//    a picture read from a .mscz file is decompressed
+//    on the first call to buffer()
 //---------------------------------------------------------
 
 class ImageStoreItem {
@@ -29,14 +32,21 @@ class ImageStoreItem {
       QByteArray _buffer;
       QByteArray _hash;             // 16 byte md4 hash of _buffer
 
+      QSharedPointer<ScoreArchive> _archive;    // source of a not yet loaded picture
+      QAtomicInt _pending;
+
+      void loadFromArchive();
+
    public:
       ImageStoreItem(const QString& p);
       void dereference(Image*);
       void reference(Image*);
+      bool isReferenced() const        { return !_references.isEmpty(); }
 
       const QString& path() const      { return _path;     }
-      QByteArray& buffer()             { return _buffer;   }
-      bool loaded() const              { return !_buffer.isEmpty();   }
+      QByteArray& buffer()             { if (_pending.loadAcquire()) loadFromArchive(); return _buffer; }
+      bool loaded() const              { return !_buffer.isEmpty() || _pending.loadAcquire(); }
+      void setArchive(QSharedPointer<ScoreArchive>, const QByteArray& h);
       void setPath(const QString& val);
       bool isUsed(Score*) const;
       void load();
@@ -54,6 +64,7 @@ class ImageStore : public QList<ImageStoreItem*>  {
    public:
       ImageStoreItem* getImage(const QString& path) const;
       ImageStoreItem* add(const QString& path, const QByteArray&);
+      ImageStoreItem* add(const QString& path, QSharedPointer<ScoreArchive>);
       };
 
 extern ImageStore imageStore;       // this is the global imageStore
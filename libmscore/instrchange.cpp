@@ -81,7 +81,7 @@ void InstrumentChange::write(Xml& xml) const
 void InstrumentChange::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "Instrument")
                   _instrument->read(e);
             else if (!Text::readProperties(e))
@@ -77,7 +77,7 @@ void InstrumentGroup::read(XmlReader& e)
       extended = e.intAttribute("extended", 0);
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "instrument" || tag == "Instrument") {
                   QString id = e.attribute("id");
                   InstrumentTemplate* t = searchTemplate(id);
@@ -311,7 +311,7 @@ void InstrumentTemplate::read(XmlReader& e)
       id = e.attribute("id");
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "longName" || tag == "name") {               // "name" is obsolete
                   int pos = e.intAttribute("pos", 0);
@@ -618,7 +618,7 @@ bool loadInstrumentTemplates(const QString& instrTemplates)
       while (e.readNextStartElement()) {
             if (e.name() == "museScore") {
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "instrument-group" || tag == "InstrumentGroup") {
                               QString id(e.attribute("id"));
                               InstrumentGroup* group = searchInstrumentGroup(id);
@@ -715,7 +715,7 @@ void InstrumentGenre::read(XmlReader& e)
       {
       id = e.attribute("id");
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "name") {
                   name = qApp->translate("InstrumentsXML", e.readElementText().toUtf8().data());
             }
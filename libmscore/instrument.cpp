@@ -45,7 +45,7 @@ void NamedEventList::read(XmlReader& e)
       {
       name = e.attribute("name");
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "program") {
                   MidiCoreEvent ev(ME_CONTROLLER, 0, CTRL_PROGRAM, e.intAttribute("value", 0));
                   events.push_back(ev);
@@ -262,7 +262,7 @@ void Instrument::read(XmlReader& e)
 
       _channel.clear();       // remove default channel
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "longName") {
                   StaffName name;
@@ -486,7 +486,7 @@ void Channel::read(XmlReader& e)
       if (name == "")
             name = "normal";
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "program") {
                   program = e.intAttribute("value", -1);
                   if (program == -1)
@@ -628,7 +628,7 @@ void MidiArticulation::read(XmlReader& e)
       {
       name = e.attribute("name");
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "velocity") {
                   QString text(e.readElementText());
                   if (text.endsWith("%"))
@@ -93,7 +93,7 @@ QString Jump::jumpTypeUserName() const
 void Jump::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "jumpTo")
                   _jumpTo = e.readElementText();
             else if (tag == "playUntil")
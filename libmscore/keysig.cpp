@@ -349,11 +349,11 @@ void KeySig::read(XmlReader& e)
       int subtype = 0;
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "KeySym") {
                   KeySym ks;
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "sym") {
                               QString val(e.readElementText());
                               bool valid;
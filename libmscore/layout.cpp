@@ -49,6 +49,7 @@
 #include "tremolo.h"
 #include "tuplet.h"
 #include "undo.h"
+#include "profiler.h"
 #include "utils.h"
 #include "volta.h"
 
@@ -1188,15 +1189,35 @@ void Score::beamGraceNotes(Chord* mainNote, bool after)
             a1->removeDeleteBeam();
       }
 
+//---------------------------------------------------------
+//   startSegment
+//    first chordrest segment of the measure at tick
+//---------------------------------------------------------
+
+static Segment* startSegment(Score* score, int tick)
+      {
+      Segment::Type st = Segment::Type::ChordRest;
+      if (tick == 0)
+            return score->firstSegment(st);
+      Segment* s = score->tick2measure(tick)->first();
+      if (s && s->segmentType() != st)
+            s = s->next1(st);
+      return s;
+      }
+
 //---------------------------------------------------------
 //   layoutStage2
 //    auto - beamer
+//    only segments in the range [stick, etick) are
+//    processed; etick == -1 means up to the end of the score
 //---------------------------------------------------------
 
-void Score::layoutStage2()
+void Score::layoutStage2(int stick, int etick)
       {
       int tracks = nstaves() * VOICES;
       bool crossMeasure = styleB(StyleIdx::crossMeasureValues);
+      Segment::Type st = Segment::Type::ChordRest;
+      Segment* ss = startSegment(this, stick);
 
       for (int track = 0; track < tracks; ++track) {
             Staff* stf = staff(track2staff(track));
@@ -1210,13 +1231,24 @@ void Score::layoutStage2()
             Measure* measure = 0;
 
             Beam::Mode bm    = Beam::Mode::AUTO;
-            Segment::Type st = Segment::Type::ChordRest;
             ChordRest* prev  = 0;
             bool checkBeats  = false;
             Fraction stretch = 1;
             QHash<int, TDuration> beatSubdivision;
 
-            for (Segment* segment = firstSegment(st); segment; segment = segment->next1(st)) {
+            // a partial layout continues after the last chordrest before the range
+            if (ss) {
+                  for (Segment* s = ss->prev1(st); s; s = s->prev1(st)) {
+                        if (s->element(track)) {
+                              prev = static_cast<ChordRest*>(s->element(track));
+                              break;
+                              }
+                        }
+                  }
+
+            for (Segment* segment = ss; segment; segment = segment->next1(st)) {
+                  if (etick != -1 && segment->tick() >= etick)
+                        break;
                   ChordRest* cr = static_cast<ChordRest*>(segment->element(track));
                   if (cr == 0)
                         continue;
@@ -1373,17 +1405,191 @@ void Score::layoutStage2()
 //   layoutStage3
 //---------------------------------------------------------
 
-void Score::layoutStage3()
+void Score::layoutStage3(int stick, int etick)
+      {
+      Segment* ss = startSegment(this, stick);
+      if (MScore::parallelLayout && _parts.size() > 1) {
+            // note head placement only touches the chords of one staff;
+            // cross staff chords stay within their part, so parts
+            // can be laid out independently
+            QList<Part*> parts(_parts);
+            QtConcurrent::blockingMap(parts, [this, ss, etick](Part* part) {
+                  int startStaff = part->startTrack() / VOICES;
+                  layoutStaves3(startStaff, startStaff + part->nstaves(), ss, etick);
+                  });
+            }
+      else
+            layoutStaves3(0, nstaves(), ss, etick);
+      }
+
+//---------------------------------------------------------
+//   layoutStaves3
+//    compute note head horizontal positions for the staves
+//    [startStaff, endStaff) starting at segment ss
+//---------------------------------------------------------
+
+void Score::layoutStaves3(int startStaff, int endStaff, Segment* ss, int etick)
       {
       Segment::Type st = Segment::Type::ChordRest;
-      for (int staffIdx = 0; staffIdx < nstaves(); ++staffIdx) {
+      for (int staffIdx = startStaff; staffIdx < endStaff; ++staffIdx) {
             if (!staff(staffIdx)->show())
                   continue;
-            for (Segment* segment = firstSegment(st); segment; segment = segment->next1(st))
+            for (Segment* segment = ss; segment; segment = segment->next1(st)) {
+                  if (etick != -1 && segment->tick() >= etick)
+                        break;
                   layoutChords1(segment, staffIdx);
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   layoutRange
+//    Compute the range of measures touched by the running
+//    (or just undone/redone) command. Returns false if the
+//    whole score has to be laid out.
+//---------------------------------------------------------
+
+bool Score::layoutRange(int* stick, int* etick) const
+      {
+      if (!MScore::incrementalLayout || (layoutFlags & LayoutFlag::FIX_TICKS))
+            return false;
+      const UndoCommand* cmd = undo()->active() ? undo()->current() : (undoRedo() ? undo()->last() : 0);
+      int t1 = -1;
+      int t2 = -1;
+      if (!cmd || !cmd->layoutRange(&t1, &t2) || t1 == -1)
+            return false;
+      Measure* sm = tick2measure(t1);
+      Measure* em = tick2measure(t2 - 1);
+      if (!sm || !em)
+            return false;
+
+      // ties and accidentals propagate into the neighbour measures
+      if (sm->prevMeasure())
+            sm = sm->prevMeasure();
+      if (em->nextMeasure())
+            em = em->nextMeasure();
+
+      // extend the range to include beams crossing its boundaries
+      Segment::Type st = Segment::Type::ChordRest;
+      for (bool changed = true; changed;) {
+            changed = false;
+            for (int track = 0; track < ntracks(); ++track) {
+                  for (Segment* s = sm->first(st); s; s = s->next(st)) {
+                        ChordRest* cr = static_cast<ChordRest*>(s->element(track));
+                        if (!cr)
+                              continue;
+                        if (cr->beam() && cr->beam()->elements().front()->measure() != sm) {
+                              sm      = cr->beam()->elements().front()->measure();
+                              changed = true;
+                              }
+                        break;
+                        }
+                  for (Segment* s = em->last(); s; s = s->prev(st)) {
+                        if (!s->isChordRest() || !s->element(track))
+                              continue;
+                        ChordRest* cr = static_cast<ChordRest*>(s->element(track));
+                        if (cr->beam() && cr->beam()->elements().back()->measure() != em) {
+                              em      = cr->beam()->elements().back()->measure();
+                              changed = true;
+                              }
+                        break;
+                        }
+                  }
+            }
+      *stick = sm->tick();
+      *etick = em->endTick();
+      return true;
+      }
+
+//---------------------------------------------------------
+//   layoutSegments
+//    place beams, stems, ties, articulations, bar lines and
+//    annotations for the segments [fs, ls) of the (multi
+//    measure rest) segment list. The segment list is walked
+//    only once; all tracks of a segment are processed before
+//    moving to the next one.
+//---------------------------------------------------------
+
+void Score::layoutSegments(Segment* fs, Segment* ls)
+      {
+      int tracks = ntracks();
+      QVector<bool> staffVisible(nstaves());
+      for (int staffIdx = 0; staffIdx < nstaves(); ++staffIdx)
+            staffVisible[staffIdx] = staff(staffIdx)->show();
+
+      for (Segment* segment = fs; segment && segment != ls; segment = segment->next1MM()) {
+            for (int track = 0; track < tracks; ++track) {
+                  Element* e = segment->element(track);
+                  if (!e)
+                        continue;
+                  if (e->isChordRest()) {
+                        if (!staffVisible[track2staff(track)])
+                              continue;
+                        ChordRest* cr = static_cast<ChordRest*>(e);
+                        if (cr->beam() && cr->beam()->elements().front() == cr)
+                              cr->beam()->layout();
+
+                        if (cr->type() == Element::Type::CHORD) {
+                              Chord* c = static_cast<Chord*>(cr);
+                              for (Chord* cc : c->graceNotes()) {
+                                    if (cc->beam() && cc->beam()->elements().front() == cc)
+                                          cc->beam()->layout();
+                                    for (Note* n : cc->notes()) {
+                                          Tie* tie = n->tieFor();
+                                          if (tie)
+                                                tie->layout();
+                                          for (Spanner* sp : n->spannerFor())
+                                                sp->layout();
+                                          }
+                                    for (Element* e : cc->el()) {
+                                          if (e->type() == Element::Type::SLUR)
+                                                e->layout();
+                                          }
+                                    cc->layoutArticulations();
+                                    }
+                              c->layoutStem();
+                              c->layoutArpeggio2();
+                              for (Note* n : c->notes()) {
+                                    Tie* tie = n->tieFor();
+                                    if (tie)
+                                          tie->layout();
+                                    for (Spanner* sp : n->spannerFor())
+                                          sp->layout();
+                                    }
+                              }
+                        cr->layoutArticulations();
+                        }
+                  else if (e->type() == Element::Type::BAR_LINE)
+                        e->layout();
+                  }
+            for (Element* e : segment->annotations())
+                  e->layout();
             }
       }
 
+//---------------------------------------------------------
+//   firstMeasureOf
+//    first measure at or after mb
+//---------------------------------------------------------
+
+static Measure* firstMeasureOf(MeasureBase* mb)
+      {
+      while (mb && mb->type() != Element::Type::MEASURE)
+            mb = mb->nextMM();
+      return static_cast<Measure*>(mb);
+      }
+
+//---------------------------------------------------------
+//   overlaps
+//    true if sp has to be laid out after a layout of the
+//    measures from stick to etick (-1: up to the end)
+//---------------------------------------------------------
+
+static bool overlaps(Spanner* sp, int stick, int etick)
+      {
+      return (etick == -1 || sp->tick() < etick) && sp->tick2() >= stick;
+      }
+
 //---------------------------------------------------------
 //   layout
 //    - measures are akkumulated into systems
@@ -1416,9 +1622,21 @@ void Score::doLayout()
             return;
             }
 
+      ProfileScope profile("layout");
+      ProfilePhases phase("layout");
+
       _scoreFont = ScoreFont::fontFactory(_style.value(StyleIdx::MusicalSymbolFont).toString());
       _noteHeadWidth = _scoreFont->width(SymId::noteheadBlack, spatium() / (MScore::DPI * SPATIUM20));
 
+      // if the last command touched only some measures, the
+      // per chord layout stages are limited to them
+      int stick = 0;
+      int etick = -1;
+      if (!layoutRange(&stick, &etick)) {
+            stick = 0;
+            etick = -1;
+            }
+
       if (layoutFlags & LayoutFlag::FIX_TICKS)
             fixTicks();
       if (layoutFlags & LayoutFlag::FIX_PITCH_VELO)
@@ -1428,7 +1646,7 @@ void Score::doLayout()
       layoutFlags = 0;
 
       int measureNo = 0;
-      int nstaves = _staves.size();
+      int stage1Measures = 0;
       for (MeasureBase* m = first(); m; m = m->next()) {      // set layout break
             m->setPageBreak(false);
             m->setLineBreak(false);
@@ -1458,76 +1676,46 @@ void Score::doLayout()
                         measureNo = 0;
                   else if (!measure->irregular())      // dont count measure
                         ++measureNo;
-                  measure->layoutStage1();
+                  if (etick == -1 || (measure->tick() >= stick && measure->tick() < etick)) {
+                        measure->layoutStage1();
+                        ++stage1Measures;
+                        }
                   }
             }
+      Profiler::addCount("layout/stage1", stage1Measures);
+      phase.elapsed("stage1");
 
-      if (styleB(StyleIdx::createMultiMeasureRests))
+      if (styleB(StyleIdx::createMultiMeasureRests)) {
             createMMRests();
+            phase.elapsed("mmrests");
+            }
 
-      layoutStage2();   // beam notes, finally decide if chord is up/down
-      layoutStage3();   // compute note head horizontal positions
+      layoutStage2(stick, etick);   // beam notes, finally decide if chord is up/down
+      phase.elapsed("stage2");
+      layoutStage3(stick, etick);   // compute note head horizontal positions
+      phase.elapsed("stage3");
 
+      // the systems [ss, es) are laid out; the others are kept
+      int ss = 0;
+      int es = -1;
       if (layoutMode() == LayoutMode::LINE)
             layoutLinear();
       else
-            layoutSystems();  // create list of systems
+            layoutSystems(stick, etick, &ss, &es);  // create list of systems
+      phase.elapsed("systems");
+
+      // the measures and ticks covered by the systems [ss, es)
+      Measure* fm = ss > 0 ? firstMeasureOf(_systems[ss]->measures().front()) : firstMeasureMM();
+      Measure* lm = (es != -1 && es < _systems.size()) ? firstMeasureOf(_systems[es]->measures().front()) : 0;
+      stick = (ss > 0 && fm) ? fm->tick() : 0;
+      etick = lm ? lm->tick() : -1;
 
       //---------------------------------------------------
       //   place Spanner & beams
       //---------------------------------------------------
 
-      int tracks = nstaves * VOICES;
-      for (int track = 0; track < tracks; ++track) {
-            for (Segment* segment = firstSegmentMM(); segment; segment = segment->next1MM()) {
-                  if (track == tracks-1) {
-                        for (Element* e : segment->annotations())
-                              e->layout();
-                        }
-                  Element* e = segment->element(track);
-                  if (!e)
-                        continue;
-                  if (e->isChordRest()) {
-                        if (!staff(track2staff(track))->show())
-                              continue;
-                        ChordRest* cr = static_cast<ChordRest*>(e);
-                        if (cr->beam() && cr->beam()->elements().front() == cr)
-                              cr->beam()->layout();
-
-                        if (cr->type() == Element::Type::CHORD) {
-                              Chord* c = static_cast<Chord*>(cr);
-                              for (Chord* cc : c->graceNotes()) {
-                                    if (cc->beam() && cc->beam()->elements().front() == cc)
-                                          cc->beam()->layout();
-                                    for (Note* n : cc->notes()) {
-                                          Tie* tie = n->tieFor();
-                                          if (tie)
-                                                tie->layout();
-                                          for (Spanner* sp : n->spannerFor())
-                                                sp->layout();
-                                          }
-                                    for (Element* e : cc->el()) {
-                                          if (e->type() == Element::Type::SLUR)
-                                                e->layout();
-                                          }
-                                    cc->layoutArticulations();
-                                    }
-                              c->layoutStem();
-                              c->layoutArpeggio2();
-                              for (Note* n : c->notes()) {
-                                    Tie* tie = n->tieFor();
-                                    if (tie)
-                                          tie->layout();
-                                    for (Spanner* sp : n->spannerFor())
-                                          sp->layout();
-                                    }
-                              }
-                        cr->layoutArticulations();
-                        }
-                  else if (e->type() == Element::Type::BAR_LINE)
-                        e->layout();
-                  }
-            }
+      layoutSegments(fm ? fm->first() : 0, lm ? lm->first() : 0);
+      phase.elapsed("segments");
 
       if (lastSegment())
             checkSpanner(0, lastSegment()->tick());
@@ -1543,28 +1731,39 @@ void Score::doLayout()
                   if (sp->tick() == -1) {
                         qDebug("bad spanner %s %d - %d", sp->name(), sp->tick(), sp->tick2());
                         }
-                  else
+                  else if (overlaps(sp, stick, etick))
                         sp->layout();
                   }
             }
       for (Spanner* s : _unmanagedSpanner)
             s->layout();
+      phase.elapsed("spanner");
 
+      int fp = 0;
       if (layoutMode() != LayoutMode::LINE) {
-            layoutSystems2();
-            layoutPages();    // create list of pages
+            layoutSystems2(ss, es);
+            layoutPages(ss, es, &fp);    // create list of pages
+            phase.elapsed("pages");
             }
-      for (Measure* m = firstMeasureMM(); m; m = m->nextMeasureMM())
+      for (Measure* m = fm; m && m != lm; m = m->nextMeasureMM())
             m->layout2();
 
       for (auto s : _spanner.map()) {           // DEBUG
             Spanner* sp = s.second;
-            if (sp->type() == Element::Type::SLUR) {
+            if (sp->type() == Element::Type::SLUR && overlaps(sp, stick, etick)) {
                   sp->layout();
                   }
             }
+      phase.elapsed("measures");
 
-      rebuildBspTree();
+      // pages after curPage were kept by layoutPages()
+      if (es == -1)
+            rebuildBspTree();
+      else {
+            for (int i = fp; i < curPage; ++i)
+                  _pages[i]->rebuildBspTree();
+            }
+      phase.elapsed("bsp");
 
       for (MuseScoreView* v : viewer)
             v->layoutChanged();
@@ -3050,18 +3249,71 @@ QList<System*> Score::layoutSystemRow(qreal rowWidth, bool isFirstSystem, bool u
 //---------------------------------------------------------
 //   layoutSystems
 //   create list of systems
+//    If etick is not -1, only the measures from stick to
+//    etick have changed. Then the systems are laid out
+//    from the row before the first changed measure until
+//    a row starts with the same measure as before; the
+//    following systems are kept. The range [ss, es) of
+//    systems laid out is returned.
 //---------------------------------------------------------
 
-void Score::layoutSystems()
+void Score::layoutSystems(int stick, int etick, int* ss, int* es)
       {
       curMeasure              = _showVBox ? firstMM() : firstMeasureMM();
       curSystem               = 0;
       bool firstSystem        = true;
       bool startWithLongNames = true;
 
+      // systems are only kept in page and system mode and
+      // without multi measure rests, which are recreated for
+      // the whole score
+      if (etick != -1
+         && (_layoutMode == LayoutMode::PAGE || _layoutMode == LayoutMode::SYSTEM)
+         && !styleB(StyleIdx::createMultiMeasureRests)) {
+            Measure* m = tick2measure(stick);
+            int idx    = m ? _systems.indexOf(m->system()) : -1;
+            if (idx != -1) {
+                  // measures may move into the previous row
+                  if (idx > 0)
+                        --idx;
+                  while (idx > 0 && _systems[idx]->sameLine())
+                        --idx;
+                  curSystem  = idx;
+                  curMeasure = _systems[idx]->measures().front();
+                  for (int i = idx - 1; i >= 0; --i) {
+                        if (_systems[i]->isVbox())
+                              continue;
+                        Measure* lm = _systems[i]->lastMeasure();
+                        firstSystem = lm && lm->sectionBreak() && _layoutMode != LayoutMode::FLOAT;
+                        startWithLongNames = firstSystem && lm->sectionBreak()->startWithLongNames();
+                        break;
+                        }
+                  }
+            else
+                  etick = -1;
+            }
+      else
+            etick = -1;
+      if (ss)
+            *ss = curSystem;
+
       qreal w  = pageFormat()->printableWidth() * MScore::DPI;
 
       while (curMeasure) {
+            if (etick != -1 && curMeasure->tick() >= etick) {
+                  // the line breaks are stable if the next measure
+                  // still starts a system which was not reused
+                  System* system = curMeasure->system();
+                  int idx = system ? _systems.indexOf(system, curSystem) : -1;
+                  if (idx != -1 && !system->sameLine() && system->measures().front() == curMeasure) {
+                        // TODO: make undoable:
+                        while (idx-- > curSystem)
+                              _systems.removeAt(curSystem);
+                        if (es)
+                              *es = curSystem;
+                        return;
+                        }
+                  }
             Element::Type t = curMeasure->type();
             if (t == Element::Type::VBOX || t == Element::Type::TBOX || t == Element::Type::FBOX) {
                   System* system = getNextSystem(false, true);
@@ -3099,17 +3351,20 @@ void Score::layoutSystems()
       // TODO: make undoable:
       while (_systems.size() > curSystem)
             _systems.takeLast();
+      if (es)
+            *es = etick == -1 ? -1 : curSystem;
       }
 
 //---------------------------------------------------------
 //   layoutSystems2
-//    update distanceUp, distanceDown
+//    update distanceUp, distanceDown of the systems
+//    [ss, es)
 //---------------------------------------------------------
 
-void Score::layoutSystems2()
+void Score::layoutSystems2(int ss, int es)
       {
-      int n = _systems.size();
-      for (int i = 0; i < n; ++i) {
+      int n = es == -1 ? _systems.size() : es;
+      for (int i = ss; i < n; ++i) {
             System* system = _systems.at(i);
             if (!system->isVbox()) {
                   system->layout2();
@@ -3331,9 +3586,14 @@ struct PageContext {
 //---------------------------------------------------------
 //   layoutPages
 //    create list of pages
+//    If es is not -1, only the systems [ss, es) have
+//    changed. Then the pages are laid out from the page
+//    of system ss until a page starts with the same system
+//    as before; the following pages are kept. The index
+//    of the first page laid out is returned in fp.
 //---------------------------------------------------------
 
-void Score::layoutPages()
+void Score::layoutPages(int ss, int es, int* fp)
       {
       const qreal _spatium            = spatium();
       const qreal slb                 = styleS(StyleIdx::staffLowerBorder).val()    * _spatium;
@@ -3342,19 +3602,42 @@ void Score::layoutPages()
       const qreal systemFrameDistance = styleS(StyleIdx::systemFrameDistance).val() * _spatium;
       const qreal frameSystemDistance = styleS(StyleIdx::frameSystemDistance).val() * _spatium;
 
-      curPage = 0;
+      int nSystems = _systems.size();
+
+      curPage   = 0;
+      int start = 0;
+      if (es != -1 && ss < nSystems) {
+            Page* page = _systems[ss]->page();
+            int idx    = page ? _pages.indexOf(page) : -1;
+            int first  = (idx != -1 && !page->systems()->isEmpty()) ? _systems.indexOf(page->systems()->front()) : -1;
+            if (first != -1 && first <= ss) {
+                  curPage = idx;
+                  start   = first;
+                  }
+            else
+                  es = -1;
+            }
+      if (fp)
+            *fp = curPage;
+
+      // true if system i starts the next page as before
+      auto unchanged = [&](int i) {
+            if (es == -1 || i < es || i >= nSystems || curPage >= _pages.size())
+                  return false;
+            Page* page = _pages[curPage];
+            return _systems[i]->page() == page && !page->systems()->isEmpty() && page->systems()->front() == _systems[i];
+            };
 
       PageContext pC(this);
       pC.newPage();
 
-      int nSystems = _systems.size();
-
 PAGEDBG("layoutPages");
-      for (int i = 0; i < nSystems; ++i) {
+      for (int i = start; i < nSystems; ++i) {
 PAGEDBG("  system %d", i);
             //
             // collect system row
             //
+            int row = i;
             pC.sr.clear();
             for (;;) {
                   System* system = _systems[i];
@@ -3415,6 +3698,8 @@ PAGEDBG("      == page break");
                   else
                         d = slb;
                   layoutPage(pC, d);
+                  if (unchanged(row))
+                        return;
                   pC.newPage();
                   if (pC.sr.isVbox())
                         tmargin = pC.sr.vbox()->topGap();
@@ -3445,6 +3730,8 @@ PAGEDBG("      == page break");
                   if ((i + 1) == nSystems)
                         break;
                   pC.layoutPage();
+                  if (unchanged(i + 1))
+                        return;
                   pC.newPage();
                   }
             else
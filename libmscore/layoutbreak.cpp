@@ -69,7 +69,7 @@ void LayoutBreak::write(Xml& xml) const
 void LayoutBreak::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype")
                   setProperty(P_ID::LAYOUT_BREAK, Ms::getProperty(P_ID::LAYOUT_BREAK, e));
             else if (tag == "pause")
@@ -42,7 +42,7 @@ LineSegment::LineSegment(const LineSegment& s)
 
 bool LineSegment::readProperties(XmlReader& e)
       {
-      const QStringRef& tag(e.name());
+      const XmlTag& tag(e.name());
       if (tag == "subtype")
             setSpannerSegmentType(SpannerSegmentType(e.readInt()));
       else if (tag == "off1")        // off1 is obsolete
@@ -887,7 +887,7 @@ void SLine::writeProperties(Xml& xml) const
 
 bool SLine::readProperties(XmlReader& e)
       {
-      const QStringRef& tag(e.name());
+      const XmlTag& tag(e.name());
 
       if (tag == "tick2") {                // obsolete
             if (tick() == -1) // not necessarily set (for first note of score?) #30151
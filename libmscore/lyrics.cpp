@@ -134,7 +134,7 @@ void Lyrics::read(XmlReader& e)
       Text* _verseNumber = 0;
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "no")
                   _no = e.readInt();
             else if (tag == "syllabic") {
@@ -193,7 +193,7 @@ void Marker::read(XmlReader& e)
       Type mt = Type::SEGNO;
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "label") {
                   QString s(e.readElementText());
                   setLabel(s);
@@ -1781,7 +1781,7 @@ void Measure::read(XmlReader& e, int staffIdx)
       int lastTick = e.tick();
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "tick") {
                   e.initTick(score()->fileDivision(e.readInt()));
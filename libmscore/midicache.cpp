@@ -0,0 +1,153 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "midicache.h"
+#include "measure.h"
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   qHash
+//---------------------------------------------------------
+
+uint qHash(const MidiCache::Key& k)
+      {
+      return ::qHash(k.measure) ^ (uint(k.staffIdx) << 24) ^ uint(k.tickOffset);
+      }
+
+//---------------------------------------------------------
+//   MidiCache
+//---------------------------------------------------------
+
+MidiCache::MidiCache()
+      {
+      _valid      = false;
+      _stick      = -1;
+      _etick      = -1;
+      _generation = 0;
+      _hits       = 0;
+      _misses     = 0;
+      _reused     = 0;
+      _rendered   = 0;
+      }
+
+//---------------------------------------------------------
+//   clear
+//---------------------------------------------------------
+
+void MidiCache::clear()
+      {
+      _fragments.clear();
+      _valid = false;
+      _stick = -1;
+      _etick = -1;
+      }
+
+//---------------------------------------------------------
+//   invalidate
+//    merge [stick, etick) into the invalid range
+//---------------------------------------------------------
+
+void MidiCache::invalidate(int stick, int etick)
+      {
+      if (_stick == -1 || stick < _stick)
+            _stick = stick;
+      if (_etick == -1 || etick > _etick)
+            _etick = etick;
+      }
+
+//---------------------------------------------------------
+//   dirtyRange
+//    return false if no measure is invalid
+//---------------------------------------------------------
+
+bool MidiCache::dirtyRange(int* stick, int* etick) const
+      {
+      if (_stick == -1)
+            return false;
+      *stick = _stick;
+      *etick = _etick;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   setDirtyRange
+//---------------------------------------------------------
+
+void MidiCache::setDirtyRange(int stick, int etick)
+      {
+      _stick = stick;
+      _etick = etick;
+      }
+
+//---------------------------------------------------------
+//   events
+//    return the events of a valid fragment or 0
+//---------------------------------------------------------
+
+const EventMap* MidiCache::events(const Measure* m, int staffIdx, int tickOffset)
+      {
+      if (!_valid)
+            return 0;
+      auto i = _fragments.find(Key { m, staffIdx, tickOffset });
+      if (i == _fragments.end())
+            return 0;
+      Fragment& f = i.value();
+      int tick = m->tick();
+      if (f.tick != tick || (_stick != -1 && tick < _etick && m->endTick() > _stick))
+            return 0;
+      f.generation = _generation;
+      ++_hits;
+      return &f.events;
+      }
+
+//---------------------------------------------------------
+//   insert
+//---------------------------------------------------------
+
+const EventMap* MidiCache::insert(const Measure* m, int staffIdx, int tickOffset, const EventMap& events)
+      {
+      Fragment& f  = _fragments[Key { m, staffIdx, tickOffset }];
+      f.tick       = m->tick();
+      f.generation = _generation;
+      f.events     = events;
+      ++_misses;
+      return &f.events;
+      }
+
+//---------------------------------------------------------
+//   update
+//    called after rendering; drops the fragments which
+//    were not played, e.g. of removed measures, and
+//    records how many fragments were reused
+//---------------------------------------------------------
+
+void MidiCache::update()
+      {
+      for (auto i = _fragments.begin(); i != _fragments.end();) {
+            if (i.value().generation != _generation)
+                  i = _fragments.erase(i);
+            else
+                  ++i;
+            }
+      ++_generation;
+      _reused   = _hits;
+      _rendered = _misses;
+      _hits     = 0;
+      _misses   = 0;
+      _valid = true;
+      _stick = -1;
+      _etick = -1;
+      }
+
+}
+
@@ -0,0 +1,80 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __MIDICACHE_H__
+#define __MIDICACHE_H__
+
+#include "synthesizer/event.h"
+
+namespace Ms {
+
+class Measure;
+
+//---------------------------------------------------------
+//   MidiCache
+//    Events rendered by Score::renderMidi() for one staff
+//    of one measure at one tick offset (a repeated measure
+//    is played at several offsets).
+//
+//    Commands which only touch some measures invalidate
+//    the tick range of these measures, all other commands
+//    clear the cache. A cleared cache also tells
+//    renderMidi() to update the per staff velocity,
+//    channel and swing lists.
+//---------------------------------------------------------
+
+class MidiCache {
+      struct Key {
+            const Measure* measure;
+            int staffIdx;
+            int tickOffset;
+            bool operator==(const Key& k) const {
+                  return measure == k.measure && staffIdx == k.staffIdx && tickOffset == k.tickOffset;
+                  }
+            };
+      struct Fragment {
+            int tick;               ///< measure tick when rendered
+            int generation;         ///< last render which used the fragment
+            EventMap events;
+            };
+      friend uint qHash(const Key&);
+
+      QHash<Key, Fragment> _fragments;
+      bool _valid;
+      int _stick;             ///< invalid range, -1 if none
+      int _etick;
+      int _generation;
+      int _hits;              ///< fragments reused by the current render
+      int _misses;            ///< fragments rendered by the current render
+      int _reused;            ///< fragments reused by the last render
+      int _rendered;          ///< fragments rendered by the last render
+
+   public:
+      MidiCache();
+
+      void clear();
+      void invalidate(int stick, int etick);
+      bool valid() const        { return _valid; }
+      bool dirtyRange(int* stick, int* etick) const;
+      void setDirtyRange(int stick, int etick);
+
+      const EventMap* events(const Measure*, int staffIdx, int tickOffset);
+      const EventMap* insert(const Measure*, int staffIdx, int tickOffset, const EventMap&);
+      void update();
+      int size() const          { return _fragments.size(); }
+      int reused() const        { return _reused;   }
+      int rendered() const      { return _rendered; }
+      };
+
+}     // namespace Ms
+#endif
+
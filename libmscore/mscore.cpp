@@ -89,6 +89,8 @@ int     MScore::defaultPlayDuration;
 // QString MScore::partStyle;
 QString MScore::lastError;
 bool    MScore::layoutDebug = false;
+bool    MScore::incrementalLayout = true;
+bool    MScore::parallelLayout = true;
 int     MScore::division    = 480; // 3840;   // pulses per quarter note (PPQ) // ticks per beat
 int     MScore::sampleRate  = 44100;
 int     MScore::mtcType;
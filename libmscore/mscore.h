@@ -392,6 +392,8 @@ class MScore : public QObject {
       static int defaultPlayDuration;
       static QString lastError;
       static bool layoutDebug;
+      static bool incrementalLayout;      ///< only re-layout measures touched by the last command
+      static bool parallelLayout;         ///< lay out parts on the global thread pool
 
       static int division;
       static int sampleRate;
@@ -841,7 +841,7 @@ void Note::read(XmlReader& e)
             _tpc[0] = e.intAttribute("tpc");
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "pitch")
                   _pitch = e.readInt();
             else if (tag == "tpc") {
@@ -1036,7 +1036,7 @@ void Note::read(XmlReader& e)
             else if (tag == "Events") {
                   _playEvents.clear();    // remove default event
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "Event") {
                               NoteEvent ne;
                               ne.read(e);
@@ -22,7 +22,7 @@ namespace Ms {
 void NoteEvent::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "pitch")
                   _pitch = e.readInt();
             else if (tag == "ontime")
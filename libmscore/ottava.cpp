@@ -255,7 +255,7 @@ void Ottava::read(XmlReader& e)
       spannerSegments().clear();
       e.addSpanner(e.intAttribute("id", -1), this);
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype") {
                   QString s = e.readElementText();
                   bool ok;
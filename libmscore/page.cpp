@@ -167,6 +167,22 @@ QList<Element*> Page::items(const QPointF& p)
 #endif
       }
 
+//---------------------------------------------------------
+//   updateBspTree
+//    bounding box of e has changed; update the index
+//    in place instead of rebuilding it
+//---------------------------------------------------------
+
+void Page::updateBspTree(Element* e)
+      {
+#ifdef USE_BSP
+      if (bspTreeValid)
+            bspTree.update(e);
+#else
+      Q_UNUSED(e)
+#endif
+      }
+
 //---------------------------------------------------------
 //   appendSystem
 //---------------------------------------------------------
@@ -368,7 +384,7 @@ void PageFormat::read(XmlReader& e, Score* score)
       QString type;
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "pageFormat")            // obsolete
                   setSize(getPaperSize(e.readElementText()));
             else if (tag == "landscape")        // obsolete
@@ -377,7 +393,7 @@ void PageFormat::read(XmlReader& e, Score* score)
                   type = e.attribute("type","both");
                   qreal lm = 0.0, rm = 0.0, tm = 0.0, bm = 0.0;
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         qreal val = e.readDouble() * 0.5 / PPI;
                         if (tag == "left-margin")
                               lm = val;
@@ -164,7 +164,9 @@ class Page : public Element {
 
       QList<Element*> items(const QRectF& r);
       QList<Element*> items(const QPointF& p);
+      template <typename F> void visitItems(const QRectF& r, F f);
       void rebuildBspTree()   { bspTreeValid = false; }
+      void updateBspTree(Element*);
       QPointF pagePos() const { return QPointF(); }     ///< position in page coordinates
       QList<System*> searchSystem(const QPointF& pos) const;
       Measure* searchMeasure(const QPointF& p) const;
@@ -174,6 +176,25 @@ class Page : public Element {
       QRectF tbbox();                           // tight bounding box, excluding white space
       };
 
+//---------------------------------------------------------
+//   visitItems
+//    call f(Element*) for all elements intersecting r
+//    without building a list
+//---------------------------------------------------------
+
+template <typename F>
+void Page::visitItems(const QRectF& r, F f)
+      {
+#ifdef USE_BSP
+      if (!bspTreeValid)
+            doRebuildBspTree();
+      bspTree.visit(r, f);
+#else
+      Q_UNUSED(r)
+      Q_UNUSED(f)
+#endif
+      }
+
 extern const PaperSize paperSizes[];
 
 
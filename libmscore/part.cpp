@@ -63,7 +63,7 @@ Staff* Part::staff(int idx) const
 void Part::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "Staff") {
                   Staff* staff = new Staff(_score);
                   staff->setPart(this);
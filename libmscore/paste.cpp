@@ -129,7 +129,7 @@ bool Score::pasteStaff(XmlReader& e, Segment* dst, int dstStaff)
                   bool makeGap  = true;
                   while (e.readNextStartElement()) {
                         pasted = true;
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
 
                         if (tag == "transposeChromatic")
                               e.setTransposeChromatic(e.readInt());
@@ -592,7 +592,7 @@ void Score::pasteSymbols(XmlReader& e, ChordRest* dst)
             while (e.readNextStartElement()) {
                   if (done)
                         break;
-                  const QStringRef& tag(e.name());
+                  const XmlTag& tag(e.name());
 
                   if (tag == "trackOffset") {
                         destTrack = startTrack + e.readInt();
@@ -134,7 +134,7 @@ void Pedal::read(XmlReader& e)
       int id = e.intAttribute("id", -1);
       e.addSpanner(id, this);
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype")          // obsolete
                   e.skipCurrentElement();
             else if (tag == "lineWidth") {
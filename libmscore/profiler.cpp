@@ -0,0 +1,132 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "profiler.h"
+#include "mscore.h"
+
+namespace Ms {
+
+bool Profiler::_enabled = false;
+QMutex Profiler::mutex;
+QMap<QString, ProfileEntry> Profiler::entries;
+
+//---------------------------------------------------------
+//   addTime
+//---------------------------------------------------------
+
+void Profiler::addTime(const QString& name, qint64 nsecs)
+      {
+      QMutexLocker locker(&mutex);
+      ProfileEntry& e = entries[name];
+      e.nsecs += nsecs;
+      ++e.calls;
+      }
+
+//---------------------------------------------------------
+//   addCount
+//---------------------------------------------------------
+
+void Profiler::addCount(const QString& name, qint64 n)
+      {
+      if (!_enabled)
+            return;
+      QMutexLocker locker(&mutex);
+      entries[name].count += n;
+      }
+
+//---------------------------------------------------------
+//   reset
+//---------------------------------------------------------
+
+void Profiler::reset()
+      {
+      QMutexLocker locker(&mutex);
+      entries.clear();
+      }
+
+//---------------------------------------------------------
+//   snapshot
+//---------------------------------------------------------
+
+QMap<QString, ProfileEntry> Profiler::snapshot()
+      {
+      QMutexLocker locker(&mutex);
+      return entries;
+      }
+
+//---------------------------------------------------------
+//   toJson
+//---------------------------------------------------------
+
+QJsonObject Profiler::toJson()
+      {
+      QJsonObject o;
+      QMap<QString, ProfileEntry> el = snapshot();
+      for (auto i = el.constBegin(); i != el.constEnd(); ++i) {
+            QJsonObject e;
+            e["ms"]    = double(i.value().nsecs) / 1000000.0;
+            e["calls"] = double(i.value().calls);
+            if (i.value().count)
+                  e["count"] = double(i.value().count);
+            o[i.key()] = e;
+            }
+      return o;
+      }
+
+//---------------------------------------------------------
+//   writeJson
+//    write all entries as "profile" object; the members
+//    of info (score name, output file...) are written
+//    alongside
+//---------------------------------------------------------
+
+bool Profiler::writeJson(const QString& path, const QJsonObject& info)
+      {
+      QJsonObject o(info);
+      o["profile"] = toJson();
+      QFile f(path);
+      if (!f.open(QIODevice::WriteOnly)) {
+            qDebug("Profiler: cannot write <%s>", qPrintable(path));
+            return false;
+            }
+      f.write(QJsonDocument(o).toJson());
+      return f.error() == QFile::NoError;
+      }
+
+//---------------------------------------------------------
+//   ProfilePhases
+//---------------------------------------------------------
+
+ProfilePhases::ProfilePhases(const char* p)
+   : prefix(p)
+      {
+      if (Profiler::enabled() || MScore::debugMode)
+            timer.start();
+      }
+
+//---------------------------------------------------------
+//   elapsed
+//---------------------------------------------------------
+
+void ProfilePhases::elapsed(const char* phase)
+      {
+      if (!timer.isValid())
+            return;
+      qint64 ns = timer.nsecsElapsed();
+      if (Profiler::enabled())
+            Profiler::addTime(QString("%1/%2").arg(prefix).arg(phase), ns);
+      if (MScore::debugMode)
+            qDebug("%s %-10s %8lld us", prefix, phase, ns / 1000);
+      timer.restart();
+      }
+
+}
@@ -0,0 +1,89 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   ProfileEntry
+//---------------------------------------------------------
+
+struct ProfileEntry {
+      qint64 nsecs { 0 };     // accumulated time
+      qint64 calls { 0 };     // number of timed sections
+      qint64 count { 0 };     // user defined counter (measures, segments...)
+      };
+
+//---------------------------------------------------------
+//   Profiler
+//    collects named timers and counters of hot paths;
+//    disabled by default, recording is then a single
+//    test of a static flag
+//---------------------------------------------------------
+
+class Profiler {
+      static bool _enabled;
+      static QMutex mutex;
+      static QMap<QString, ProfileEntry> entries;
+
+   public:
+      static bool enabled()                  { return _enabled; }
+      static void setEnabled(bool val)       { _enabled = val;  }
+      static void addTime(const QString& name, qint64 nsecs);
+      static void addCount(const QString& name, qint64 n = 1);
+      static void reset();
+      static QMap<QString, ProfileEntry> snapshot();
+      static QJsonObject toJson();
+      static bool writeJson(const QString& path, const QJsonObject& info = QJsonObject());
+      };
+
+//---------------------------------------------------------
+//   ProfileScope
+//    adds the time between construction and destruction
+//    to a named entry
+//---------------------------------------------------------
+
+class ProfileScope {
+      const char* name;
+      QElapsedTimer timer;
+
+   public:
+      ProfileScope(const char* n) : name(n) {
+            if (Profiler::enabled())
+                  timer.start();
+            }
+      ~ProfileScope() {
+            if (timer.isValid())
+                  Profiler::addTime(name, timer.nsecsElapsed());
+            }
+      };
+
+//---------------------------------------------------------
+//   ProfilePhases
+//    splits a function into consecutive phases; elapsed()
+//    closes the current phase and starts the next one.
+//    In debug mode the phase times are also logged.
+//---------------------------------------------------------
+
+class ProfilePhases {
+      const char* prefix;
+      QElapsedTimer timer;
+
+   public:
+      ProfilePhases(const char* p);
+      void elapsed(const char* phase);
+      };
+
+}     // namespace Ms
+#endif
@@ -168,7 +168,7 @@ static const StyleVal2 style114[] = {
 void Staff::read114(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "lines") {
                   int lines = e.readInt();
                   setLines(lines);
@@ -222,7 +222,7 @@ void Staff::read114(XmlReader& e)
 void Part::read114(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "Staff") {
                   Staff* staff = new Staff(_score);
                   staff->setPart(this);
@@ -358,7 +358,7 @@ Score::FileError Score::read114(XmlReader& e)
       TempoMap tm;
       while (e.readNextStartElement()) {
             e.setTrack(-1);
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "Staff")
                   readStaff(e);
             else if (tag == "KeySig") {               // not supported
@@ -38,6 +38,7 @@
 #include "repeatlist.h"
 #include "velo.h"
 #include "dynamic.h"
+#include "midicache.h"
 #include "navigate.h"
 #include "pedal.h"
 #include "staff.h"
@@ -49,6 +50,7 @@
 #include "segment.h"
 #include "undo.h"
 #include "utils.h"
+#include "profiler.h"
 
 namespace Ms {
 
@@ -124,24 +126,37 @@ void Score::updateChannel()
                   }
             }
 
-      for (Segment* s = fm->first(Segment::Type::ChordRest); s; s = s->next1(Segment::Type::ChordRest)) {
-            foreach(Staff* st, _staves) {
-                  int strack = st->idx() * VOICES;
-                  int etrack = strack + VOICES;
-                  for (int track = strack; track < etrack; ++track) {
-                        if (!s->element(track))
-                              continue;
-                        Element* e = s->element(track);
-                        if (e->type() != Element::Type::CHORD)
-                              continue;
-                        Chord* c = static_cast<Chord*>(e);
-                        int channel = st->channel(c->tick(), c->voice());
-                        foreach (Note* note, c->notes()) {
-                              if (note->hidden())
+      updateSubchannels(fm, 0);
+      }
+
+//---------------------------------------------------------
+//   updateSubchannels
+//    set the channel of the notes in measures sm up to,
+//    but not including em from the channel lists
+//---------------------------------------------------------
+
+void Score::updateSubchannels(Measure* sm, Measure* em)
+      {
+      for (Measure* m = sm; m && m != em; m = m->nextMeasure()) {
+            for (Segment* s = m->first(Segment::Type::ChordRest); s; s = s->next(Segment::Type::ChordRest)) {
+                  foreach(Staff* st, _staves) {
+                        int strack = st->idx() * VOICES;
+                        int etrack = strack + VOICES;
+                        for (int track = strack; track < etrack; ++track) {
+                              if (!s->element(track))
                                     continue;
-                              if (note->tieBack())
+                              Element* e = s->element(track);
+                              if (e->type() != Element::Type::CHORD)
                                     continue;
-                              note->setSubchannel(channel);
+                              Chord* c = static_cast<Chord*>(e);
+                              int channel = st->channel(c->tick(), c->voice());
+                              foreach (Note* note, c->notes()) {
+                                    if (note->hidden())
+                                          continue;
+                                    if (note->tieBack())
+                                          continue;
+                                    note->setSubchannel(channel);
+                                    }
                               }
                         }
                   }
@@ -426,8 +441,10 @@ void Score::updateRepeatList(bool expandRepeats)
                   delete s;
             repeatList()->clear();
             Measure* m = lastMeasure();
-            if (m == 0)
+            if (m == 0) {
+                  repeatList()->update();
                   return;
+                  }
             RepeatSegment* s = new RepeatSegment;
             s->tick  = 0;
             s->len   = m->tick() + m->ticks();
@@ -435,6 +452,7 @@ void Score::updateRepeatList(bool expandRepeats)
             s->utime = 0.0;
             s->timeOffset = 0.0;
             repeatList()->append(s);
+            repeatList()->update();
             }
       else
             repeatList()->unwind();
@@ -597,6 +615,23 @@ void Score::updateVelo()
             }
       }
 
+//---------------------------------------------------------
+//   renderMeasure
+//    add the events of staff in measure m to events;
+//    reuse the cached events if m was not changed
+//---------------------------------------------------------
+
+void Score::renderMeasure(EventMap* events, Measure* m, Staff* staff, int tickOffset)
+      {
+      const EventMap* el = _midiCache->events(m, staff->idx(), tickOffset);
+      if (!el) {
+            EventMap fragment;
+            collectMeasureEvents(&fragment, m, staff, tickOffset);
+            el = _midiCache->insert(m, staff->idx(), tickOffset, fragment);
+            }
+      events->insert(el->begin(), el->end());
+      }
+
 //---------------------------------------------------------
 //   renderStaff
 //---------------------------------------------------------
@@ -611,11 +646,11 @@ void Score::renderStaff(EventMap* events, Staff* staff)
             for (Measure* m = tick2measure(startTick); m; m = m->nextMeasure()) {
                   if (lastMeasure && m->isRepeatMeasure(staff->part())) {
                         int offset = m->tick() - lastMeasure->tick();
-                        collectMeasureEvents(events, lastMeasure, staff, tickOffset + offset);
+                        renderMeasure(events, lastMeasure, staff, tickOffset + offset);
                         }
                   else {
                         lastMeasure = m;
-                        collectMeasureEvents(events, lastMeasure, staff, tickOffset);
+                        renderMeasure(events, lastMeasure, staff, tickOffset);
                         }
                   if (m->tick() + m->ticks() >= endTick)
                         break;
@@ -1349,10 +1384,20 @@ void Score::createPlayEvents(Chord* chord)
       }
 
 void Score::createPlayEvents()
+      {
+      createPlayEvents(firstMeasure(), 0);
+      }
+
+//---------------------------------------------------------
+//   createPlayEvents
+//    for the measures sm up to, but not including em
+//---------------------------------------------------------
+
+void Score::createPlayEvents(Measure* sm, Measure* em)
       {
       int etrack = nstaves() * VOICES;
       for (int track = 0; track < etrack; ++track) {
-            for (Measure* m = firstMeasure(); m; m = m->nextMeasure()) {
+            for (Measure* m = sm; m && m != em; m = m->nextMeasure()) {
                   // skip linked staves, except primary
                   if (!m->score()->staff(track / VOICES)->primaryStaff())
                         continue;
@@ -1367,6 +1412,65 @@ void Score::createPlayEvents()
             }
       }
 
+//---------------------------------------------------------
+//   extendPlaybackRange
+//    the events of a note depend on the notes tied to it;
+//    extend [sm, em] to the measures of all tie chains
+//    crossing its boundaries
+//---------------------------------------------------------
+
+static void extendPlaybackRange(Measure** sm, Measure** em)
+      {
+      if ((*sm)->prevMeasure())
+            *sm = (*sm)->prevMeasure();
+      if ((*em)->nextMeasure())
+            *em = (*em)->nextMeasure();
+
+      Score* score = (*sm)->score();
+      int ntracks  = score->nstaves() * VOICES;
+      const Segment::Type st = Segment::Type::ChordRest;
+      for (bool changed = true; changed;) {
+            changed = false;
+            for (Segment* s = (*sm)->first(st); s && !changed; s = s->next(st)) {
+                  for (int track = 0; track < ntracks && !changed; ++track) {
+                        Element* e = s->element(track);
+                        if (!e || e->type() != Element::Type::CHORD)
+                              continue;
+                        for (Note* n : static_cast<Chord*>(e)->notes()) {
+                              if (n->tieBack() && n->tieBack()->startNote()) {
+                                    Measure* m = n->tieBack()->startNote()->chord()->measure();
+                                    if (m->tick() < (*sm)->tick()) {
+                                          *sm     = m;
+                                          changed = true;
+                                          break;
+                                          }
+                                    }
+                              }
+                        }
+                  }
+            }
+      for (bool changed = true; changed;) {
+            changed = false;
+            for (Segment* s = (*em)->first(st); s && !changed; s = s->next(st)) {
+                  for (int track = 0; track < ntracks && !changed; ++track) {
+                        Element* e = s->element(track);
+                        if (!e || e->type() != Element::Type::CHORD)
+                              continue;
+                        for (Note* n : static_cast<Chord*>(e)->notes()) {
+                              if (n->tieFor() && n->tieFor()->endNote()) {
+                                    Measure* m = n->tieFor()->endNote()->chord()->measure();
+                                    if (m->tick() > (*em)->tick()) {
+                                          *em     = m;
+                                          changed = true;
+                                          break;
+                                          }
+                                    }
+                              }
+                        }
+                  }
+            }
+      }
+
 //---------------------------------------------------------
 //   renderMidi
 //    export score to event list
@@ -1374,22 +1478,55 @@ void Score::createPlayEvents()
 
 void Score::renderMidi(EventMap* events)
       {
-      updateSwing();
-      createPlayEvents();
+      ProfileScope profile("renderMidi");
+      int stick;
+      int etick;
+      Measure* sm = 0;
+      Measure* em = 0;
+      if (_midiCache->valid() && _midiCache->dirtyRange(&stick, &etick)) {
+            sm = tick2measure(stick);
+            em = tick2measure(etick - 1);
+            if (sm && em)
+                  extendPlaybackRange(&sm, &em);
+            else
+                  _midiCache->clear();
+            }
+      bool full = !_midiCache->valid();
+      if (full) {
+            updateSwing();
+            createPlayEvents();
+            }
+      else if (sm) {
+            // only the last commands changed notes in these
+            // measures; velocity, channel and swing lists
+            // are unchanged
+            _midiCache->setDirtyRange(sm->tick(), em->endTick());
+            createPlayEvents(sm, em->nextMeasure());
+            }
 
       updateRepeatList(MScore::playRepeats);
       _foundPlayPosAfterRepeats = false;
-      updateChannel();
-      updateVelo();
+      if (full) {
+            updateChannel();
+            updateVelo();
+            }
+      else if (sm)
+            updateSubchannels(sm, em->nextMeasure());
+
+      // render every staff into its own list and merge
+      // the sorted lists at the end
+      int nstaffs = _staves.size();
+      std::vector<EventMap> lists(nstaffs + 2);
 
       // create note & other events
-      foreach (Staff* part, _staves)
-            renderStaff(events, part);
+      for (int i = 0; i < nstaffs; ++i)
+            renderStaff(&lists[i], _staves[i]);
 
       // create sustain pedal events
-      renderSpanners(events, -1);
+      renderSpanners(&lists[nstaffs], -1);
 
       // add metronome ticks
+      EventMap* ticks = &lists[nstaffs + 1];
       foreach (const RepeatSegment* rs, *repeatList()) {
             int startTick  = rs->tick;
             int endTick    = startTick + rs->len;
@@ -1406,12 +1543,41 @@ void Score::renderMidi(EventMap* events)
                         int tick = m->tick() + i * tw + tickOffset;
                         NPlayEvent event;
                         event.setType(i == 0 ? ME_TICK1 : ME_TICK2);
-                        events->insert(std::pair<int,NPlayEvent>(tick, event));
+                        ticks->insert(std::pair<int,NPlayEvent>(tick, event));
                         }
                   if (m->tick() + m->ticks() >= endTick)
                         break;
                   }
             }
+
+      std::vector<const EventMap*> sources;
+      for (const EventMap& l : lists)
+            sources.push_back(&l);
+      events->merge(sources);
+
+      _midiCache->update();
+      if (Profiler::enabled())
+            Profiler::addCount(full ? "renderMidi/full" : "renderMidi/incremental");
+      }
+
+//---------------------------------------------------------
+//   invalidateMidiCache
+//    called at the end of a command or after undo/redo
+//---------------------------------------------------------
+
+void Score::invalidateMidiCache(const UndoCommand* cmd)
+      {
+      if (!cmd || cmd->childCount() == 0)
+            return;
+      int stick = -1;
+      int etick = -1;
+      bool ranged = cmd->playbackRange(&stick, &etick);
+      for (Score* s : scoreList()) {
+            if (!ranged)
+                  s->_midiCache->clear();
+            else if (stick != -1)
+                  s->_midiCache->invalidate(stick, etick);
+            }
       }
 }
 
@@ -101,125 +101,229 @@ RepeatSegment::RepeatSegment()
       }
 
 //---------------------------------------------------------
-//   RepeatList
+//   TimeMap
 //---------------------------------------------------------
 
-RepeatList::RepeatList(Score* s)
+TimeMap::TimeMap(const RepeatList* rl, const TempoMap* tl)
       {
-      _score = s;
-      idx1  = 0;
-      idx2  = 0;
+      int n = rl->size();
+      _utick.reserve(n);
+      _tick.reserve(n);
+      _utime.reserve(n);
+      _timeOffset.reserve(n);
+      std::vector<int> ends;
+      for (const RepeatSegment* s : *rl) {
+            _utick.push_back(s->utick);
+            _tick.push_back(s->tick);
+            _utime.push_back(s->utime);
+            _timeOffset.push_back(s->timeOffset);
+            _ivTick.push_back(s->tick);
+            ends.push_back(s->tick + s->len);
+            }
+      _ivTick.insert(_ivTick.end(), ends.begin(), ends.end());
+      std::sort(_ivTick.begin(), _ivTick.end());
+      _ivTick.erase(std::unique(_ivTick.begin(), _ivTick.end()), _ivTick.end());
+
+      // repeated measures are played by several segments,
+      // tick2utick() maps to the first of them
+      int nv = int(_ivTick.size()) - 1;
+      _ivSegment.assign(qMax(nv, 0), -1);
+      for (int i = 0; i < nv; ++i) {
+            for (int k = 0; k < n; ++k) {
+                  if (_tick[k] <= _ivTick[i] && _ivTick[i + 1] <= ends[k]) {
+                        _ivSegment[i] = k;
+                        break;
+                        }
+                  }
+            }
+
+      qreal f = tl->relTempo() * MScore::division;
+      int nt  = tl->size();
+      _tempoTick.reserve(nt);
+      _tempoTime.reserve(nt);
+      _tempoPause.reserve(nt);
+      _ticksPerSec.reserve(nt);
+      for (const auto& e : *tl) {
+            _tempoTick.push_back(e.first);
+            _tempoTime.push_back(e.second.time);
+            _tempoPause.push_back(e.second.pause);
+            _ticksPerSec.push_back(e.second.tempo * f);
+            }
+      _defaultTicksPerSec = 2.0 * f;
+      _relTempo = tl->relTempo();
+      _tempoSN  = tl->tempoSN();
       }
 
 //---------------------------------------------------------
-//   ticks
+//   tick2time
+//    same as TempoMap::tick2time()
 //---------------------------------------------------------
 
-int RepeatList::ticks()
+qreal TimeMap::tick2time(int tick) const
       {
-      if (length() > 0) {
-            RepeatSegment* s = last();
-            return s->utick + s->len;
-            }
-      return 0;
+      int i = int(std::upper_bound(_tempoTick.begin(), _tempoTick.end(), tick) - _tempoTick.begin()) - 1;
+      if (i < 0)
+            return tick / _defaultTicksPerSec;
+      return _tempoTime[i] + (tick - _tempoTick[i]) / _ticksPerSec[i];
       }
 
 //---------------------------------------------------------
-//   update
+//   time2tick
+//    same as TempoMap::time2tick(); a time within the
+//    pause before a tempo event maps to the tick of
+//    that event
 //---------------------------------------------------------
 
-void RepeatList::update()
+int TimeMap::time2tick(qreal time) const
       {
-      const TempoMap* tl = _score->tempomap();
-
-      int utick = 0;
-      qreal t  = 0;
-
-      for(RepeatSegment* s : *this) {
-            s->utick      = utick;
-            s->utime      = t;
-            qreal ct      = tl->tick2time(s->tick);
-            s->timeOffset = t - ct;
-            utick        += s->len;
-            t            += tl->tick2time(s->tick + s->len) - ct;
+      int i = int(std::lower_bound(_tempoTime.begin(), _tempoTime.end(), time) - _tempoTime.begin());
+      int tick      = 0;
+      qreal ptime   = 0.0;
+      qreal tps     = _defaultTicksPerSec;
+      if (i > 0) {
+            tick  = _tempoTick[i - 1];
+            ptime = _tempoTime[i - 1];
+            tps   = _ticksPerSec[i - 1];
             }
+      if (i < int(_tempoTime.size()) && time > _tempoTime[i] - _tempoPause[i])
+            time = _tempoTime[i] - _tempoPause[i];
+      return tick + lrint((time - ptime) * tps);
       }
 
 //---------------------------------------------------------
 //   utick2tick
 //---------------------------------------------------------
 
-int RepeatList::utick2tick(int tick) const
+int TimeMap::utick2tick(int tick) const
       {
-      unsigned n = size();
-      if (n == 0)
+      if (_utick.empty())
             return tick;
       if (tick < 0)
             return 0;
-      unsigned ii = (idx1 < n) && (tick >= at(idx1)->utick) ? idx1 : 0;
-      for (unsigned i = ii; i < n; ++i) {
-            if ((tick >= at(i)->utick) && ((i + 1 == n) || (tick < at(i+1)->utick))) {
-                  idx1 = i;
-                  return tick - (at(i)->utick - at(i)->tick);
-                  }
-            }
-      if (MScore::debugMode) {
-            qFatal("tick %d not found in RepeatList", tick);
+      int i = int(std::upper_bound(_utick.begin(), _utick.end(), tick) - _utick.begin()) - 1;
+      if (i < 0) {
+            if (MScore::debugMode)
+                  qFatal("tick %d not found in RepeatList", tick);
+            return 0;
             }
-      return 0;
+      return tick - (_utick[i] - _tick[i]);
       }
 
 //---------------------------------------------------------
 //   tick2utick
 //---------------------------------------------------------
 
-int RepeatList::tick2utick(int tick) const
+int TimeMap::tick2utick(int tick) const
       {
-      for (const RepeatSegment* s : *this) {
-            if (tick >= s->tick && tick < (s->tick + s->len))
-                  return s->utick + (tick - s->tick);
+      if (_utick.empty())
+            return tick;
+      int i = int(std::upper_bound(_ivTick.begin(), _ivTick.end(), tick) - _ivTick.begin()) - 1;
+      if (i >= 0 && i < int(_ivSegment.size()) && _ivSegment[i] != -1) {
+            int k = _ivSegment[i];
+            return _utick[k] + (tick - _tick[k]);
             }
-      return last()->utick + (tick - last()->tick);
+      return _utick.back() + (tick - _tick.back());
       }
 
 //---------------------------------------------------------
 //   utick2utime
 //---------------------------------------------------------
 
-qreal RepeatList::utick2utime(int tick) const
+qreal TimeMap::utick2utime(int tick) const
       {
-      unsigned n = size();
-      unsigned ii = (idx1 < n) && (tick >= at(idx1)->utick) ? idx1 : 0;
-      for (unsigned i = ii; i < n; ++i) {
-            if ((tick >= at(i)->utick) && ((i + 1 == n) || (tick < at(i+1)->utick))) {
-                  int t     = tick - (at(i)->utick - at(i)->tick);
-                  qreal tt = _score->tempomap()->tick2time(t) + at(i)->timeOffset;
-                  return tt;
-                  }
-            }
-      return 0.0;
+      int i = int(std::upper_bound(_utick.begin(), _utick.end(), tick) - _utick.begin()) - 1;
+      if (i < 0)
+            return 0.0;
+      return tick2time(tick - (_utick[i] - _tick[i])) + _timeOffset[i];
       }
 
 //---------------------------------------------------------
 //   utime2utick
 //---------------------------------------------------------
 
-int RepeatList::utime2utick(qreal t) const
+int TimeMap::utime2utick(qreal t) const
       {
-      unsigned n = size();
-      unsigned ii = (idx2 < n) && (t >= at(idx2)->utime) ? idx2 : 0;
-      for (unsigned i = ii; i < n; ++i) {
-            if ((t >= at(i)->utime) && ((i + 1 == n) || (t < at(i+1)->utime))) {
-                  idx2 = i;
-                  return _score->tempomap()->time2tick(t - at(i)->timeOffset) + (at(i)->utick - at(i)->tick);
-                  }
+      int i = int(std::upper_bound(_utime.begin(), _utime.end(), t) - _utime.begin()) - 1;
+      if (i < 0) {
+            if (MScore::debugMode && !_utime.empty())
+                  qFatal("time %f not found in RepeatList", t);
+            return 0;
             }
-      if (MScore::debugMode) {
-            qFatal("time %f not found in RepeatList", t);
+      return time2tick(t - _timeOffset[i]) + (_utick[i] - _tick[i]);
+      }
+
+//---------------------------------------------------------
+//   RepeatList
+//---------------------------------------------------------
+
+RepeatList::RepeatList(Score* s)
+      {
+      _score = s;
+      }
+
+//---------------------------------------------------------
+//   ticks
+//---------------------------------------------------------
+
+int RepeatList::ticks()
+      {
+      if (length() > 0) {
+            RepeatSegment* s = last();
+            return s->utick + s->len;
             }
       return 0;
       }
 
+//---------------------------------------------------------
+//   update
+//    recompute the segment times and publish a new
+//    TimeMap; must be called in the gui thread after the
+//    list or the tempo map was changed
+//---------------------------------------------------------
+
+void RepeatList::update()
+      {
+      const TempoMap* tl = _score->tempomap();
+
+      int utick = 0;
+      qreal t  = 0;
+
+      for(RepeatSegment* s : *this) {
+            s->utick      = utick;
+            s->utime      = t;
+            qreal ct      = tl->tick2time(s->tick);
+            s->timeOffset = t - ct;
+            utick        += s->len;
+            t            += tl->tick2time(s->tick + s->len) - ct;
+            }
+      std::atomic_store(&_timeMap, std::shared_ptr<const TimeMap>(new TimeMap(this, tl)));
+      }
+
+//---------------------------------------------------------
+//   updateTempo
+//    update() if the tempo map has changed since the
+//    last update(); gui thread only
+//---------------------------------------------------------
+
+void RepeatList::updateTempo()
+      {
+      std::shared_ptr<const TimeMap> tm = std::atomic_load(&_timeMap);
+      if (!tm || tm->tempoSN() != _score->tempomap()->tempoSN())
+            update();
+      }
+
+//---------------------------------------------------------
+//   timeMap
+//    the map published by the last update(); safe to call
+//    from any thread, which keeps its snapshot alive by
+//    holding the returned pointer
+//---------------------------------------------------------
+
+std::shared_ptr<const TimeMap> RepeatList::timeMap() const
+      {
+      return std::atomic_load(&_timeMap);
+      }
+
 //---------------------------------------------------------
 //   dump
 //---------------------------------------------------------
@@ -256,8 +360,10 @@ void RepeatList::unwind()
       qDeleteAll(*this);
       clear();
       Measure* fm = _score->firstMeasure();
-      if (!fm)
+      if (!fm) {
+            update();
             return;
+            }
 
 // qDebug("unwind===================");
       QList<Jump*> jumps; // take the jumps only once so store them
@@ -13,10 +13,15 @@
 #ifndef __REPEATLIST_H__
 #define __REPEATLIST_H__
 
+#include <memory>
+#include <vector>
+
 namespace Ms {
 
 class Score;
 class Measure;
+class RepeatList;
+class TempoMap;
 
 //---------------------------------------------------------
 //   RepeatSegment
@@ -33,6 +38,53 @@ class RepeatSegment {
       RepeatSegment();
       };
 
+//---------------------------------------------------------
+//   TimeMap
+//    snapshot of the repeat list and the tempo map for
+//    converting between ticks, unrolled ticks (utick) and
+//    unrolled time (utime) with binary searches.
+//
+//    A TimeMap is never changed after construction, so the
+//    sequencer thread can keep using one while the gui
+//    thread builds its successor.
+//---------------------------------------------------------
+
+class TimeMap {
+      // repeat segments in playback order
+      std::vector<int> _utick;
+      std::vector<int> _tick;
+      std::vector<qreal> _utime;
+      std::vector<qreal> _timeOffset;
+
+      // the tick axis cut at all segment boundaries; interval
+      // [_ivTick[i], _ivTick[i+1]) is first played by
+      // segment _ivSegment[i] (-1 if it is not played)
+      std::vector<int> _ivTick;
+      std::vector<int> _ivSegment;
+
+      // tempo events
+      std::vector<int> _tempoTick;
+      std::vector<qreal> _tempoTime;
+      std::vector<qreal> _tempoPause;
+      std::vector<qreal> _ticksPerSec;    // tempo * relTempo * division
+      qreal _defaultTicksPerSec;          // before the first tempo event
+      qreal _relTempo;
+      int _tempoSN;
+
+      qreal tick2time(int tick) const;
+      int time2tick(qreal time) const;
+
+   public:
+      TimeMap(const RepeatList*, const TempoMap*);
+
+      int tempoSN() const     { return _tempoSN;  }
+      qreal relTempo() const  { return _relTempo; }
+      int utick2tick(int tick) const;
+      int tick2utick(int tick) const;
+      qreal utick2utime(int tick) const;
+      int utime2utick(qreal t) const;
+      };
+
 //---------------------------------------------------------
 //   RepeatList
 //---------------------------------------------------------
@@ -40,7 +92,7 @@ class RepeatSegment {
 class RepeatList: public QList<RepeatSegment*>
       {
       Score* _score;
-      mutable unsigned idx1, idx2;   // cached values
+      std::shared_ptr<const TimeMap> _timeMap;      // replaced by update() in the gui thread
 
       RepeatSegment* rs;            // tmp value during unwind()
 
@@ -49,12 +101,14 @@ class RepeatList: public QList<RepeatSegment*>
    public:
       RepeatList(Score* s);
       void unwind();
-      int utick2tick(int tick) const;
-      int tick2utick(int tick) const;
+      int utick2tick(int tick) const    { return timeMap()->utick2tick(tick);  }
+      int tick2utick(int tick) const    { return timeMap()->tick2utick(tick);  }
       void dump() const;
-      int utime2utick(qreal) const;
-      qreal utick2utime(int) const;
+      int utime2utick(qreal t) const    { return timeMap()->utime2utick(t);    }
+      qreal utick2utime(int tick) const { return timeMap()->utick2utime(tick); }
+      std::shared_ptr<const TimeMap> timeMap() const;
       void update();
+      void updateTempo();
       int ticks();
       };
 
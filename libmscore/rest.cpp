@@ -798,7 +798,7 @@ void Rest::write(Xml& xml) const
 void Rest::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "Symbol") {
                   Symbol* s = new Symbol(score());
                   s->setTrack(track());
@@ -46,7 +46,7 @@ void Revision::read(XmlReader& e)
       {
       _dateTime = QDateTime::currentDateTime();
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "id")
                   _id = e.readElementText();
             else if (tag == "diff")
@@ -55,6 +55,7 @@
 #include "tempotext.h"
 #include "articulation.h"
 #include "revisions.h"
+#include "midicache.h"
 #include "tiemap.h"
 #include "layoutbreak.h"
 #include "harmony.h"
@@ -88,9 +89,9 @@ bool showRubberBand  = true;
 
 MeasureBaseList::MeasureBaseList()
       {
-      _first = 0;
-      _last  = 0;
-      _size  = 0;
+      _first      = 0;
+      _last       = 0;
+      _size       = 0;
       };
 
 //---------------------------------------------------------
@@ -99,6 +100,8 @@ MeasureBaseList::MeasureBaseList()
 
 void MeasureBaseList::push_back(MeasureBase* e)
       {
+      if (e->type() == Element::Type::MEASURE)
+            _index.append(static_cast<Measure*>(e));
       ++_size;
       if (_last) {
             _last->setNext(e);
@@ -119,6 +122,8 @@ void MeasureBaseList::push_back(MeasureBase* e)
 
 void MeasureBaseList::push_front(MeasureBase* e)
       {
+      if (e->type() == Element::Type::MEASURE)
+            _index.prepend(static_cast<Measure*>(e));
       ++_size;
       if (_first) {
             _first->setPrev(e);
@@ -153,6 +158,7 @@ void MeasureBaseList::add(MeasureBase* e)
       e->setPrev(el->prev());
       el->prev()->setNext(e);
       el->setPrev(e);
+      rebuildIndex();
       }
 
 //---------------------------------------------------------
@@ -161,6 +167,8 @@ void MeasureBaseList::add(MeasureBase* e)
 
 void MeasureBaseList::remove(MeasureBase* el)
       {
+      if (el->type() == Element::Type::MEASURE)
+            _index.removeOne(static_cast<Measure*>(el));
       --_size;
       if (el->prev())
             el->prev()->setNext(el->next());
@@ -191,6 +199,7 @@ void MeasureBaseList::insert(MeasureBase* fm, MeasureBase* lm)
             nm->setPrev(lm);
       else
             _last = lm;
+      rebuildIndex();
       }
 
 //---------------------------------------------------------
@@ -212,6 +221,7 @@ void MeasureBaseList::remove(MeasureBase* fm, MeasureBase* lm)
             nm->setPrev(pm);
       else
             _last = pm;
+      rebuildIndex();
       }
 
 //---------------------------------------------------------
@@ -235,6 +245,51 @@ void MeasureBaseList::change(MeasureBase* ob, MeasureBase* nb)
             nb->setSystem(ob->system());
       foreach(Element* e, nb->el())
             e->setParent(nb);
+      rebuildIndex();
+      }
+
+//---------------------------------------------------------
+//   rebuildIndex
+//---------------------------------------------------------
+
+void MeasureBaseList::rebuildIndex()
+      {
+      _index.clear();
+      _index.reserve(_size);
+      for (MeasureBase* mb = _first; mb; mb = mb->next()) {
+            if (mb->type() == Element::Type::MEASURE)
+                  _index.append(static_cast<Measure*>(mb));
+            }
+      }
+
+//---------------------------------------------------------
+//   findMeasure
+//    binary search for the last measure starting at or
+//    before tick; returns 0 if tick is before the first
+//    measure
+//---------------------------------------------------------
+
+Measure* MeasureBaseList::findMeasure(int tick) const
+      {
+      const QVector<Measure*>& ml = measureIndex();
+      auto i = std::upper_bound(ml.begin(), ml.end(), tick,
+         [](int t, const Measure* m) { return t < m->tick(); });
+      if (i == ml.begin())
+            return 0;
+      Measure* m = *(i - 1);
+      // ticks are not in order while the list is being
+      // built or fixed up; fall back to a linear search
+      Measure* nm = (i != ml.end()) ? *i : 0;
+      if (nm && nm->tick() <= m->tick()) {
+            Measure* lm = 0;
+            for (Measure* mm : ml) {
+                  if (tick < mm->tick())
+                        return lm;
+                  lm = mm;
+                  }
+            return lm;
+            }
+      return m;
       }
 
 //---------------------------------------------------------
@@ -283,6 +338,7 @@ void Score::init()
             }
 
       _revisions = new Revisions;
+      _midiCache = new MidiCache;
       _scoreFont = ScoreFont::fontFactory("emmentaler");
 
       _pageNumberOffset = 0;
@@ -338,6 +394,7 @@ Score::Score()
       init();
       _tempomap = new TempoMap;
       _sigmap   = new TimeSigMap();
+      _repeatList->update();
       _style    = *(MScore::defaultStyle());
       accInfo = tr("No selection");
       }
@@ -349,6 +406,7 @@ Score::Score(const MStyle* s)
       init();
       _tempomap = new TempoMap;
       _sigmap   = new TimeSigMap();
+      _repeatList->update();
       _style    = *s;
       accInfo = tr("No selection");
       }
@@ -424,6 +482,7 @@ Score::~Score()
       foreach(Excerpt* e, _excerpts)
             delete e;
       delete _revisions;
+      delete _midiCache;
       delete _undo;           // this also removes _undoStack from Mscore::_undoGroup
       delete _tempomap;
       delete _sigmap;
@@ -574,6 +633,7 @@ void Score::fixTicks()
             }
       if (tempomap()->empty())
             tempomap()->setTempo(0, 2.0);
+      repeatList()->updateTempo();
       }
 
 //---------------------------------------------------------
@@ -891,6 +951,7 @@ void Score::appendPart(Part* p)
 
 void Score::rebuildMidiMapping()
       {
+      _midiCache->clear();          // cached events hold midi channels
       _midiMapping.clear();
       int port        = 0;
       int midiChannel = 0;
@@ -1889,6 +1950,8 @@ void Score::setTempomap(TempoMap* tm)
       {
       delete _tempomap;
       _tempomap = tm;
+      if (_repeatList)
+            _repeatList->update();
       }
 
 //---------------------------------------------------------
@@ -3059,14 +3122,15 @@ void Score::lassoSelect(const QRectF& bbox)
             if (pr.left() > frr.right())
                   break;
 
-            QList<Element*> el = page->items(frr);
-            for (int i = 0; i < el.size(); ++i) {
-                  Element* e = el.at(i);
-                  if (frr.contains(e->abbox())) {
-                        if (e->type() != Element::Type::MEASURE && e->selectable())
-                              select(e, SelectType::ADD, 0);
-                        }
-                  }
+            QList<Element*> el;
+            page->visitItems(frr, [&el, &frr](Element* e) {
+                  if (frr.contains(e->abbox()) && e->type() != Element::Type::MEASURE && e->selectable())
+                        el.append(e);
+                  });
+            // select() may change the layout and so the index,
+            // do not call it while visiting
+            for (Element* e : el)
+                  select(e, SelectType::ADD, 0);
             }
       }
 
@@ -3169,6 +3233,7 @@ void Score::setTempo(Segment* segment, qreal tempo)
 void Score::setTempo(int tick, qreal tempo)
       {
       tempomap()->setTempo(tick, tempo);
+      repeatList()->update();
       _playlistDirty = true;
       }
 
@@ -3179,6 +3244,7 @@ void Score::setTempo(int tick, qreal tempo)
 void Score::removeTempo(int tick)
       {
       tempomap()->delTempo(tick);
+      repeatList()->update();
       _playlistDirty = true;
       }
 
@@ -3189,6 +3255,7 @@ void Score::removeTempo(int tick)
 void Score::setPause(int tick, qreal seconds)
       {
       tempomap()->setPause(tick, seconds);
+      repeatList()->update();
       _playlistDirty = true;
       }
 
@@ -59,6 +59,7 @@ class LinkedElements;
 class Lyrics;
 class Measure;
 class MeasureBase;
+class MidiCache;
 class MuseScoreView;
 class Note;
 class Omr;
@@ -132,27 +133,36 @@ enum class LayoutMode : char {
 
 //---------------------------------------------------------
 //   MeasureBaseList
+//    _index holds all measures in list order; it is
+//    updated by every change of the list, so reading it
+//    never writes. Measure ticks are read from the
+//    measures themselves, so the index stays valid if
+//    ticks change
 //---------------------------------------------------------
 
 class MeasureBaseList {
       int _size;
       MeasureBase* _first;
       MeasureBase* _last;
+      QVector<Measure*> _index;
 
       void push_back(MeasureBase* e);
       void push_front(MeasureBase* e);
+      void rebuildIndex();
 
    public:
       MeasureBaseList();
       MeasureBase* first() const { return _first; }
       MeasureBase* last()  const { return _last; }
-      void clear()               { _first = _last = 0; _size = 0; }
+      void clear()               { _first = _last = 0; _size = 0; _index.clear(); }
       void add(MeasureBase*);
       void remove(MeasureBase*);
       void insert(MeasureBase*, MeasureBase*);
       void remove(MeasureBase*, MeasureBase*);
       void change(MeasureBase* o, MeasureBase* n);
       int size() const { return _size; }
+      const QVector<Measure*>& measureIndex() const { return _index; }
+      Measure* findMeasure(int tick) const;
       };
 
 //---------------------------------------------------------
@@ -300,6 +310,7 @@ class Score : public QObject {
       int _mscoreRevision;
 
       Revisions* _revisions;
+      MidiCache* _midiCache;        ///< rendered playback events
       QList<Excerpt*> _excerpts;
 
       QString _layerTags[32];
@@ -449,8 +460,10 @@ class Score : public QObject {
       System* getNextSystem(bool, bool);
       bool doReLayout();
 
-      void layoutStage2();
-      void layoutStage3();
+      void layoutStage2(int stick = 0, int etick = -1);
+      void layoutStage3(int stick = 0, int etick = -1);
+      void layoutStaves3(int startStaff, int endStaff, Segment* ss, int etick);
+      bool layoutRange(int* stick, int* etick) const;
       void beamGraceNotes(Chord*, bool);
 
       void hideEmptyStaves(System* system, bool isFirstSystem);
@@ -461,6 +474,7 @@ class Score : public QObject {
       bool rewriteMeasures(Measure* fm, Measure* lm, const Fraction&, int staffIdx);
       bool rewriteMeasures(Measure* fm, const Fraction& ns, int staffIdx);
       void updateVelo();
+      void updateSubchannels(Measure* sm, Measure* em);
       void swingAdjustParams(Chord*, int&, int&, int, int);
       bool isSubdivided(ChordRest*, int);
       void addAudioTrack();
@@ -483,6 +497,8 @@ class Score : public QObject {
 
    protected:
       void createPlayEvents(Chord*);
+      void createPlayEvents(Measure* sm, Measure* em);
+      void renderMeasure(EventMap* events, Measure*, Staff*, int tickOffset);
       void createGraceNotesPlayEvents(QList<Chord*> gnb, int tick, Chord* chord, int& ontime);
 
       SynthesizerState _synthesizerState;
@@ -778,6 +794,8 @@ class Score : public QObject {
       void renderMidi(EventMap* events);
       void renderStaff(EventMap* events, Staff*);
       void renderSpanners(EventMap* events, int staffIdx);
+      MidiCache* midiCache() const { return _midiCache; }
+      void invalidateMidiCache(const UndoCommand*);
 
       int mscVersion() const    { return _mscVersion; }
       void setMscVersion(int v) { _mscVersion = v; }
@@ -900,15 +918,16 @@ class Score : public QObject {
       void enqueueMidiEvent(MidiInputEvent ev) { midiInputQueue.enqueue(ev); }
 
       Q_INVOKABLE void doLayout();
-      void layoutSystems();
-      void layoutSystems2();
+      void layoutSystems(int stick = 0, int etick = -1, int* ss = 0, int* es = 0);
+      void layoutSystems2(int ss = 0, int es = -1);
       void layoutLinear();
-      void layoutPages();
+      void layoutPages(int ss = 0, int es = -1, int* fp = 0);
       void layoutSystemsUndoRedo();
       void layoutPagesUndoRedo();
       Page* getEmptyPage();
 
       void layoutChords1(Segment* segment, int staffIdx);
+      void layoutSegments(Segment* fs, Segment* ls);
       qreal layoutChords2(QList<Note*>& notes, bool up);
       void layoutChords3(QList<Note*>& notes, Staff* staff, Segment* segment);
 
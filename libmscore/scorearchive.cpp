@@ -0,0 +1,59 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "scorearchive.h"
+#include "thirdparty/qzip/qzipreader_p.h"
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   ScoreArchive
+//---------------------------------------------------------
+
+ScoreArchive::ScoreArchive(const QByteArray& ba)
+   : _data(ba)
+      {
+      _device.setBuffer(&_data);
+      _device.open(QIODevice::ReadOnly);
+      _reader = new MQZipReader(&_device);
+      }
+
+ScoreArchive::~ScoreArchive()
+      {
+      delete _reader;
+      }
+
+//---------------------------------------------------------
+//   read
+//    read the whole archive from io
+//---------------------------------------------------------
+
+QSharedPointer<ScoreArchive> ScoreArchive::read(QIODevice* io)
+      {
+      if (!io->isSequential())
+            io->seek(0);
+      return QSharedPointer<ScoreArchive>(new ScoreArchive(io->readAll()));
+      }
+
+//---------------------------------------------------------
+//   fileData
+//    decompress one entry; may be called from any thread
+//---------------------------------------------------------
+
+QByteArray ScoreArchive::fileData(const QString& path) const
+      {
+      QMutexLocker locker(&_mutex);
+      return _reader->fileData(path);
+      }
+
+}
+
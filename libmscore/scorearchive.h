@@ -0,0 +1,50 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __SCOREARCHIVE_H__
+#define __SCOREARCHIVE_H__
+
+class MQZipReader;
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   ScoreArchive
+//    compressed contents of a .mscz file
+//
+//    The archive is read into memory once; pictures, OMR
+//    page images and audio keep a shared reference and
+//    decompress their entry on first access. The file
+//    itself is not kept open, so saving can still replace
+//    it.
+//---------------------------------------------------------
+
+class ScoreArchive {
+      QByteArray _data;
+      QBuffer _device;
+      MQZipReader* _reader;
+      mutable QMutex _mutex;
+
+   public:
+      ScoreArchive(const QByteArray&);
+      ~ScoreArchive();
+
+      static QSharedPointer<ScoreArchive> read(QIODevice*);
+
+      MQZipReader* reader() const       { return _reader; }
+      QByteArray fileData(const QString& path) const;
+      int size() const                  { return _data.size(); }
+      };
+
+}     // namespace Ms
+#endif
+
@@ -43,7 +43,9 @@
 #include "undo.h"
 #include "imageStore.h"
 #include "audio.h"
+#include "scorearchive.h"
 #include "barline.h"
+#include "profiler.h"
 #include "thirdparty/qzip/qzipreader_p.h"
 #include "thirdparty/qzip/qzipwriter_p.h"
 #ifdef Q_OS_WIN
@@ -247,7 +249,7 @@ void Score::readStaff(XmlReader& e)
 
       if (staff == 0) {
             while (e.readNextStartElement()) {
-                  const QStringRef& tag(e.name());
+                  const XmlTag& tag(e.name());
 
                   if (tag == "Measure") {
                         Measure* measure = 0;
@@ -299,7 +301,7 @@ void Score::readStaff(XmlReader& e)
       else {
             Measure* measure = firstMeasure();
             while (e.readNextStartElement()) {
-                  const QStringRef& tag(e.name());
+                  const XmlTag& tag(e.name());
 
                   if (tag == "Measure") {
                         if (measure == 0) {
@@ -546,6 +548,11 @@ void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
                   QString path = QString("OmrPages/page%1.png").arg(i+1);
                   QBuffer cbuf;
                   OmrPage* page = _omr->page(i);
+                  if (!page->imageLoaded()) {
+                        // still the PNG data of the archive the score was read from
+                        uz.addFile(path, page->archivedImage());
+                        continue;
+                        }
                   const QImage& image = page->image();
                   if (!image.save(&cbuf, "PNG"))
                         throw(QString("save file: cannot save image (%1x%2)").arg(image.width()).arg(image.height()));
@@ -700,7 +707,7 @@ QString readRootFile(MQZipReader* uz, QList<QString>& images)
                         continue;
                         }
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
 
                         if (tag == "rootfile") {
                               if (rootfile.isEmpty()) {
@@ -725,7 +732,12 @@ QString readRootFile(MQZipReader* uz, QList<QString>& images)
 
 Score::FileError Score::loadCompressedMsc(QIODevice* io, bool ignoreVersionError)
       {
-      MQZipReader uz(io);
+      //
+      // images, OMR pages and audio are decompressed
+      // from the archive on first access
+      //
+      QSharedPointer<ScoreArchive> archive = ScoreArchive::read(io);
+      MQZipReader& uz = *archive->reader();
 
       QList<QString> sl;
       QString rootfile = readRootFile(&uz, sl);
@@ -733,13 +745,12 @@ Score::FileError Score::loadCompressedMsc(QIODevice* io, bool ignoreVersionError
             return FileError::FILE_NO_ROOTFILE;
 
       //
-      // load images
+      // add images
       //
+      QList<ImageStoreItem*> images;
       if (!MScore::noImages) {
-            foreach(const QString& s, sl) {
-                  QByteArray dbuf = uz.fileData(s);
-                  imageStore.add(s, dbuf);
-                  }
+            foreach(const QString& s, sl)
+                  images.append(imageStore.add(s, archive));
             }
 
       QByteArray dbuf = uz.fileData(rootfile);
@@ -758,32 +769,30 @@ Score::FileError Score::loadCompressedMsc(QIODevice* io, bool ignoreVersionError
 
       FileError retval = read1(e, ignoreVersionError);
 
+      //
+      // a picture no element refers to would keep
+      // the archive in memory
+      //
+      foreach(ImageStoreItem* item, images) {
+            if (!item->isReferenced())
+                  item->load();
+            }
+
 #ifdef OMR
       //
-      // load OMR page images
+      // OMR page images
       //
       if (_omr) {
             int n = _omr->numPages();
-            for (int i = 0; i < n; ++i) {
-                  QString path = QString("OmrPages/page%1.png").arg(i+1);
-                  QByteArray dbuf = uz.fileData(path);
-                  OmrPage* page = _omr->page(i);
-                  QImage image;
-                  if (image.loadFromData(dbuf, "PNG")) {
-                        page->setImage(image);
-                        }
-                  else
-                        qDebug("load image failed");
-                  }
+            for (int i = 0; i < n; ++i)
+                  _omr->page(i)->setImage(archive, QString("OmrPages/page%1.png").arg(i+1));
             }
 #endif
       //
-      //  read audio
+      //  audio
       //
-      if (_audio) {
-            QByteArray dbuf = uz.fileData("audio.ogg");
-            _audio->setData(dbuf);
-            }
+      if (_audio)
+            _audio->setData(archive);
       return retval;
       }
 
@@ -794,6 +803,7 @@ Score::FileError Score::loadCompressedMsc(QIODevice* io, bool ignoreVersionError
 
 Score::FileError Score::loadMsc(QString name, bool ignoreVersionError)
       {
+      ProfileScope profile("read");
       info.setFile(name);
 
       QFile f(name);
@@ -805,13 +815,22 @@ Score::FileError Score::loadMsc(QString name, bool ignoreVersionError)
       if (name.endsWith(".mscz"))
             return loadCompressedMsc(&f, ignoreVersionError);
       else {
-            XmlReader r(&f);
+            // parse from one buffer instead of reading the
+            // device in chunks; the mapping lives as long as f
+            QByteArray data;
+            uchar* p = f.size() > 0 ? f.map(0, f.size()) : 0;
+            if (p)
+                  data = QByteArray::fromRawData(reinterpret_cast<const char*>(p), f.size());
+            else
+                  data = f.readAll();
+            XmlReader r(data, f.fileName());
             return read1(r, ignoreVersionError);
             }
       }
 
 Score::FileError Score::loadMsc(QString name, QIODevice* io, bool ignoreVersionError)
       {
+      ProfileScope profile("read");
       info.setFile(name);
 
       if (name.endsWith(".mscz"))
@@ -900,7 +919,7 @@ Score::FileError Score::read1(XmlReader& e, bool ignoreVersionError)
                   if (_mscVersion <= 114)
                         return read114(e);
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "programVersion") {
                               _mscoreVersion = e.readElementText();
                               parseVersion(_mscoreVersion);
@@ -961,7 +980,7 @@ bool Score::read(XmlReader& e)
 
       while (e.readNextStartElement()) {
             e.setTrack(-1);
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "Staff")
                   readStaff(e);
             else if (tag == "KeySig")           // obsolete
@@ -822,7 +822,7 @@ void Segment::write(Xml& xml) const
 void Segment::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "subtype")
                   e.skipCurrentElement();
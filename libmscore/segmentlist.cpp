@@ -107,6 +107,7 @@ void SegmentList::insert(Segment* e, Segment* el)
             el->prev()->setNext(e);
             el->setPrev(e);
             check();
+            rebuildIndex();
             }
       }
 
@@ -116,6 +117,7 @@ void SegmentList::insert(Segment* e, Segment* el)
 
 void SegmentList::remove(Segment* el)
       {
+      _index.removeOne(el);
       --_size;
       if (el == _first) {
             _first = _first->next();
@@ -142,6 +144,7 @@ void SegmentList::remove(Segment* el)
 
 void SegmentList::push_back(Segment* e)
       {
+      _index.append(e);
       ++_size;
       e->setNext(0);
       if (_last)
@@ -159,6 +162,7 @@ void SegmentList::push_back(Segment* e)
 
 void SegmentList::push_front(Segment* e)
       {
+      _index.prepend(e);
       ++_size;
       e->setPrev(0);
       if (_first)
@@ -216,6 +220,45 @@ void SegmentList::insert(Segment* seg)
             _last = seg;
       ++_size;
       check();
+      rebuildIndex();
+      }
+
+//---------------------------------------------------------
+//   rebuildIndex
+//---------------------------------------------------------
+
+void SegmentList::rebuildIndex()
+      {
+      _index.clear();
+      _index.reserve(_size);
+      for (Segment* s = _first; s; s = s->next())
+            _index.append(s);
+      }
+
+//---------------------------------------------------------
+//   findSegment
+//    binary search for the first segment at or after
+//    rtick (relative to the measure start); does not
+//    change the list, so layout threads may call it
+//    concurrently
+//---------------------------------------------------------
+
+Segment* SegmentList::findSegment(int rtick) const
+      {
+      auto i = std::lower_bound(_index.begin(), _index.end(), rtick,
+         [](const Segment* s, int t) { return s->rtick() < t; });
+      if (i == _index.end())
+            return 0;
+      // segment ticks may be out of order while a measure is
+      // being changed; fall back to a linear search
+      if (i != _index.begin() && (*(i - 1))->rtick() > (*i)->rtick()) {
+            for (Segment* s = _first; s; s = s->next()) {
+                  if (s->rtick() >= rtick)
+                        return s;
+                  }
+            return 0;
+            }
+      return *i;
       }
 
 //---------------------------------------------------------
@@ -25,10 +25,13 @@ class SegmentList {
       Segment* _first;        ///< First item of segment list
       Segment* _last;         ///< Last item of segment list
       int _size;              ///< Number of items in segment list
+      QVector<Segment*> _index;  ///< segments in list order, kept up to date by all changes
+
+      void rebuildIndex();
 
    public:
       SegmentList()                        { clear(); }
-      void clear()                         { _first = _last = 0; _size = 0; }
+      void clear()                         { _first = _last = 0; _size = 0; _index.clear(); }
 #ifndef NDEBUG
       void check();
 #else
@@ -47,6 +50,7 @@ class SegmentList {
       void push_front(Segment*);
       void insert(Segment*);
       void insert(Segment* e, Segment* el);
+      Segment* findSegment(int rtick) const;
       };
 
 
@@ -210,7 +210,7 @@ void TimeSigMap::write(Xml& xml) const
 void TimeSigMap::read(XmlReader& e, int fileDivision)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "sig") {
                   SigEvent t;
                   int tick = t.read(e, fileDivision);
@@ -260,7 +260,7 @@ int SigEvent::read(XmlReader& e, int fileDivision)
       int numerator2   = -1;
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "nom")
                   numerator = e.readInt();
             else if (tag == "denom")
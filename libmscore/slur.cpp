@@ -448,7 +448,7 @@ void SlurSegment::writeSlur(Xml& xml, int no) const
 void SlurSegment::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "o1")
                   ups(Grip::START).off = e.readPoint();
             else if (tag == "o2")
@@ -1043,7 +1043,7 @@ void SlurTie::writeProperties(Xml& xml) const
 
 bool SlurTie::readProperties(XmlReader& e)
       {
-      const QStringRef& tag(e.name());
+      const XmlTag& tag(e.name());
 
       if (tag == "SlurSegment") {
             int idx = e.intAttribute("no", 0);
@@ -1270,7 +1270,7 @@ void Slur::read(XmlReader& e)
       setTrack(e.track());      // set staff
       e.addSpanner(e.intAttribute("id"), this);
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "track2")
                   setTrack2(e.readInt());
             else if (tag == "startTrack")       // obsolete
@@ -161,7 +161,7 @@ void Spacer::write(Xml& xml) const
 void Spacer::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype")
                   _spacerType = SpacerType(e.readInt());
             else if (tag == "space")
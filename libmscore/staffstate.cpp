@@ -64,7 +64,7 @@ void StaffState::write(Xml& xml) const
 void StaffState::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype")
                   _staffStateType = StaffStateType(e.readInt());
             else if (tag == "Instrument")
@@ -80,7 +80,7 @@ void StaffText::read(XmlReader& e)
             _channelNames[voice].clear();
       clearAeolusStops();
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "MidiAction") {
                   int channel = e.intAttribute("channel", 0);
                   QString name = e.attribute("name");
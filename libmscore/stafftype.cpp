@@ -263,7 +263,7 @@ void StaffType::read(XmlReader& e)
             }
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "name")
                   setXmlName(e.readElementText());
             else if (tag == "lines")
@@ -759,7 +759,7 @@ bool TablatureFretFont::read(XmlReader& e)
       defPitch = 9.0;
       defYOffset = 0.0;
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             int val = e.intAttribute("value");
 
@@ -804,7 +804,7 @@ bool TablatureFretFont::read(XmlReader& e)
 bool TablatureDurationFont::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "family")
                   family = e.readElementText();
@@ -893,7 +893,7 @@ bool StaffType::readConfigFile(const QString& fileName)
       while (e.readNextStartElement()) {
             if (e.name() == "museScore") {
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "fretFont") {
                               TablatureFretFont f;
                               if (f.read(e))
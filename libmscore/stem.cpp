@@ -217,7 +217,7 @@ void Stem::write(Xml& xml) const
 void Stem::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "userLen")
                   _userLen = e.readDouble() * spatium();
             else if (tag == "subtype")        // obsolete
@@ -963,7 +963,7 @@ void TextStyleData::read(XmlReader& e)
 
 bool TextStyleData::readProperties(XmlReader& e)
       {
-      const QStringRef& tag(e.name());
+      const XmlTag& tag(e.name());
 
       if (tag == "name")
             name = e.readElementText();
@@ -16,6 +16,7 @@
 #include "score.h"
 #include "xml.h"
 #include "mscore.h"
+#include "profiler.h"
 
 #include FT_GLYPH_H
 #include FT_IMAGE_H
@@ -33,6 +34,8 @@ namespace Ms {
 
 static const int FALLBACK_FONT = 2;       // Bravura
 
+int ScoreFont::_glyphCacheSize = 16 * 1024 * 1024;      // per font, in bytes
+
 QVector<ScoreFont> ScoreFont::_scoreFonts {
       ScoreFont("Emmentaler", "MScore",      ":/fonts/mscore/",   "mscore.ttf"   ),
       ScoreFont("Gonville",   "Gootville",   ":/fonts/gootville/", "Gootville.otf" ),
@@ -5315,11 +5318,6 @@ void ScoreFont::draw(SymId id, QPainter* painter, qreal mag, const QPointF& pos,
             qDebug("ScoreFont::draw: invalid sym %d\n", int(id));
             return;
             }
-      int rv = FT_Load_Glyph(face, sym(id).index(), FT_LOAD_DEFAULT);
-      if (rv) {
-            qDebug("load glyph id %d, failed: 0x%x", int(id), rv);
-            return;
-            }
 
       if (MScore::pdfPrinting) {
             if (font == 0) {
@@ -5357,49 +5355,139 @@ void ScoreFont::draw(SymId id, QPainter* painter, qreal mag, const QPointF& pos,
 
       GlyphKey gk(id, scale16, color);
       GlyphPixmap* pm = cache->object(gk);
-      if (!pm) {
-            FT_Matrix matrix {
-                  scale16, 0,
-                  0,       scale16
-                  };
+      if (pm) {
+            ++_cacheHits;
+            if (Profiler::enabled())
+                  Profiler::addCount("glyphcache/hit");
+            painter->drawPixmap(pos + pm->offset, pm->pm);
+            return;
+            }
+      ++_cacheMisses;
+      if (Profiler::enabled())
+            Profiler::addCount("glyphcache/miss");
+      GlyphPixmap gp;
+      if (!renderGlyph(id, scale16, worldScale, color, &gp))
+            return;
+      painter->drawPixmap(pos + gp.offset, gp.pm);
+      cacheGlyph(gk, gp);
+      }
 
-            FT_Glyph glyph;
-            FT_Get_Glyph(face->glyph, &glyph);
-            FT_Glyph_Transform(glyph, &matrix, 0);
-            rv = FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, 0, 1);
-            if (rv) {
-                  qDebug("glyph to bitmap failed: 0x%x", rv);
-                  return;
-                  }
+//---------------------------------------------------------
+//   renderGlyph
+//    rasterize glyph id with the fixed point scale
+//    factor scale16 in the given color
+//---------------------------------------------------------
+
+bool ScoreFont::renderGlyph(SymId id, int scale16, qreal worldScale, QColor color, GlyphPixmap* gp) const
+      {
+      int rv = FT_Load_Glyph(face, sym(id).index(), FT_LOAD_DEFAULT);
+      if (rv) {
+            qDebug("load glyph id %d, failed: 0x%x", int(id), rv);
+            return false;
+            }
+      FT_Matrix matrix {
+            scale16, 0,
+            0,       scale16
+            };
 
-            FT_BitmapGlyph gb = (FT_BitmapGlyph)glyph;
-            FT_Bitmap* bm     = &gb->bitmap;
+      FT_Glyph glyph;
+      FT_Get_Glyph(face->glyph, &glyph);
+      FT_Glyph_Transform(glyph, &matrix, 0);
+      rv = FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, 0, 1);
+      if (rv) {
+            qDebug("glyph to bitmap failed: 0x%x", rv);
+            FT_Done_Glyph(glyph);
+            return false;
+            }
 
-            if (bm->width == 0 || bm->rows == 0) {
-                  qDebug("zero glyph");
-                  return;
-                  }
-            QImage img(QSize(bm->width, bm->rows), QImage::Format_ARGB32);
-            img.fill(Qt::transparent);
+      FT_BitmapGlyph gb = (FT_BitmapGlyph)glyph;
+      FT_Bitmap* bm     = &gb->bitmap;
 
-            for (int y = 0; y < int(bm->rows); ++y) {
-                  unsigned* dst      = (unsigned*)img.scanLine(y);
-                  unsigned char* src = (unsigned char*)(bm->buffer) + bm->pitch * y;
-                  for (int x = 0; x < int(bm->width); ++x) {
-                        unsigned val = *src++;
-                        color.setAlpha(val);
-                        *dst++ = color.rgba();
-                        }
-                  }
-            pm = new GlyphPixmap;
-            pm->pm = QPixmap::fromImage(img, Qt::NoFormatConversion);
-            pm->pm.setDevicePixelRatio(worldScale);
-            pm->offset = QPointF(qreal(gb->left), -qreal(gb->top)) / worldScale;
-            if (!cache->insert(gk, pm))
-                  qDebug("cannot cache glyph");
+      if (bm->width == 0 || bm->rows == 0) {
+            qDebug("zero glyph");
             FT_Done_Glyph(glyph);
+            return false;
+            }
+      QImage img(QSize(bm->width, bm->rows), QImage::Format_ARGB32);
+      img.fill(Qt::transparent);
+
+      for (int y = 0; y < int(bm->rows); ++y) {
+            unsigned* dst      = (unsigned*)img.scanLine(y);
+            unsigned char* src = (unsigned char*)(bm->buffer) + bm->pitch * y;
+            for (int x = 0; x < int(bm->width); ++x) {
+                  unsigned val = *src++;
+                  color.setAlpha(val);
+                  *dst++ = color.rgba();
+                  }
+            }
+      gp->pm = QPixmap::fromImage(img, Qt::NoFormatConversion);
+      gp->pm.setDevicePixelRatio(worldScale);
+      gp->offset = QPointF(qreal(gb->left), -qreal(gb->top)) / worldScale;
+      FT_Done_Glyph(glyph);
+      return true;
+      }
+
+//---------------------------------------------------------
+//   cacheGlyph
+//    pixmaps larger than the whole cache are not cached
+//---------------------------------------------------------
+
+void ScoreFont::cacheGlyph(const GlyphKey& gk, const GlyphPixmap& gp) const
+      {
+      int cost = gp.pm.width() * gp.pm.height() * 4;
+      if (cost > cache->maxCost())
+            return;
+      if (!cache->insert(gk, new GlyphPixmap(gp), cost))
+            qDebug("cannot cache glyph");
+      }
+
+//---------------------------------------------------------
+//   preloadGlyphs
+//    rasterize the most common symbols for a new
+//    magnification, so that the first paint after
+//    zooming does not render them one by one
+//---------------------------------------------------------
+
+void ScoreFont::preloadGlyphs(qreal mag, qreal worldScale, const QColor& color) const
+      {
+      static const SymId common[] = {
+            SymId::noteheadBlack, SymId::noteheadHalf, SymId::noteheadWhole,
+            SymId::augmentationDot,
+            SymId::accidentalSharp, SymId::accidentalFlat, SymId::accidentalNatural,
+            SymId::restWhole, SymId::restHalf, SymId::restQuarter, SymId::rest8th, SymId::rest16th,
+            SymId::flag8thUp, SymId::flag8thDown, SymId::flag16thUp, SymId::flag16thDown,
+            SymId::gClef, SymId::fClef, SymId::cClef,
+            };
+      if (!cache || MScore::pdfPrinting)
+            return;
+      if (worldScale < 1.0)
+            worldScale = 1.0;
+      int scale16 = lrint(worldScale * 6553.6 * mag);
+      for (SymId id : common) {
+            if (!isValid(id))
+                  continue;
+            GlyphKey gk(id, scale16, color);
+            if (cache->contains(gk))
+                  continue;
+            GlyphPixmap gp;
+            if (renderGlyph(id, scale16, worldScale, color, &gp))
+                  cacheGlyph(gk, gp);
+            }
+      }
+
+//---------------------------------------------------------
+//   setGlyphCacheSize
+//    maximum size of the rasterized glyphs cached per
+//    score font, in bytes
+//---------------------------------------------------------
+
+void ScoreFont::setGlyphCacheSize(int bytes)
+      {
+      _glyphCacheSize = bytes;
+      for (ScoreFont& f : _scoreFonts) {
+            if (f.cache)
+                  f.cache->setMaxCost(bytes);
             }
-      painter->drawPixmap(pos + pm->offset, pm->pm);
       }
 
 void ScoreFont::draw(SymId id, QPainter* painter, qreal mag, const QPointF& pos, int n) const
@@ -5520,7 +5608,7 @@ void ScoreFont::load()
             qDebug("freetype: cannot create face <%s>: %d", qPrintable(facePath), rval);
             return;
             }
-      cache = new QCache<GlyphKey, GlyphPixmap>(100);
+      cache = new QCache<GlyphKey, GlyphPixmap>(_glyphCacheSize);
 
       qreal pixelSize = 200.0 * MScore::DPI/PPI;
       FT_Set_Pixel_Sizes(face, 0, int(pixelSize+.5));
@@ -2609,7 +2609,7 @@ struct GlyphPixmap {
 
 inline uint qHash(const GlyphKey& k)
       {
-      return (int(k.id) << 16) + k.mag;
+      return ((int(k.id) << 16) + k.mag) ^ k.color.rgba();
       }
 
 //---------------------------------------------------------
@@ -2624,13 +2624,18 @@ class ScoreFont {
       QString _fontPath;
       QString _filename;
       QByteArray fontImage;
-      QCache<GlyphKey, GlyphPixmap>* cache { 0 };
+      QCache<GlyphKey, GlyphPixmap>* cache { 0 };     // cost is the pixmap size in bytes
+      mutable int _cacheHits { 0 };
+      mutable int _cacheMisses { 0 };
       mutable QFont* font { 0 };
 
       static QVector<ScoreFont> _scoreFonts;
+      static int _glyphCacheSize;
       const Sym& sym(SymId id) const { return _symbols[int(id)]; }
       void load();
       void computeMetrics(Sym* sym, int code);
+      bool renderGlyph(SymId, int scale16, qreal worldScale, QColor, GlyphPixmap*) const;
+      void cacheGlyph(const GlyphKey&, const GlyphPixmap&) const;
 
    public:
       ScoreFont() {}
@@ -2648,6 +2653,13 @@ class ScoreFont {
       static ScoreFont* fallbackFont();
       static const char* fallbackTextFont();
       static const QVector<ScoreFont>& scoreFonts() { return _scoreFonts; }
+      static int glyphCacheSize()           { return _glyphCacheSize; }
+      static void setGlyphCacheSize(int bytes);
+
+      void preloadGlyphs(qreal mag, qreal worldScale, const QColor&) const;
+      int glyphCacheHits() const            { return _cacheHits;   }
+      int glyphCacheMisses() const          { return _cacheMisses; }
+      void resetGlyphCacheStats()           { _cacheHits = 0; _cacheMisses = 0; }
 
       QString toString(SymId) const;
       QPixmap sym2pixmap(SymId, qreal) { return QPixmap(); }      // TODOxxxx
@@ -1108,7 +1108,7 @@ void System::write(Xml& xml) const
 void System::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "BarLine") {
 //                  _barLine = new BarLine(score());
@@ -53,7 +53,7 @@ void TempoText::write(Xml& xml) const
 void TempoText::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "tempo")
                   _tempo = e.readDouble();
             else if (tag == "followText")
@@ -2229,7 +2229,7 @@ extern QString convertOldTextStyleNames(const QString&);
 
 bool Text::readProperties(XmlReader& e)
       {
-      const QStringRef& tag(e.name());
+      const XmlTag& tag(e.name());
 
       if (tag == "style") {
             QString val(e.readElementText());
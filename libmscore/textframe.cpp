@@ -81,7 +81,7 @@ void TBox::write(Xml& xml) const
 void TBox::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "Text")
                   _text->read(e);
             else if (Box::readProperties(e))
@@ -729,7 +729,7 @@ static QString resolveSymCompatibility(SymId i, QString programVersion)
 
 bool TextLine::readProperties(XmlReader& e)
       {
-      const QStringRef& tag(e.name());
+      const XmlTag& tag(e.name());
 
       if (tag == "lineVisible")
             _lineVisible = e.readBool();
@@ -177,7 +177,7 @@ void TimeSig::read(XmlReader& e)
       customText = false;
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "den") {
                   old = true;
@@ -378,7 +378,7 @@ void Trill::read(XmlReader& e)
 
       e.addSpanner(e.intAttribute("id", -1), this);
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "subtype")
                   setTrillType(e.readElementText());
             else if (tag == "Accidental") {
@@ -649,7 +649,7 @@ void Tuplet::read(XmlReader& e)
       _id    = e.intAttribute("id", 0);
 
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "direction")
                   setProperty(P_ID::DIRECTION, Ms::getProperty(P_ID::DIRECTION, e));
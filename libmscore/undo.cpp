@@ -131,6 +131,109 @@ void UndoCommand::cleanup(bool undo)
             c->cleanup(undo);
       }
 
+//---------------------------------------------------------
+//   UndoCommand::layoutRange
+//    Merge the tick range touched by this command into
+//    [stick, etick). Returns false if the command may
+//    affect the whole score.
+//---------------------------------------------------------
+
+bool UndoCommand::layoutRange(int* stick, int* etick) const
+      {
+      if (childList.isEmpty())
+            return false;
+      for (UndoCommand* c : childList) {
+            if (!c->layoutRange(stick, etick))
+                  return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   elementLayoutRange
+//    merge the measure containing e into [stick, etick);
+//    only elements whose changes do not propagate beyond
+//    their measure are considered
+//---------------------------------------------------------
+
+static bool elementLayoutRange(const Element* e, int* stick, int* etick)
+      {
+      switch (e->type()) {
+            case Element::Type::NOTE:
+            case Element::Type::CHORD:
+            case Element::Type::REST:
+            case Element::Type::ACCIDENTAL:
+            case Element::Type::ARTICULATION:
+            case Element::Type::FINGERING:
+            case Element::Type::LYRICS:
+            case Element::Type::HARMONY:
+            case Element::Type::DYNAMIC:
+            case Element::Type::STAFF_TEXT:
+            case Element::Type::TIE:
+            case Element::Type::SEGMENT:
+                  break;
+            default:
+                  return false;
+            }
+      const Element* p = e;
+      while (p && p->type() != Element::Type::MEASURE)
+            p = p->parent();
+      if (!p)
+            return false;
+      const Measure* m = static_cast<const Measure*>(p);
+      if (*stick == -1 || m->tick() < *stick)
+            *stick = m->tick();
+      if (*etick == -1 || m->endTick() > *etick)
+            *etick = m->endTick();
+      return true;
+      }
+
+//---------------------------------------------------------
+//   UndoCommand::playbackRange
+//    Merge the tick range whose playback events are changed
+//    by this command into [stick, etick). Returns false if
+//    the command may change playback of the whole score.
+//---------------------------------------------------------
+
+bool UndoCommand::playbackRange(int* stick, int* etick) const
+      {
+      if (childList.isEmpty())
+            return false;
+      for (UndoCommand* c : childList) {
+            if (!c->playbackRange(stick, etick))
+                  return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   elementPlaybackRange
+//    merge the measure containing e into [stick, etick);
+//    dynamics, staff texts and spanners change the playback
+//    of the following measures and are not considered
+//---------------------------------------------------------
+
+static bool elementPlaybackRange(const Element* e, int* stick, int* etick)
+      {
+      switch (e->type()) {
+            case Element::Type::NOTE:
+            case Element::Type::CHORD:
+            case Element::Type::REST:
+            case Element::Type::ACCIDENTAL:
+            case Element::Type::ARTICULATION:
+            case Element::Type::TIE:
+            case Element::Type::SEGMENT:
+                  break;
+            case Element::Type::FINGERING:
+            case Element::Type::LYRICS:
+            case Element::Type::HARMONY:
+                  return true;            // not played
+            default:
+                  return false;
+            }
+      return elementLayoutRange(e, stick, etick);
+      }
+
 //---------------------------------------------------------
 //   undo
 //---------------------------------------------------------
@@ -183,6 +286,7 @@ void UndoCommand::unwind()
 UndoStack::UndoStack()
       {
       curCmd   = 0;
+      lastCmd  = 0;
       curIdx   = 0;
       cleanIdx = 0;
       }
@@ -226,8 +330,10 @@ void UndoStack::endMacro(bool rollback)
             qDebug("UndoStack:endMacro(): not active");
             return;
             }
-      if (rollback)
+      if (rollback) {
             delete curCmd;
+            lastCmd = 0;
+            }
       else {
             // remove redo stack
             while (list.size() > curIdx) {
@@ -237,6 +343,7 @@ void UndoStack::endMacro(bool rollback)
                   }
             list.append(curCmd);
             ++curIdx;
+            lastCmd = curCmd;
             }
       curCmd = 0;
       }
@@ -316,7 +423,8 @@ void UndoStack::undo()
             Q_ASSERT(curIdx >= 0);
             if (MScore::debugMode)
                   qDebug("--undo index %d", curIdx);
-            list[curIdx]->undo();
+            lastCmd = list[curIdx];
+            lastCmd->undo();
             }
       }
 
@@ -329,7 +437,8 @@ void UndoStack::redo()
       if (canRedo()) {
             if (MScore::debugMode)
                   qDebug("--redo index %d", curIdx);
-            list[curIdx++]->redo();
+            lastCmd = list[curIdx++];
+            lastCmd->redo();
             }
       }
 
@@ -1563,6 +1672,24 @@ void AddElement::redo()
       endUndoRedo(false);
       }
 
+//---------------------------------------------------------
+//   layoutRange
+//---------------------------------------------------------
+
+bool AddElement::layoutRange(int* stick, int* etick) const
+      {
+      return elementLayoutRange(element, stick, etick);
+      }
+
+//---------------------------------------------------------
+//   playbackRange
+//---------------------------------------------------------
+
+bool AddElement::playbackRange(int* stick, int* etick) const
+      {
+      return elementPlaybackRange(element, stick, etick);
+      }
+
 //---------------------------------------------------------
 //   name
 //---------------------------------------------------------
@@ -1695,6 +1822,24 @@ void RemoveElement::redo()
             }
       }
 
+//---------------------------------------------------------
+//   layoutRange
+//---------------------------------------------------------
+
+bool RemoveElement::layoutRange(int* stick, int* etick) const
+      {
+      return elementLayoutRange(element, stick, etick);
+      }
+
+//---------------------------------------------------------
+//   playbackRange
+//---------------------------------------------------------
+
+bool RemoveElement::playbackRange(int* stick, int* etick) const
+      {
+      return elementPlaybackRange(element, stick, etick);
+      }
+
 //---------------------------------------------------------
 //   name
 //---------------------------------------------------------
@@ -1909,6 +2054,24 @@ void ChangePitch::flip()
       note->score()->setLayoutAll(true);
       }
 
+//---------------------------------------------------------
+//   ChangePitch::layoutRange
+//---------------------------------------------------------
+
+bool ChangePitch::layoutRange(int* stick, int* etick) const
+      {
+      return elementLayoutRange(note, stick, etick);
+      }
+
+//---------------------------------------------------------
+//   ChangePitch::playbackRange
+//---------------------------------------------------------
+
+bool ChangePitch::playbackRange(int* stick, int* etick) const
+      {
+      return elementPlaybackRange(note, stick, etick);
+      }
+
 //---------------------------------------------------------
 //   ChangeFretting
 //
@@ -109,6 +109,8 @@ class UndoCommand {
       int childCount() const             { return childList.size();     }
       void unwind();
       virtual void cleanup(bool undo);
+      virtual bool layoutRange(int* stick, int* etick) const;
+      virtual bool playbackRange(int* stick, int* etick) const;
 #ifdef DEBUG_UNDO
       virtual const char* name() const  { return "UndoCommand"; }
 #endif
@@ -120,6 +122,7 @@ class UndoCommand {
 
 class UndoStack {
       UndoCommand* curCmd;
+      UndoCommand* lastCmd;         ///< last executed, undone or redone macro
       QList<UndoCommand*> list;
       int curIdx;
       int cleanIdx;
@@ -140,6 +143,7 @@ class UndoStack {
       bool isClean() const          { return cleanIdx == curIdx;   }
       bool isEmpty() const          { return !canUndo() && !canRedo();  }
       UndoCommand* current() const  { return curCmd;               }
+      UndoCommand* last() const     { return lastCmd;              }
       void undo();
       void redo();
       };
@@ -159,6 +163,8 @@ class SaveState : public UndoCommand {
       SaveState(Score*);
       virtual void undo();
       virtual void redo();
+      virtual bool layoutRange(int*, int*) const { return true; }
+      virtual bool playbackRange(int*, int*) const { return true; }
       UNDO_NAME("SaveState")
       };
 
@@ -315,6 +321,8 @@ class ChangePitch : public UndoCommand {
 
    public:
       ChangePitch(Note* note, int pitch, int tpc1, int tpc2);
+      virtual bool layoutRange(int* stick, int* etick) const;
+      virtual bool playbackRange(int* stick, int* etick) const;
       UNDO_NAME("ChangePitch")
       };
 
@@ -573,6 +581,8 @@ class AddElement : public UndoCommand {
       virtual void undo();
       virtual void redo();
       virtual void cleanup(bool);
+      virtual bool layoutRange(int* stick, int* etick) const;
+      virtual bool playbackRange(int* stick, int* etick) const;
 #ifdef DEBUG_UNDO
       virtual const char* name() const;
 #endif
@@ -590,6 +600,8 @@ class RemoveElement : public UndoCommand {
       virtual void undo();
       virtual void redo();
       virtual void cleanup(bool);
+      virtual bool layoutRange(int* stick, int* etick) const;
+      virtual bool playbackRange(int* stick, int* etick) const;
 #ifdef DEBUG_UNDO
       virtual const char* name() const;
 #endif
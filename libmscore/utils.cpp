@@ -45,15 +45,13 @@ Measure* Score::tick2measure(int tick) const
       {
       if (tick == -1)
             return lastMeasure();
-      Measure* lm = 0;
-
-      for (Measure* m = firstMeasure(); m; m = m->nextMeasure()) {
-            if (tick < m->tick())
-                  return lm;
-            lm = m;
-            }
+      Measure* lm = _measures.findMeasure(tick);
+      if (lm && lm->nextMeasure())
+            return lm;
+      if (lm == 0 && firstMeasure())
+            return 0;
       // check last measure
-      if (lm && (tick >= lm->tick()) && (tick <= lm->endTick()))
+      if (lm && (tick <= lm->endTick()))
             return lm;
       qDebug("tick2measure %d (max %d) not found", tick, lm ? lm->tick() : -1);
       return 0;
@@ -61,24 +59,21 @@ Measure* Score::tick2measure(int tick) const
 
 //---------------------------------------------------------
 //   tick2measureMM
+//    multi measure rests are not in the measure list;
+//    map the measure to the rest covering it
 //---------------------------------------------------------
 
 Measure* Score::tick2measureMM(int tick) const
       {
       if (tick == -1)
             return lastMeasureMM();
-      Measure* lm = 0;
-
-      for (Measure* m = firstMeasureMM(); m; m = m->nextMeasureMM()) {
-            if (tick < m->tick())
-                  return lm;
-            lm = m;
+      Measure* m = tick2measure(tick);
+      if (m && styleB(StyleIdx::createMultiMeasureRests)) {
+            Measure* m1 = const_cast<Measure*>(m->mmRest1());
+            if (m1)
+                  return m1;
             }
-      // check last measure
-      if (lm && (tick >= lm->tick()) && (tick <= lm->endTick()))
-            return lm;
-      qDebug("tick2measureMM %d (max %d) not found", tick, lm ? lm->tick() : -1);
-      return 0;
+      return m;
       }
 
 //---------------------------------------------------------
@@ -122,12 +117,17 @@ Segment* Score::tick2segment(int tick, bool first, Segment::Type st, bool useMMr
             qDebug("   no segment for tick %d", tick);
             return 0;
             }
-      for (Segment* segment = m->first(st); segment;) {
+      Segment* segment = m->segments()->findSegment(tick - m->tick());
+      if (segment && !(segment->segmentType() & st))
+            segment = segment->next(st);
+      for (; segment;) {
             int t1 = segment->tick();
             Segment* nsegment = segment->next(st);
             int t2 = nsegment ? nsegment->tick() : INT_MAX;
             if ((tick == t1) && (first || (tick < t2)))
                   return segment;
+            if (t1 > tick)
+                  break;
             segment = nsegment;
             }
       return 0;
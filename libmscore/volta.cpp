@@ -213,7 +213,7 @@ void Volta::read(XmlReader& e)
 
       e.addSpanner(e.intAttribute("id", -1), this);
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "text")            // obsolete
                   setText(e.readElementText());
             else if (tag == "endings") {
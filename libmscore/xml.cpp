@@ -10,6 +10,8 @@
 //  the file LICENCE.GPL
 //=============================================================================
 
+#include <cmath>
+
 #include "xml.h"
 #include "layoutbreak.h"
 #include "spanner.h"
@@ -24,20 +26,21 @@ QString docName;
 
 //---------------------------------------------------------
 //   intAttribute
+//    attribute names are looked up as QLatin1String to
+//    avoid a QString conversion per lookup; a missing
+//    attribute has a null value
 //---------------------------------------------------------
 
 int XmlReader::intAttribute(const char* s, int _default) const
       {
-      if (attributes().hasAttribute(s))
-            // return attributes().value(s).toString().toInt();
-            return attributes().value(s).toInt();
-      else
-            return _default;
+      const XmlStreamAttributes& a = attributes();
+      QStringRef v = a.value(QLatin1String(s));
+      return v.isNull() ? _default : v.toInt();
       }
 
 int XmlReader::intAttribute(const char* s) const
       {
-      return attributes().value(s).toInt();
+      return attributes().value(QLatin1String(s)).toInt();
       }
 
 //---------------------------------------------------------
@@ -46,15 +49,14 @@ int XmlReader::intAttribute(const char* s) const
 
 double XmlReader::doubleAttribute(const char* s) const
       {
-      return attributes().value(s).toDouble();
+      return attributes().value(QLatin1String(s)).toDouble();
       }
 
 double XmlReader::doubleAttribute(const char* s, double _default) const
       {
-      if (attributes().hasAttribute(s))
-            return attributes().value(s).toDouble();
-      else
-            return _default;
+      const XmlStreamAttributes& a = attributes();
+      QStringRef v = a.value(QLatin1String(s));
+      return v.isNull() ? _default : v.toDouble();
       }
 
 //---------------------------------------------------------
@@ -63,10 +65,9 @@ double XmlReader::doubleAttribute(const char* s, double _default) const
 
 QString XmlReader::attribute(const char* s, const QString& _default) const
       {
-      if (attributes().hasAttribute(s))
-            return attributes().value(s).toString();
-      else
-            return _default;
+      const XmlStreamAttributes& a = attributes();
+      QStringRef v = a.value(QLatin1String(s));
+      return v.isNull() ? _default : v.toString();
       }
 
 //---------------------------------------------------------
@@ -75,7 +76,20 @@ QString XmlReader::attribute(const char* s, const QString& _default) const
 
 bool XmlReader::hasAttribute(const char* s) const
       {
-      return attributes().hasAttribute(s);
+      return attributes().hasAttribute(QLatin1String(s));
+      }
+
+//---------------------------------------------------------
+//   readText
+//    readElementText() into a reused buffer; the result
+//    is valid until the next call
+//---------------------------------------------------------
+
+QStringRef XmlReader::readText()
+      {
+      _text.resize(0);
+      readElementText(&_text);
+      return QStringRef(&_text);
       }
 
 //---------------------------------------------------------
@@ -205,7 +219,7 @@ void XmlReader::addTuplet(Tuplet* s)
 
 double XmlReader::readDouble(double min, double max)
       {
-      double val = readElementText().toDouble();
+      double val = readText().toDouble();
       if (val < min)
             val = min;
       else if (val > max)
@@ -246,13 +260,201 @@ bool compareProperty(void* val, void* defaultVal)
 
 Xml::Xml()
       {
-      setCodec("UTF-8");
+      _buffer.reserve(FLUSH_SIZE + BS);
       }
 
 Xml::Xml(QIODevice* device)
-   : QTextStream(device)
+   : _device(device)
+      {
+      _buffer.reserve(FLUSH_SIZE + BS);
+      }
+
+Xml::~Xml()
+      {
+      flush();
+      }
+
+//---------------------------------------------------------
+//   setDevice
+//---------------------------------------------------------
+
+void Xml::setDevice(QIODevice* device)
       {
-      setCodec("UTF-8");
+      flush();
+      _device = device;
+      }
+
+//---------------------------------------------------------
+//   flush
+//    write buffered output to the device
+//---------------------------------------------------------
+
+void Xml::flush()
+      {
+      if (_buffer.isEmpty())
+            return;
+      if (_device)
+            _device->write(_buffer);
+      _buffer.resize(0);      // keeps the reserved capacity
+      }
+
+//---------------------------------------------------------
+//   endLine
+//---------------------------------------------------------
+
+void Xml::endLine()
+      {
+      _buffer.append('\n');
+      if (_stack.isEmpty() || _buffer.size() >= FLUSH_SIZE)
+            flush();
+      }
+
+//---------------------------------------------------------
+//   put
+//    append utf-8 encoded string
+//---------------------------------------------------------
+
+void Xml::put(const QChar* s, int n)
+      {
+      for (int i = 0; i < n; ++i) {
+            uint c = s[i].unicode();
+            if (c < 0x80) {
+                  _buffer.append(char(c));
+                  continue;
+                  }
+            if (c < 0x800)
+                  _buffer.append(char(0xc0 | (c >> 6)));
+            else {
+                  if (QChar::isHighSurrogate(c) && i + 1 < n && s[i + 1].isLowSurrogate()) {
+                        c = QChar::surrogateToUcs4(ushort(c), s[++i].unicode());
+                        _buffer.append(char(0xf0 | (c >> 18)));
+                        _buffer.append(char(0x80 | ((c >> 12) & 0x3f)));
+                        }
+                  else {
+                        if (QChar::isSurrogate(c))
+                              c = QChar::ReplacementCharacter;
+                        _buffer.append(char(0xe0 | (c >> 12)));
+                        }
+                  _buffer.append(char(0x80 | ((c >> 6) & 0x3f)));
+                  }
+            _buffer.append(char(0x80 | (c & 0x3f)));
+            }
+      }
+
+//---------------------------------------------------------
+//   xmlEscape
+//    return the entity for c, an empty string for
+//    characters invalid in xml 1.0 and 0 if c needs no
+//    escaping
+//---------------------------------------------------------
+
+static const char* xmlEscape(ushort c)
+      {
+      switch(c) {
+            case '<':
+                  return "&lt;";
+            case '>':
+                  return "&gt;";
+            case '&':
+                  return "&amp;";
+            case '\"':
+                  return "&quot;";
+            default:
+                  if ((c < 0x20 && c != 0x09 && c != 0x0A && c != 0x0D))
+                        return "";
+                  return 0;
+            }
+      }
+
+//---------------------------------------------------------
+//   putEscaped
+//    same as put(xmlString(s)) without the temporary
+//---------------------------------------------------------
+
+void Xml::putEscaped(const QString& s)
+      {
+      const QChar* p = s.constData();
+      int n          = s.size();
+      int run        = 0;     // start of unescaped characters
+      for (int i = 0; i < n; ++i) {
+            const char* entity = xmlEscape(p[i].unicode());
+            if (entity) {
+                  put(p + run, i - run);
+                  put(entity);
+                  run = i + 1;
+                  }
+            }
+      put(p + run, n - run);
+      }
+
+void Xml::putEscaped(const char* s)
+      {
+      const char* run = s;
+      for (const char* p = s; *p; ++p) {
+            const char* entity = xmlEscape(uchar(*p));
+            if (entity) {
+                  _buffer.append(run, int(p - run));
+                  put(entity);
+                  run = p + 1;
+                  }
+            }
+      put(run);
+      }
+
+//---------------------------------------------------------
+//   putInt
+//---------------------------------------------------------
+
+void Xml::putInt(int val)
+      {
+      char buffer[12];
+      char* end = buffer + sizeof(buffer);
+      char* p   = end;
+      uint v    = val < 0 ? 0u - uint(val) : uint(val);
+      do {
+            *--p = '0' + v % 10;
+            v /= 10;
+            } while (v);
+      if (val < 0)
+            *--p = '-';
+      _buffer.append(p, int(end - p));
+      }
+
+//---------------------------------------------------------
+//   putDouble
+//    same format as QTextStream and QString::arg():
+//    %g with 6 significant digits
+//---------------------------------------------------------
+
+void Xml::putDouble(double val)
+      {
+      if (val > -1e6 && val < 1e6 && val == double(int(val)) && !(val == 0.0 && std::signbit(val)))
+            putInt(int(val));
+      else
+            _buffer.append(QByteArray::number(val, 'g', 6));
+      }
+
+//---------------------------------------------------------
+//   putAttribute
+//    name="val"
+//---------------------------------------------------------
+
+void Xml::putAttribute(const char* name, int val)
+      {
+      put(' ');
+      put(name);
+      put("=\"");
+      putInt(val);
+      put('"');
+      }
+
+void Xml::putAttribute(const char* name, double val)
+      {
+      put(' ');
+      put(name);
+      put("=\"");
+      putDouble(val);
+      put('"');
       }
 
 //---------------------------------------------------------
@@ -292,7 +494,11 @@ PlaceText readPlacement(XmlReader& e)
 
 void Xml::fTag(const char* name, const Fraction& f)
       {
-      tagE(QString("%1 z=\"%2\" n=\"%3\"").arg(name).arg(f.numerator()).arg(f.denominator()));
+      beginTag(name);
+      putAttribute("z", f.numerator());
+      putAttribute("n", f.denominator());
+      put("/>");
+      endLine();
       }
 
 //---------------------------------------------------------
@@ -301,9 +507,85 @@ void Xml::fTag(const char* name, const Fraction& f)
 
 void Xml::putLevel()
       {
-      int level = stack.size();
-      for (int i = 0; i < level * 2; ++i)
-            *this << ' ';
+      static const char indentation[] = "                                                                ";
+      static const int maxIndentation = sizeof(indentation) - 1;
+
+      int n = _stack.size() * 2;
+      for (; n > maxIndentation; n -= maxIndentation)
+            _buffer.append(indentation, maxIndentation);
+      _buffer.append(indentation, n);
+      }
+
+//---------------------------------------------------------
+//   beginTag
+//    <name
+//    returns the buffer position of name
+//---------------------------------------------------------
+
+int Xml::beginTag(const char* name)
+      {
+      putLevel();
+      put('<');
+      int start = _buffer.size();
+      put(name);
+      return start;
+      }
+
+int Xml::beginTag(const QString& name)
+      {
+      putLevel();
+      put('<');
+      int start = _buffer.size();
+      put(name);
+      return start;
+      }
+
+//---------------------------------------------------------
+//   nameLength
+//    length of the tag name at buffer position start,
+//    without attributes
+//---------------------------------------------------------
+
+int Xml::nameLength(int start) const
+      {
+      const char* name = _buffer.constData() + start;
+      const char* end  = _buffer.constData() + _buffer.size();
+      const char* p    = name;
+      while (p < end && *p != ' ' && *p != '>')
+            ++p;
+      return int(p - name);
+      }
+
+//---------------------------------------------------------
+//   openTag
+//    push tag name at buffer position start
+//    >
+//---------------------------------------------------------
+
+void Xml::openTag(int start)
+      {
+      _stack.append(_names.size());
+      _names.append(_buffer.constData() + start, nameLength(start));
+      put('>');
+      endLine();
+      }
+
+//---------------------------------------------------------
+//   endTag
+//    repeat the tag name at buffer position start
+//    </name>
+//---------------------------------------------------------
+
+void Xml::endTag(int start)
+      {
+      int n = nameLength(start);
+      // make sure appending does not reallocate the name
+      _buffer.reserve(_buffer.size() + n + 8);
+      const char* name = _buffer.constData() + start;
+      _buffer.append("</", 2);
+      _buffer.append(name, n);
+      _buffer.append('>');
+      endLine();
       }
 
 //---------------------------------------------------------
@@ -312,7 +594,7 @@ void Xml::putLevel()
 
 void Xml::header()
       {
-      *this << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+      put("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
       }
 
 //---------------------------------------------------------
@@ -320,11 +602,14 @@ void Xml::header()
 //    <mops attribute="value">
 //---------------------------------------------------------
 
+void Xml::stag(const char* s)
+      {
+      openTag(beginTag(s));
+      }
+
 void Xml::stag(const QString& s)
       {
-      putLevel();
-      *this << '<' << s << '>' << endl;
-      stack.append(s.split(' ')[0]);
+      openTag(beginTag(s));
       }
 
 //---------------------------------------------------------
@@ -335,7 +620,12 @@ void Xml::stag(const QString& s)
 void Xml::etag()
       {
       putLevel();
-      *this << "</" << stack.takeLast() << '>' << endl;
+      int start = _stack.takeLast();
+      put("</");
+      _buffer.append(_names.constData() + start, _names.size() - start);
+      _names.truncate(start);
+      put('>');
+      endLine();
       }
 
 //---------------------------------------------------------
@@ -348,12 +638,13 @@ void Xml::tagE(const char* format, ...)
       va_list args;
       va_start(args, format);
       putLevel();
-      *this << '<';
+      put('<');
       char buffer[BS];
       vsnprintf(buffer, BS, format, args);
-      *this << buffer;
+      put(buffer);
       va_end(args);
-      *this << "/>" << endl;
+      put("/>");
+      endLine();
       }
 
 //---------------------------------------------------------
@@ -363,7 +654,10 @@ void Xml::tagE(const char* format, ...)
 void Xml::tagE(const QString& s)
       {
       putLevel();
-      *this << '<' << s << "/>\n";
+      put('<');
+      put(s);
+      put("/>");
+      endLine();
       }
 
 //---------------------------------------------------------
@@ -374,7 +668,9 @@ void Xml::tagE(const QString& s)
 void Xml::ntag(const char* name)
       {
       putLevel();
-      *this << "<" << name << ">";
+      put('<');
+      put(name);
+      put('>');
       }
 
 //---------------------------------------------------------
@@ -384,7 +680,10 @@ void Xml::ntag(const char* name)
 
 void Xml::netag(const char* s)
       {
-      *this << "</" << s << '>' << endl;
+      put("</");
+      put(s);
+      put('>');
+      endLine();
       }
 
 //---------------------------------------------------------
@@ -410,12 +709,12 @@ void Xml::tag(P_ID id, QVariant data, QVariant defaultData)
             case P_TYPE::POINT:
             case P_TYPE::SIZE:
             case P_TYPE::COLOR:
-                  tag(name, data);
+                  putVariant(beginTag(name), data);
                   break;
             case P_TYPE::ORNAMENT_STYLE:
                   switch ( MScore::OrnamentStyle(data.toInt())) {
                         case MScore::OrnamentStyle::BAROQUE:
-                              tag(name, QVariant("baroque"));
+                              tag(name, "baroque");
                               break;
                         default:
                              // tag(name, QVariant("default"));
@@ -425,13 +724,13 @@ void Xml::tag(P_ID id, QVariant data, QVariant defaultData)
             case P_TYPE::GLISSANDO_STYLE:
                   switch ( MScore::GlissandoStyle(data.toInt())) {
                         case MScore::GlissandoStyle::BLACK_KEYS:
-                              tag(name, QVariant("blackkeys"));
+                              tag(name, "blackkeys");
                               break;
                         case MScore::GlissandoStyle::WHITE_KEYS:
-                              tag(name, QVariant("whitekeys"));
+                              tag(name, "whitekeys");
                               break;
                         case MScore::GlissandoStyle::DIATONIC:
-                              tag(name, QVariant("diatonic"));
+                              tag(name, "diatonic");
                               break;
                         default:
                              //tag(name, QVariant("Chromatic"));
@@ -441,10 +740,10 @@ void Xml::tag(P_ID id, QVariant data, QVariant defaultData)
             case P_TYPE::DIRECTION:
                   switch(MScore::Direction(data.toInt())) {
                         case MScore::Direction::UP:
-                              tag(name, QVariant("up"));
+                              tag(name, "up");
                               break;
                         case MScore::Direction::DOWN:
-                              tag(name, QVariant("down"));
+                              tag(name, "down");
                               break;
                         case MScore::Direction::AUTO:
                               break;
@@ -453,10 +752,10 @@ void Xml::tag(P_ID id, QVariant data, QVariant defaultData)
             case P_TYPE::DIRECTION_H:
                   switch(MScore::DirectionH(data.toInt())) {
                         case MScore::DirectionH::LEFT:
-                              tag(name, QVariant("left"));
+                              tag(name, "left");
                               break;
                         case MScore::DirectionH::RIGHT:
-                              tag(name, QVariant("right"));
+                              tag(name, "right");
                               break;
                         case MScore::DirectionH::AUTO:
                               break;
@@ -465,33 +764,33 @@ void Xml::tag(P_ID id, QVariant data, QVariant defaultData)
             case P_TYPE::LAYOUT_BREAK:
                   switch(LayoutBreak::Type(data.toInt())) {
                         case LayoutBreak::Type::LINE:
-                              tag(name, QVariant("line"));
+                              tag(name, "line");
                               break;
                         case LayoutBreak::Type::PAGE:
-                              tag(name, QVariant("page"));
+                              tag(name, "page");
                               break;
                         case LayoutBreak::Type::SECTION:
-                              tag(name, QVariant("section"));
+                              tag(name, "section");
                               break;
                         }
                   break;
             case P_TYPE::VALUE_TYPE:
                   switch(Note::ValueType(data.toInt())) {
                         case Note::ValueType::OFFSET_VAL:
-                              tag(name, QVariant("offset"));
+                              tag(name, "offset");
                               break;
                         case Note::ValueType::USER_VAL:
-                              tag(name, QVariant("user"));
+                              tag(name, "user");
                               break;
                         }
                   break;
             case P_TYPE::PLACEMENT:
                   switch(Element::Placement(data.toInt())) {
                         case Element::Placement::ABOVE:
-                              tag(name, QVariant("above"));
+                              tag(name, "above");
                               break;
                         case Element::Placement::BELOW:
-                              tag(name, QVariant("below"));
+                              tag(name, "below");
                               break;
                         }
                   break;
@@ -511,67 +810,127 @@ void Xml::tag(P_ID id, QVariant data, QVariant defaultData)
 void Xml::tag(const char* name, QVariant data, QVariant defaultData)
       {
       if (data != defaultData)
-            tag(QString(name), data);
+            putVariant(beginTag(name), data);
       }
 
 void Xml::tag(const QString& name, QVariant data)
       {
-      QString ename(name.split(' ')[0]);
+      putVariant(beginTag(name), data);
+      }
+
+void Xml::tag(const char* name, int val)
+      {
+      int start = beginTag(name);
+      put('>');
+      putInt(val);
+      endTag(start);
+      }
 
-      putLevel();
+void Xml::tag(const char* name, double val)
+      {
+      int start = beginTag(name);
+      put('>');
+      putDouble(val);
+      endTag(start);
+      }
+
+void Xml::tag(const char* name, const char* s)
+      {
+      int start = beginTag(name);
+      put('>');
+      putEscaped(s);
+      endTag(start);
+      }
+
+void Xml::tag(const char* name, const QString& s)
+      {
+      int start = beginTag(name);
+      put('>');
+      putEscaped(s);
+      endTag(start);
+      }
+
+//---------------------------------------------------------
+//   putVariant
+//    write value of a tag opened with beginTag()
+//---------------------------------------------------------
+
+void Xml::putVariant(int start, const QVariant& data)
+      {
       switch(data.type()) {
             case QVariant::Bool:
             case QVariant::Char:
             case QVariant::Int:
             case QVariant::UInt:
-                  *this << "<" << name << ">";
-                  *this << data.toInt();
-                  *this << "</" << ename << ">\n";
+                  put('>');
+                  putInt(data.toInt());
+                  endTag(start);
                   break;
             case QVariant::Double:
-                  *this << "<" << name << ">";
-                  *this << data.value<double>();
-                  *this << "</" << ename << ">\n";
+                  put('>');
+                  putDouble(data.value<double>());
+                  endTag(start);
                   break;
             case QVariant::String:
-                  *this << "<" << name << ">";
-                  *this << xmlString(data.value<QString>());
-                  *this << "</" << ename << ">\n";
+                  put('>');
+                  putEscaped(data.value<QString>());
+                  endTag(start);
                   break;
             case QVariant::Color:
                   {
                   QColor color(data.value<QColor>());
-                  *this << QString("<%1 r=\"%2\" g=\"%3\" b=\"%4\" a=\"%5\"/>\n")
-                     .arg(name).arg(color.red()).arg(color.green()).arg(color.blue()).arg(color.alpha());
+                  putAttribute("r", color.red());
+                  putAttribute("g", color.green());
+                  putAttribute("b", color.blue());
+                  putAttribute("a", color.alpha());
+                  put("/>");
+                  endLine();
                   }
                   break;
             case QVariant::Rect:
                   {
                   QRect r(data.value<QRect>());
-                  *this << QString("<%1 x=\"%2\" y=\"%3\" w=\"%4\" h=\"%5\"/>\n").arg(name).arg(r.x()).arg(r.y()).arg(r.width()).arg(r.height());
+                  putAttribute("x", r.x());
+                  putAttribute("y", r.y());
+                  putAttribute("w", r.width());
+                  putAttribute("h", r.height());
+                  put("/>");
+                  endLine();
                   }
                   break;
             case QVariant::RectF:
                   {
                   QRectF r(data.value<QRectF>());
-                  *this << QString("<%1 x=\"%2\" y=\"%3\" w=\"%4\" h=\"%5\"/>\n").arg(name).arg(r.x()).arg(r.y()).arg(r.width()).arg(r.height());
+                  putAttribute("x", r.x());
+                  putAttribute("y", r.y());
+                  putAttribute("w", r.width());
+                  putAttribute("h", r.height());
+                  put("/>");
+                  endLine();
                   }
                   break;
             case QVariant::PointF:
                   {
                   QPointF p(data.value<QPointF>());
-                  *this << QString("<%1 x=\"%2\" y=\"%3\"/>\n").arg(name).arg(p.x()).arg(p.y());
+                  putAttribute("x", p.x());
+                  putAttribute("y", p.y());
+                  put("/>");
+                  endLine();
                   }
                   break;
             case QVariant::SizeF:
                   {
                   QSizeF p(data.value<QSizeF>());
-                  *this << QString("<%1 w=\"%2\" h=\"%3\"/>\n").arg(name).arg(p.width()).arg(p.height());
+                  putAttribute("w", p.width());
+                  putAttribute("h", p.height());
+                  put("/>");
+                  endLine();
                   }
                   break;
             default:
                   qDebug("Xml::tag: unsupported type %d", data.type());
                   // abort();
+                  _buffer.truncate(start - 1);    // drop "<name"
                   break;
             }
       }
@@ -626,25 +985,24 @@ QString Xml::xmlString(const QString& s)
 
 void Xml::dump(int len, const unsigned char* p)
       {
+      static const char hex[] = "0123456789abcdef";
       putLevel();
       int col = 0;
-      setFieldWidth(5);
-      setNumberFlags(numberFlags() | QTextStream::ShowBase);
-      setIntegerBase(16);
       for (int i = 0; i < len; ++i, ++col) {
             if (col >= 16) {
-                  setFieldWidth(0);
-                  *this << endl;
+                  put('\n');
                   col = 0;
                   putLevel();
-                  setFieldWidth(5);
                   }
-            *this << (p[i] & 0xff);
+            // hex with "0x" prefix, right aligned in a field of width 5
+            int v = p[i] & 0xff;
+            put(v < 16 ? "  0x" : " 0x");
+            if (v >= 16)
+                  put(hex[v >> 4]);
+            put(hex[v & 0xf]);
             }
       if (col)
-            *this << endl << dec;
-      setFieldWidth(0);
-      setIntegerBase(10);
+            endLine();
       }
 
 //---------------------------------------------------------
@@ -721,16 +1079,15 @@ QString XmlReader::readXml()
 
 void Xml::writeXml(const QString& name, QString s)
       {
-      QString ename(name.split(' ')[0]);
-      putLevel();
       for (int i = 0; i < s.size(); ++i) {
             ushort c = s.at(i).unicode();
             if (c < 0x20 && c != 0x09 && c != 0x0A && c != 0x0D)
                   s[i] = '?';
             }
-      *this << "<" << name << ">";
-      *this << s;
-      *this << "</" << ename << ">\n";
+      int start = beginTag(name);
+      put('>');
+      put(s);
+      endTag(start);
       }
 
 //---------------------------------------------------------
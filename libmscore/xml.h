@@ -38,12 +38,36 @@ struct SpannerValues {
       int track2;
       };
 
+//---------------------------------------------------------
+//   XmlTag
+//    element name as returned by XmlReader::name()
+//    Compares to latin1 literals without converting them
+//    to a QString first, which QStringRef::operator==()
+//    does for every compare in the read() tag chains.
+//---------------------------------------------------------
+
+class XmlTag : public QStringRef {
+   public:
+      XmlTag(const QStringRef& s) : QStringRef(s) {}
+      bool operator==(const char* s) const {
+            const QChar* c = unicode();
+            const QChar* e = c + size();
+            for (; c != e; ++c, ++s) {
+                  if (c->unicode() != uchar(*s))      // also stops at end of s
+                        return false;
+                  }
+            return *s == 0;
+            }
+      bool operator!=(const char* s) const { return !operator==(s); }
+      };
+
 //---------------------------------------------------------
 //   XmlReader
 //---------------------------------------------------------
 
 class XmlReader : public XmlStreamReader {
       QString docName;  // used for error reporting
+      QString _text;    // reused by the read helpers
 
       // Score read context (for read optimizations):
       int _tick             { 0       };
@@ -67,10 +91,11 @@ class XmlReader : public XmlStreamReader {
       XmlReader(QIODevice* d, const QString& s = QString()) : XmlStreamReader(d), docName(s) {}
       XmlReader(const QString& d, const QString& s = QString()) : XmlStreamReader(d), docName(s) {}
 
+      XmlTag name() const { return XmlStreamReader::name(); }
       void unknown();
 
       // attribute helper routines:
-      QString attribute(const char* s) const { return attributes().value(s).toString(); }
+      QString attribute(const char* s) const { return attributes().value(QLatin1String(s)).toString(); }
       QString attribute(const char* s, const QString&) const;
       int intAttribute(const char* s) const;
       int intAttribute(const char* s, int _default) const;
@@ -79,9 +104,10 @@ class XmlReader : public XmlStreamReader {
       bool hasAttribute(const char* s) const;
 
       // helper routines based on readElementText():
-      int readInt()         { return readElementText().toInt();    }
-      int readInt(bool* ok) { return readElementText().toInt(ok);  }
-      double readDouble()   { return readElementText().toDouble(); }
+      QStringRef readText();
+      int readInt()         { return readText().toInt();    }
+      int readInt(bool* ok) { return readText().toInt(ok);  }
+      double readDouble()   { return readText().toDouble(); }
       double readDouble(double min, double max);
       bool readBool();
       QPointF readPoint();
@@ -133,17 +159,46 @@ class XmlReader : public XmlStreamReader {
 //---------------------------------------------------------
 //   Xml
 //    xml writer
+//    Output is encoded as UTF-8 into a byte buffer which is
+//    written to the device when it grows beyond FLUSH_SIZE,
+//    after every top level element and on flush().
 //---------------------------------------------------------
 
-class Xml : public QTextStream {
+class Xml {
       static const int BS = 2048;
+      static const int FLUSH_SIZE = 64 * 1024;
+
+      QIODevice* _device = 0;
+      QByteArray _buffer;           // encoded output not yet written to _device
+      QByteArray _names;            // names of open tags
+      QVector<int> _stack;          // start of open tag names in _names
 
-      QList<QString> stack;
-      void putLevel();
       QList<std::pair<int,const Spanner*>> _spanner;
       int _spannerId = 1;
       SelectionFilter _filter;
 
+      void putLevel();
+      void put(char c)                   { _buffer.append(c);       }
+      void put(const char* s)            { _buffer.append(s);       }
+      void put(const QChar*, int);
+      void put(const QString& s)         { put(s.constData(), s.size()); }
+      void putEscaped(const char*);
+      void putEscaped(const QString&);
+      void putInt(int);
+      void putDouble(double);
+      void putAttribute(const char* name, int val);
+      void putAttribute(const char* name, double val);
+      void endLine();
+
+      int nameLength(int start) const;
+      int beginTag(const char* name);
+      int beginTag(const QString& name);
+      void openTag(int start);
+      void endTag(int start);
+      void putVariant(int start, const QVariant&);
+
+      Q_DISABLE_COPY(Xml)
+
    public:
       int curTick   =  0;           // used to optimize output
       int curTrack  = -1;
@@ -163,13 +218,25 @@ class Xml : public QTextStream {
 
       Xml(QIODevice* dev);
       Xml();
+      ~Xml();
+
+      QIODevice* device() const     { return _device; }
+      void setDevice(QIODevice*);
+      void flush();
+
+      Xml& operator<<(const char* s)    { put(s);    return *this; }
+      Xml& operator<<(const QString& s) { put(s);    return *this; }
+      Xml& operator<<(char c)           { put(c);    return *this; }
+      Xml& operator<<(int val)          { putInt(val);    return *this; }
+      Xml& operator<<(double val)       { putDouble(val); return *this; }
 
-      void sTag(const char* name, Spatium sp) { Xml::tag(name, QVariant(sp.val())); }
+      void sTag(const char* name, Spatium sp) { Xml::tag(name, sp.val()); }
       void pTag(const char* name, PlaceText);
       void fTag(const char* name, const Fraction&);
 
       void header();
 
+      void stag(const char*);
       void stag(const QString&);
       void etag();
 
@@ -182,8 +249,13 @@ class Xml : public QTextStream {
       void tag(P_ID id, QVariant data, QVariant defaultData = QVariant());
       void tag(const char* name, QVariant data, QVariant defaultData = QVariant());
       void tag(const QString&, QVariant data);
-      void tag(const char* name, const char* s)    { tag(name, QVariant(s)); }
-      void tag(const char* name, const QString& s) { tag(name, QVariant(s)); }
+      void tag(const char* name, int val);
+      void tag(const char* name, int val, int defaultVal)         { if (val != defaultVal) tag(name, val); }
+      void tag(const char* name, unsigned val)                    { tag(name, int(val)); }
+      void tag(const char* name, double val);
+      void tag(const char* name, double val, double defaultVal)   { if (val != defaultVal) tag(name, val); }
+      void tag(const char* name, const char* s);
+      void tag(const char* name, const QString& s);
       void tag(const char* name, const QWidget*);
 
       void writeXml(const QString&, QString s);
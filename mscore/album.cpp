@@ -179,7 +179,7 @@ bool Album::read(const QString& p)
                   QString version = e.attribute("version");
                   QStringList sl = version.split('.');
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "Album")
                               load(e);
                         else if (tag == "programVersion")
@@ -200,12 +200,12 @@ bool Album::read(const QString& p)
 void Album::load(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "Score") {
                   AlbumItem* i = new AlbumItem;
                   i->score = 0;
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "name")
                               i->name = e.readElementText();
                         else if (tag == "path")
@@ -23,8 +23,10 @@
 #include "libmscore/score.h"
 #include "libmscore/note.h"
 #include "libmscore/part.h"
+#include "libmscore/repeatlist.h"
 #include "libmscore/mscore.h"
 #include "synthesizer/msynthesizer.h"
+#include "synthesizer/parallelrenderer.h"
 #include "musescore.h"
 #include "preferences.h"
 
@@ -32,11 +34,35 @@ namespace Ms {
 
 #ifdef HAS_AUDIOFILE
 
+//---------------------------------------------------------
+//   partFileName
+//    name of the audio file for one part: the part name is
+//    appended to the base name of the mix
+//---------------------------------------------------------
+
+static QString partFileName(const QString& name, const Part* part, QStringList* used)
+      {
+      QFileInfo fi(name);
+      QString pn = part->partName();
+      pn.replace(QRegExp("[^\\w\\-]"), "_");
+      QString base = fi.completeBaseName() + "-" + pn;
+      QString fn = fi.absolutePath() + "/" + base + "." + fi.suffix();
+      for (int i = 2; used->contains(fn); ++i)
+            fn = fi.absolutePath() + "/" + base + QString("-%1.").arg(i) + fi.suffix();
+      used->append(fn);
+      return fn;
+      }
+
 //---------------------------------------------------------
 //   saveAudio
+//    if parts is true, write one additional file for
+//    every part, rendered in the same pass as the mix.
+//    The part files hold the signal of the part before
+//    the master effects (reverb, chorus) are applied;
+//    without effects they add up to the mix.
 //---------------------------------------------------------
 
-bool MuseScore::saveAudio(Score* score, const QString& name)
+bool MuseScore::saveAudio(Score* score, const QString& name, bool parts)
       {
       int format;
       if (name.endsWith(".wav"))
@@ -54,6 +80,7 @@ bool MuseScore::saveAudio(Score* score, const QString& name)
       score->renderMidi(&events);
       if(events.size() == 0)
             return false;
+      std::shared_ptr<const TimeMap> timeMap = score->repeatList()->timeMap();
 
       MasterSynthesizer* synti = synthesizerFactory();
       synti->init();
@@ -66,17 +93,32 @@ bool MuseScore::saveAudio(Score* score, const QString& name)
       int oldSampleRate  = MScore::sampleRate;
       MScore::sampleRate = sampleRate;
 
+      // the mix, followed by one file per part
+      QStringList names;
+      names.append(name);
+      if (parts) {
+            QStringList used(name);
+            for (Part* part : score->parts())
+                  names.append(partFileName(name, part, &used));
+            }
+
       SF_INFO info;
       memset(&info, 0, sizeof(info));
       info.channels   = 2;
       info.samplerate = sampleRate;
       info.format     = format;
-      SNDFILE* sf     = sf_open(qPrintable(name), SFM_WRITE, &info);
-      if (sf == 0) {
-            qDebug("open soundfile failed: %s", sf_strerror(sf));
-            delete synti;
-            MScore::sampleRate = oldSampleRate;
-            return false;
+      std::vector<SNDFILE*> sfl;
+      for (const QString& fn : names) {
+            SNDFILE* sf = sf_open(qPrintable(fn), SFM_WRITE, &info);
+            if (sf == 0) {
+                  qDebug("open soundfile <%s> failed: %s", qPrintable(fn), sf_strerror(sf));
+                  for (SNDFILE* f : sfl)
+                        sf_close(f);
+                  delete synti;
+                  MScore::sampleRate = oldSampleRate;
+                  return false;
+                  }
+            sfl.push_back(sf);
             }
 
       QProgressDialog progress(this);
@@ -86,116 +128,220 @@ bool MuseScore::saveAudio(Score* score, const QString& name)
       if (!MScore::noGui)
             progress.show();
 
+      //
+      // The score is rendered only once, into a temporary file of raw
+      // float frames, while keeping track of the peak. Every block holds
+      // the mix followed by the parts. The file is then scaled with the
+      // normalization gain and encoded.
+      //
+      QTemporaryFile tmp;
+      bool ok = true;
+      if (!tmp.open()) {
+            qDebug("cannot create temporary file for audio export");
+            ok = false;
+            }
+
       float peak  = 0.0;
-      double gain = 1.0;
       EventMap::const_iterator endPos = events.cend();
       --endPos;
-      const int et = (score->utick2utime(endPos->first) + 1) * MScore::sampleRate;
+      const int et = (timeMap->utick2utime(endPos->first) + 1) * MScore::sampleRate;
       progress.setRange(0, et);
 
-      for (int pass = 0; pass < 2; ++pass) {
-            EventMap::const_iterator playPos;
-            playPos = events.cbegin();
-            synti->allSoundsOff(-1);
-
-            //
-            // init instruments
-            //
-            foreach(Part* part, score->parts()) {
+      //
+      // with more than one thread, the MIDI channels are distributed
+      // over several synthesizer instances rendering in parallel;
+      // for parts, every part gets its own instance. All instances
+      // are set up with the same state and share their sample data,
+      // the master effects of the first one are applied to the mix.
+      //
+      int threads = preferences.exportAudioThreads;
+      if (threads <= 0)
+            threads = QThread::idealThreadCount();
+      if (parts)
+            threads = score->parts().size();
+      std::vector<MasterSynthesizer*> instances;
+      instances.push_back(synti);
+      for (int i = 1; i < threads && ok; ++i) {
+            MasterSynthesizer* s = synthesizerFactory();
+            s->init();
+            s->setSampleRate(sampleRate);
+            if (!s->setState(score->synthesizerState()))
+                  s->init();
+            instances.push_back(s);
+            }
+      ParallelRenderer* renderer = (threads > 1 || parts) ? new ParallelRenderer(instances) : 0;
+      if (parts) {
+            renderer->setStems(true);
+            int idx = 0;
+            for (Part* part : score->parts()) {
                   const InstrumentList* il = part->instruments();
-                  for(auto i = il->begin(); i!= il->end(); i++) {
-                        foreach(const Channel* a, i->second->channel()) {
-                              a->updateInitList();
-                              foreach(MidiCoreEvent e, a->init) {
-                                    if (e.type() == ME_INVALID)
-                                          continue;
-                                    e.setChannel(a->channel);
-                                    int syntiIdx= synti->index(score->midiMapping(a->channel)->articulation->synti);
+                  for (auto i = il->begin(); i != il->end(); i++) {
+                        for (const Channel* a : i->second->channel())
+                              renderer->setGroup(a->channel, idx);
+                        }
+                  ++idx;
+                  }
+            }
+
+      EventMap::const_iterator playPos;
+      playPos = events.cbegin();
+      synti->allSoundsOff(-1);
+      if (renderer)
+            renderer->allSoundsOff(-1);
+
+      //
+      // init instruments
+      //
+      foreach(Part* part, score->parts()) {
+            const InstrumentList* il = part->instruments();
+            for(auto i = il->begin(); i!= il->end(); i++) {
+                  foreach(const Channel* a, i->second->channel()) {
+                        a->updateInitList();
+                        foreach(MidiCoreEvent e, a->init) {
+                              if (e.type() == ME_INVALID)
+                                    continue;
+                              e.setChannel(a->channel);
+                              int syntiIdx= synti->index(score->midiMapping(a->channel)->articulation->synti);
+                              if (renderer)
+                                    renderer->play(0, e, syntiIdx);
+                              else
                                     synti->play(e, syntiIdx);
-                                    }
                               }
                         }
                   }
+            }
 
-            static const unsigned FRAMES = 512;
-            float buffer[FRAMES * 2];
-            int playTime = 0;
-
-            for (;;) {
-                  unsigned frames = FRAMES;
-                  //
-                  // collect events for one segment
-                  //
-                  float max = 0.0;
-                  memset(buffer, 0, sizeof(float) * FRAMES * 2);
-                  int endTime = playTime + frames;
-                  float* p = buffer;
-                  for (; playPos != events.cend(); ++playPos) {
-                        int f = score->utick2utime(playPos->first) * MScore::sampleRate;
-                        if (f >= endTime)
-                              break;
-                        int n = f - playTime;
-                        if (n) {
-                              synti->process(n, p);
-                              p += 2 * n;
-                              }
+      static const unsigned FRAMES = 4096;
+      float buffer[FRAMES * 2];
+      int playTime = 0;
+      qint64 totalFrames = 0;
 
-                        playTime  += n;
-                        frames    -= n;
+      while (ok) {
+            unsigned frames = FRAMES;
+            //
+            // collect events for one segment
+            //
+            float max = 0.0;
+            memset(buffer, 0, sizeof(float) * FRAMES * 2);
+            int endTime = playTime + frames;
+            float* p = buffer;
+            for (; playPos != events.cend(); ++playPos) {
+                  int f = timeMap->utick2utime(playPos->first) * MScore::sampleRate;
+                  if (f >= endTime)
+                        break;
+                  if (renderer) {
+                        // queue with the offset into this block
                         const NPlayEvent& e = playPos->second;
                         if (e.isChannelEvent()) {
-                              int channelIdx = e.channel();
-                              Channel* c = score->midiMapping(channelIdx)->articulation;
-                              if (!c->mute) {
-                                    synti->play(e, synti->index(c->synti));
-                                    }
+                              Channel* c = score->midiMapping(e.channel())->articulation;
+                              if (!c->mute)
+                                    renderer->play(f - playTime, e, synti->index(c->synti));
                               }
+                        continue;
                         }
-                  if (frames) {
-                        synti->process(frames, p);
-                        playTime += frames;
+                  int n = f - playTime;
+                  if (n) {
+                        synti->process(n, p);
+                        p += 2 * n;
                         }
-                  if (pass == 1) {
-                        for (unsigned i = 0; i < FRAMES * 2; ++i) {
-                              max = qMax(max, qAbs(buffer[i]));
-                              buffer[i] *= gain;
+
+                  playTime  += n;
+                  frames    -= n;
+                  const NPlayEvent& e = playPos->second;
+                  if (e.isChannelEvent()) {
+                        int channelIdx = e.channel();
+                        Channel* c = score->midiMapping(channelIdx)->articulation;
+                        if (!c->mute) {
+                              synti->play(e, synti->index(c->synti));
                               }
-                        sf_writef_float(sf, buffer, FRAMES);
                         }
-                  else {
-                        for (unsigned i = 0; i < FRAMES * 2; ++i) {
-                              max = qMax(max, qAbs(buffer[i]));
-                              peak = qMax(peak, qAbs(buffer[i]));
-                              }
+                  }
+            if (renderer)
+                  renderer->process(FRAMES, buffer);
+            else if (frames) {
+                  synti->process(frames, p);
+                  playTime += frames;
+                  }
+            for (unsigned i = 0; i < FRAMES * 2; ++i)
+                  max = qMax(max, qAbs(buffer[i]));
+            peak = qMax(peak, max);
+            for (size_t k = 0; k < sfl.size() && ok; ++k) {
+                  const float* src = k == 0 ? buffer : renderer->stem(k - 1);
+                  if (k > 0) {
+                        // a part may peak higher than the mix
+                        for (unsigned i = 0; i < FRAMES * 2; ++i)
+                              peak = qMax(peak, qAbs(src[i]));
                         }
-                  playTime = endTime;
-                  if (!MScore::noGui) {
-                        progress.setValue((pass * et + playTime) / 2);
-                        qApp->processEvents();
+                  if (tmp.write(reinterpret_cast<const char*>(src), sizeof(buffer)) != qint64(sizeof(buffer))) {
+                        qDebug("write to temporary file failed");
+                        ok = false;
                         }
-                  if (playTime >= et)
+                  }
+            totalFrames += FRAMES;
+
+            playTime = endTime;
+            if (!MScore::noGui) {
+                  progress.setValue(playTime);
+                  qApp->processEvents();
+                  }
+            if (playTime >= et) {
+                  if (renderer)
+                        renderer->allNotesOff(-1);
+                  else
                         synti->allNotesOff(-1);
-                  // create sound until the sound decays
-                  if (playTime >= et && max*peak < 0.000001)
-                        break;
                   }
-            if (pass == 0 && peak == 0.0) {
-                  qDebug("song is empty");
+            // create sound until the sound decays
+            if (playTime >= et && max*peak < 0.000001)
                   break;
+            }
+
+      if (ok && peak == 0.0)
+            qDebug("song is empty");
+      else if (ok) {
+            // same gain for all files, so the parts keep their
+            // level relative to the mix
+            double gain = 0.99 / peak;
+            tmp.flush();
+            // read back through a memory mapping if possible
+            const float* data = reinterpret_cast<const float*>(tmp.map(0, tmp.size()));
+            if (!data)
+                  tmp.seek(0);
+            const qint64 block = FRAMES * 2 * qint64(sfl.size());
+            for (qint64 frame = 0; frame < totalFrames && ok; frame += FRAMES) {
+                  for (size_t k = 0; k < sfl.size(); ++k) {
+                        if (data)
+                              memcpy(buffer, data + frame / FRAMES * block + k * FRAMES * 2, sizeof(buffer));
+                        else if (tmp.read(reinterpret_cast<char*>(buffer), sizeof(buffer)) != qint64(sizeof(buffer))) {
+                              qDebug("read from temporary file failed");
+                              ok = false;
+                              break;
+                              }
+                        for (unsigned i = 0; i < FRAMES * 2; ++i)
+                              buffer[i] *= gain;
+                        if (sf_writef_float(sfl[k], buffer, FRAMES) != FRAMES) {
+                              qDebug("write soundfile failed: %s", sf_strerror(sfl[k]));
+                              ok = false;
+                              break;
+                              }
+                        }
                   }
-            gain = 0.99 / peak;
+            if (data)
+                  tmp.unmap(reinterpret_cast<uchar*>(const_cast<float*>(data)));
             }
 
       progress.close();
 
       MScore::sampleRate = oldSampleRate;
-      delete synti;
-      if (sf_close(sf)) {
-            qDebug("close soundfile failed");
-            return false;
+      delete renderer;
+      for (MasterSynthesizer* s : instances)
+            delete s;
+      for (SNDFILE* sf : sfl) {
+            if (sf_close(sf)) {
+                  qDebug("close soundfile failed");
+                  ok = false;
+                  }
             }
-
-      return true;
+      return ok;
       }
 
 #endif // HAS_AUDIOFILE
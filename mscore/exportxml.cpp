@@ -4324,7 +4324,6 @@ void ExportMusicXml::write(QIODevice* dev)
             }
 
       xml.setDevice(dev);
-      xml.setCodec("UTF-8");
       xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
       xml << "<!DOCTYPE score-partwise PUBLIC \"-//Recordare//DTD MusicXML 3.0 Partwise//EN\" \"http://www.musicxml.org/dtds/partwise.dtd\">\n";
       xml.stag("score-partwise");
@@ -4946,7 +4945,6 @@ bool saveMxl(Score* score, const QString& name)
       cbuf.open(QIODevice::ReadWrite);
       Xml xml;
       xml.setDevice(&cbuf);
-      xml.setCodec("UTF-8");
       xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
       xml.stag("container");
       xml.stag("rootfiles");
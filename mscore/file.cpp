@@ -73,6 +73,7 @@
 #include "synthesizer/msynthesizer.h"
 #include "svggenerator.h"
 #include "scorePreview.h"
+#include "scoreInfoCache.h"
 
 #ifdef OMR
 #include "omr/omr.h"
@@ -2640,5 +2641,18 @@ QPixmap MuseScore::extractThumbnail(const QString& name)
       return pm;
       }
 
+//---------------------------------------------------------
+//   ScoreInfoCache::instance
+//---------------------------------------------------------
+
+ScoreInfoCache* ScoreInfoCache::instance()
+      {
+      if (!inst)
+            inst = new ScoreInfoCache(dataPath + "/scoreinfo.cache", [](const QString& name) {
+                  return mscore->extractThumbnail(name);
+                  });
+      return inst;
+      }
+
 }
 
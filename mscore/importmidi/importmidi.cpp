@@ -38,6 +38,7 @@
 #include "libmscore/drumset.h"
 #include "libmscore/box.h"
 #include "libmscore/pitchspelling.h"
+#include "libmscore/profiler.h"
 #include "importmidi_meter.h"
 #include "importmidi_chord.h"
 #include "importmidi_quant.h"
@@ -204,28 +205,55 @@ void findAllTupletsForDrums(
       // note: temporary local tuplets and chords are deleted here
       }
 
+namespace MidiThreads {
+
+void forEachTrack(std::multimap<int, MTrack> &tracks,
+                  const std::function<void(MTrack &)> &f)
+      {
+      QList<MTrack *> trackList;
+      for (auto &track: tracks)
+            trackList.append(&track.second);
+
+      if (preferences.midiImportOperations.parallelTracks() && trackList.size() > 1) {
+            QtConcurrent::blockingMap(trackList, [&f](MTrack *mtrack) { f(*mtrack); });
+            }
+      else {
+            for (MTrack *mtrack: trackList)
+                  f(*mtrack);
+            }
+      }
+
+} // namespace MidiThreads
+
 void quantizeAllTracks(std::multimap<int, MTrack> &tracks,
                        TimeSigMap *sigmap,
                        const ReducedFraction &lastTick)
       {
       auto &opers = preferences.midiImportOperations;
 
-      for (auto &track: tracks) {
-            MTrack &mtrack = track.second;
-            if (mtrack.chords.empty())
-                  continue;
-                        // pass current track index through MidiImportOperations
-                        // for further usage
-            MidiOperations::CurrentTrackSetter setCurrentTrack{opers, mtrack.indexOfOperation};
-
-            if (opers.data()->processingsOfOpenedFile == 0) {
+                  // operations are shared by all tracks,
+                  // so they are changed before the parallel part
+      if (opers.data()->processingsOfOpenedFile == 0) {
+            for (auto &track: tracks) {
+                  MTrack &mtrack = track.second;
+                  if (mtrack.chords.empty())
+                        continue;
                   opers.data()->trackOpers.isDrumTrack.setValue(
-                                          opers.currentTrack(), mtrack.mtrack->drumTrack());
+                                          mtrack.indexOfOperation, mtrack.mtrack->drumTrack());
                   if (mtrack.mtrack->drumTrack()) {
                         opers.data()->trackOpers.maxVoiceCount.setValue(
-                                          opers.currentTrack(), MidiOperations::VoiceCount::V_1);
+                                          mtrack.indexOfOperation, MidiOperations::VoiceCount::V_1);
                         }
                   }
+            }
+
+      MidiThreads::forEachTrack(tracks, [&](MTrack &mtrack) {
+            if (mtrack.chords.empty())
+                  return;
+                        // pass current track index through MidiImportOperations
+                        // for further usage
+            MidiOperations::CurrentTrackSetter setCurrentTrack{opers, mtrack.indexOfOperation};
+
             const auto basicQuant = Quantize::quantValueToFraction(
                         opers.data()->trackOpers.quantValue.value(mtrack.indexOfOperation));
 
@@ -239,7 +267,7 @@ void quantizeAllTracks(std::multimap<int, MTrack> &tracks,
             else
                   MidiTuplet::findAllTuplets(mtrack.tuplets, mtrack.chords, sigmap, basicQuant);
 
-            Q_ASSERT_X(!doNotesOverlap(track.second),
+            Q_ASSERT_X(!doNotesOverlap(mtrack),
                        "quantizeAllTracks",
                        "There are overlapping notes of the same voice that is incorrect");
 
@@ -252,7 +280,7 @@ void quantizeAllTracks(std::multimap<int, MTrack> &tracks,
             Q_ASSERT_X(MidiTuplet::areTupletRangesOk(mtrack.chords, mtrack.tuplets),
                        "quantizeAllTracks", "Tuplet chord/note is outside tuplet "
                         "or non-tuplet chord/note is inside tuplet");
-            }
+            });
       }
 
 //---------------------------------------------------------
@@ -1069,9 +1097,11 @@ ReducedFraction findLastChordTick(const std::multimap<int, MTrack> &tracks)
 
 void convertMidi(Score *score, const MidiFile *mf)
       {
+      ProfilePhases phase("importMidi");
       auto *sigmap = score->sigmap();
 
       auto tracks = createMTrackList(sigmap, mf);
+      phase.elapsed("tracks");
 
       auto &opers = preferences.midiImportOperations;
       if (opers.data()->processingsOfOpenedFile == 0)         // for newly opened MIDI file
@@ -1114,12 +1144,15 @@ void convertMidi(Score *score, const MidiFile *mf)
 
       Q_ASSERT_X(!doNotesOverlap(tracks),
                  "convertMidi", "There are overlapping notes of the same voice that is incorrect");
+      phase.elapsed("chords");
 
       LRHand::splitIntoLeftRightHands(tracks);
       MidiDrum::splitDrumVoices(tracks);
       MidiDrum::splitDrumTracks(tracks);
       ReducedFraction lastTick = findLastChordTick(tracks);
+      phase.elapsed("split");
       quantizeAllTracks(tracks, sigmap, lastTick);
+      phase.elapsed("quantize");
       MChord::removeOverlappingNotes(tracks);
 
       Q_ASSERT_X(!doNotesOverlap(tracks),
@@ -1129,16 +1162,21 @@ void convertMidi(Score *score, const MidiFile *mf)
 
       MChord::mergeChordsWithEqualOnTimeAndVoice(tracks);
       Simplify::simplifyDurationsNotDrums(tracks, sigmap);
-      if (MidiVoice::separateVoices(tracks, sigmap))
+      phase.elapsed("simplify");
+      const bool voicesChanged = MidiVoice::separateVoices(tracks, sigmap);
+      phase.elapsed("voices");
+      if (voicesChanged)
             Simplify::simplifyDurationsNotDrums(tracks, sigmap);    // again
       Simplify::simplifyDurationsForDrums(tracks, sigmap);
       MChord::splitUnequalChords(tracks);
+      phase.elapsed("simplify");
                   // no more track insertion/reordering/deletion from now
       QList<MTrack> trackList = prepareTrackList(tracks);
       MidiInstr::setGrandStaffProgram(trackList);
       MidiInstr::findInstrumentsForAllTracks(trackList);
       MidiInstr::createInstruments(score, trackList);
       MidiDrum::setStaffBracketForDrums(trackList);
+      phase.elapsed("instruments");
 
       const auto firstTick = findFirstChordTick(trackList);
 
@@ -1153,10 +1191,12 @@ void convertMidi(Score *score, const MidiFile *mf)
       createClefs(trackList);
       createTimeSignatures(score);
       score->connectTies();
+      phase.elapsed("score");
 
       MidiLyrics::setLyricsToScore(trackList);
       MidiTempo::setTempo(tracks, score);
       MidiChordName::setChordNames(trackList);
+      phase.elapsed("meta");
       }
 
 void loadMidiData(MidiFile &mf)
@@ -6,6 +6,8 @@
 #include "importmidi_operation.h"
 
 #include <vector>
+#include <map>
+#include <functional>
 #include <cstddef>
 #include <utility>
 
@@ -104,6 +106,16 @@ class MTrack {
       void updateTuplet(std::multimap<ReducedFraction, MidiTuplet::TupletData>::iterator &);
       };
 
+namespace MidiThreads {
+
+            // call f for every track; tracks are processed concurrently
+            // if MIDI import operations allow it, so f should change
+            // only the given track and the result doesn't depend on the order
+void forEachTrack(std::multimap<int, MTrack> &tracks,
+                  const std::function<void(MTrack &)> &f);
+
+} // namespace MidiThreads
+
 namespace MidiTuplet {
 
 struct TupletInfo
@@ -270,11 +270,56 @@ bool Data::hasMidiFile(const QString &fileName)
 
 int Data::currentTrack() const
       {
+      const int currentTrack = threadCurrentTrack();
 
-      Q_ASSERT_X(_currentTrack >= 0,
+      Q_ASSERT_X(currentTrack >= 0,
                  "Data::currentTrack", "Invalid current track index");
 
-      return _currentTrack;
+      return currentTrack;
+      }
+
+static QThreadStorage<int> currentTrackStorage;
+
+int Data::threadCurrentTrack()
+      {
+      if (!currentTrackStorage.hasLocalData())
+            return -1;
+      return currentTrackStorage.localData();
+      }
+
+void Data::setThreadCurrentTrack(int track)
+      {
+      currentTrackStorage.setLocalData(track);
+      }
+
+TupletSearchStats Data::tupletSearchStats() const
+      {
+      TupletSearchStats stats;
+      stats.searches = _tupletSearches.load();
+      stats.stopped = _tupletSearchesStopped.load();
+      stats.greedy = _tupletSearchesGreedy.load();
+      stats.maxSteps = _tupletSearchMaxStepsUsed.load();
+      return stats;
+      }
+
+void Data::resetTupletSearchStats()
+      {
+      _tupletSearches.store(0);
+      _tupletSearchesStopped.store(0);
+      _tupletSearchesGreedy.store(0);
+      _tupletSearchMaxStepsUsed.store(0);
+      }
+
+void Data::addTupletSearch(int steps, bool isStopped, bool isGreedy)
+      {
+      _tupletSearches.fetchAndAddOrdered(1);
+      if (isStopped)
+            _tupletSearchesStopped.fetchAndAddOrdered(1);
+      if (isGreedy)
+            _tupletSearchesGreedy.fetchAndAddOrdered(1);
+      int maxSteps = _tupletSearchMaxStepsUsed.load();
+      while (steps > maxSteps && !_tupletSearchMaxStepsUsed.testAndSetOrdered(maxSteps, steps))
+            maxSteps = _tupletSearchMaxStepsUsed.load();
       }
 
 void Data::setOperationsFile(const QString &fileName)
@@ -201,6 +201,15 @@ struct FileData
       HumanBeatData humanBeatData;
       };
 
+struct TupletSearchStats
+      {
+      int searches = 0;       // searched bars
+      int stopped = 0;        // searches stopped by a limit
+      int greedy = 0;         // stopped searches that used the greedy selection
+                              // because no complete selection was rated
+      int maxSteps = 0;       // most steps of one search
+      };
+
 class Data
       {
    public:
@@ -215,14 +224,42 @@ class Data
       const MidiFile* midiFile(const QString &fileName);
       QStringList allMidiFiles() const;
       void setOperationsFile(const QString &fileName);
+                  // process independent tracks on the global thread pool
+      bool parallelTracks() const { return _parallelTracks; }
+      void setParallelTracks(bool value) { _parallelTracks = value; }
+                  // limits of the tuplet selection search in one bar:
+                  // visited selections and time in ms (0 - no limit);
+                  // when a limit is reached the best selection found so far is used.
+                  // The step limit keeps the result independent of the machine,
+                  // the time limit is off by default and only a safety net
+      int tupletSearchMaxSteps() const { return _tupletSearchMaxSteps; }
+      void setTupletSearchMaxSteps(int value) { _tupletSearchMaxSteps = value; }
+      int tupletSearchMaxTime() const { return _tupletSearchMaxTime; }
+      void setTupletSearchMaxTime(int value) { _tupletSearchMaxTime = value; }
+                  // counters of the tuplet selection searches since the last reset
+      TupletSearchStats tupletSearchStats() const;
+      void resetTupletSearchStats();
+      void addTupletSearch(int steps, bool isStopped, bool isGreedy);
 
    private:
       friend class CurrentTrackSetter;
       friend class CurrentMidiFileSetter;
 
+                  // current track is stored per thread
+                  // because tracks can be processed in parallel
+      static int threadCurrentTrack();
+      static void setThreadCurrentTrack(int track);
+
       QString _currentMidiFile;
       QString _midiOperationsFile;
-      int _currentTrack = -1;
+      bool _parallelTracks = true;
+      int _tupletSearchMaxSteps = 100000;
+      int _tupletSearchMaxTime = 0;
+                  // tracks are processed in parallel
+      QAtomicInt _tupletSearches;
+      QAtomicInt _tupletSearchesStopped;
+      QAtomicInt _tupletSearchesGreedy;
+      QAtomicInt _tupletSearchMaxStepsUsed;
 
       std::map<QString, FileData> _data;    // <file name, tracks data>
       };
@@ -231,19 +268,17 @@ class Data
 class CurrentTrackSetter
       {
    public:
-      CurrentTrackSetter(Data &opers, int track)
-            : _opers(opers)
+      CurrentTrackSetter(Data &, int track)
             {
-            _oldValue = _opers._currentTrack;
-            _opers._currentTrack = track;
+            _oldValue = Data::threadCurrentTrack();
+            Data::setThreadCurrentTrack(track);
             }
 
       ~CurrentTrackSetter()
             {
-            _opers._currentTrack = _oldValue;
+            Data::setThreadCurrentTrack(_oldValue);
             }
    private:
-      Data &_opers;
       int _oldValue;
                   // disallow heap allocation - for stack-only usage
       void* operator new(size_t);               // standard new
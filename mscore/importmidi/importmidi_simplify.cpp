@@ -280,13 +280,12 @@ void simplifyDurations(
       {
       auto &opers = preferences.midiImportOperations;
 
-      for (auto &track: tracks) {
-            MTrack &mtrack = track.second;
+      MidiThreads::forEachTrack(tracks, [&](MTrack &mtrack) {
             if (mtrack.mtrack->drumTrack() != simplifyDrumTracks)
-                  continue;
-            auto &chords = track.second.chords;
+                  return;
+            auto &chords = mtrack.chords;
             if (chords.empty())
-                  continue;
+                  return;
 
             if (opers.data()->trackOpers.simplifyDurations.value(mtrack.indexOfOperation)) {
                   MidiOperations::CurrentTrackSetter setCurrentTrack{opers, mtrack.indexOfOperation};
@@ -303,7 +302,7 @@ void simplifyDurations(
                              "Simplify::simplifyDurations", "Tuplet chord/note is outside tuplet "
                              "or non-tuplet chord/note is inside tuplet after simplification");
                   }
-            }
+            });
       }
 
 void simplifyDurationsForDrums(std::multimap<int, MTrack> &tracks, const TimeSigMap *sigmap)
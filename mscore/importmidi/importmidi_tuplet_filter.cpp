@@ -4,7 +4,9 @@
 #include "importmidi_chord.h"
 #include "importmidi_quant.h"
 #include "importmidi_inner.h"
+#include "importmidi_operations.h"
 #include "libmscore/mscore.h"
+#include "mscore/preferences.h"
 
 #include <set>
 
@@ -229,17 +231,52 @@ bool isInCommonIndexes(
       return false;
       }
 
+// chords of all tuplets of the bar numbered from 0 and their quant errors;
+// computed once instead of for every tested tuplet selection
+
+class TupletChords
+      {
+   public:
+      TupletChords(const std::vector<TupletInfo> &tuplets, const ReducedFraction &basicQuant)
+            : chordIndexes_(tuplets.size())
+            {
+            std::map<std::pair<const ReducedFraction, MidiChord> *, int> indexes;
+            for (size_t i = 0; i != tuplets.size(); ++i) {
+                  for (const auto &chord: tuplets[i].chords) {
+                        const auto it = indexes.find(&*chord.second);
+                        if (it != indexes.end()) {
+                              chordIndexes_[i].push_back(it->second);
+                              continue;
+                              }
+                        const int index = quantErrors_.size();
+                        indexes.insert({&*chord.second, index});
+                        chordIndexes_[i].push_back(index);
+                        quantErrors_.push_back(
+                                    Quantize::findOnTimeQuantError(*chord.second, basicQuant));
+                        }
+                  }
+            }
+
+      int chordCount() const { return quantErrors_.size(); }
+      const std::vector<int>& chordIndexes(int tupletIndex) const { return chordIndexes_[tupletIndex]; }
+      const ReducedFraction& quantError(int chordIndex) const { return quantErrors_[chordIndex]; }
+
+   private:
+      std::vector<std::vector<int>> chordIndexes_;     // chords of each tuplet
+      std::vector<ReducedFraction> quantErrors_;
+      };
+
 TupletErrorResult findTupletError(
             const std::vector<int> &tupletIndexes,
             const std::vector<TupletInfo> &tuplets,
             size_t voiceCount,
-            const ReducedFraction &basicQuant)
+            const TupletChords &tupletChords)
       {
       ReducedFraction sumError{0, 1};
       ReducedFraction sumLengthOfRests{0, 1};
       int sumChordCount = 0;
       int sumChordPlaces = 0;
-      std::set<std::pair<const ReducedFraction, MidiChord> *> usedChords;
+      std::vector<char> usedChords(tupletChords.chordCount(), 0);
       std::vector<char> usedIndexes(tuplets.size(), 0);
 
       for (int i: tupletIndexes) {
@@ -251,18 +288,17 @@ TupletErrorResult findTupletError(
             sumChordPlaces += tuplet.tupletNumber;
 
             usedIndexes[i] = 1;
-            for (const auto &chord: tuplet.chords)
-                  usedChords.insert(&*chord.second);
+            for (int chordIndex: tupletChords.chordIndexes(i))
+                  usedChords[chordIndex] = 1;
             }
                   // add quant error of all chords excluded from tuplets
       for (size_t i = 0; i != tuplets.size(); ++i) {
             if (usedIndexes[i])
                   continue;
-            const auto &tuplet = tuplets[i];
-            for (const auto &chord: tuplet.chords) {
-                  if (usedChords.find(&*chord.second) != usedChords.end())
+            for (int chordIndex: tupletChords.chordIndexes(i)) {
+                  if (usedChords[chordIndex])
                         continue;
-                  sumError += Quantize::findOnTimeQuantError(*chord.second, basicQuant);
+                  sumError += tupletChords.quantError(chordIndex);
                   }
             }
 
@@ -435,11 +471,11 @@ void tryUpdateBestIndexes(
             const std::vector<int> &selectedTuplets,
             const std::vector<TupletInfo> &tuplets,
             const std::map<int, std::vector<std::pair<ReducedFraction, ReducedFraction>>> &voiceIntervals,
-            const ReducedFraction &basicQuant)
+            const TupletChords &tupletChords)
       {
       const size_t voiceCount = voiceIntervals.size();
       const auto error = findTupletError(selectedTuplets, tuplets,
-                                         voiceCount, basicQuant);
+                                         voiceCount, tupletChords);
       if (!minCurrentError.isInitialized() || error < minCurrentError) {
             minCurrentError = error;
             bestTupletIndexes = selectedTuplets;
@@ -528,6 +564,48 @@ class ValidTuplets
       int first_;
       };
 
+// the number of tuplet selections grows exponentially with the number
+// of overlapping tuplets, so the search is stopped after the given number
+// of steps or milliseconds (0 - no limit); only the step limit gives
+// the same result on every machine
+
+class SearchLimit
+      {
+   public:
+      SearchLimit(int maxSteps, int maxTime)
+            : maxSteps_(maxSteps)
+            , maxTime_(maxTime)
+            , steps_(0)
+            , isReached_(false)
+            {
+            if (maxTime_ > 0)
+                  timer_.start();
+            }
+
+      bool nextStep()
+            {
+            if (isReached_)
+                  return false;
+            ++steps_;
+            if (maxSteps_ > 0 && steps_ > maxSteps_)
+                  isReached_ = true;
+                        // don't ask the clock at every step
+            else if (maxTime_ > 0 && (steps_ & 0xff) == 0 && timer_.elapsed() > maxTime_)
+                  isReached_ = true;
+            return !isReached_;
+            }
+
+      bool isReached() const { return isReached_; }
+      int steps() const { return steps_; }
+
+   private:
+      int maxSteps_;
+      int maxTime_;
+      int steps_;
+      bool isReached_;
+      QElapsedTimer timer_;
+      };
+
 
 void findNextTuplet(
             std::vector<int> &selectedTuplets,
@@ -538,9 +616,12 @@ void findNextTuplet(
             const std::vector<TupletInfo> &tuplets,
             const std::vector<std::pair<ReducedFraction, ReducedFraction> > &tupletIntervals,
             size_t commonsSize,
-            const ReducedFraction &basicQuant)
+            const TupletChords &tupletChords,
+            SearchLimit &searchLimit)
       {
       while (!validTuplets.empty()) {
+            if (!searchLimit.nextStep())
+                  return;
             size_t index = validTuplets.first();
 
             bool isCommonGroupBegins = (selectedTuplets.empty() && index == commonsSize);
@@ -575,7 +656,7 @@ void findNextTuplet(
                         }
                   if (!canAddMoreIndexes) {
                         tryUpdateBestIndexes(bestTupletIndexes, minCurrentError,
-                                             selectedTuplets, tuplets, voiceIntervals, basicQuant);
+                                             selectedTuplets, tuplets, voiceIntervals, tupletChords);
                         }
                   return;
                   }
@@ -611,12 +692,13 @@ void findNextTuplet(
                         }
                   if (!canAddMoreIndexes) {
                         tryUpdateBestIndexes(bestTupletIndexes, minCurrentError,
-                                             selectedTuplets, tuplets, voiceIntervals, basicQuant);
+                                             selectedTuplets, tuplets, voiceIntervals, tupletChords);
                         }
                   }
             else {
                   findNextTuplet(selectedTuplets, validTuplets, bestTupletIndexes, minCurrentError,
-                                 tupletCommons, tuplets, tupletIntervals, commonsSize, basicQuant);
+                                 tupletCommons, tuplets, tupletIntervals, commonsSize,
+                                 tupletChords, searchLimit);
                   }
 
             selectedTuplets.pop_back();
@@ -641,6 +723,46 @@ void moveUncommonTupletsToEnd(std::vector<TupletInfo> &tuplets, std::set<int> &u
                  "Untested uncommon tuplets remaining");
       }
 
+TupletErrorResult findSingleTupletError(const TupletInfo &tuplet)
+      {
+      return TupletErrorResult{
+                  tuplet.tupletSumError.numerator() * 1.0
+                        / (tuplet.tupletSumError.denominator() * tuplet.chords.size()),
+                  tuplet.chords.size() * 1.0 / tuplet.tupletNumber,
+                  tuplet.sumLengthOfRests,
+                  1,
+                  1
+            };
+      }
+
+// fallback if the search was stopped before any complete selection:
+// take the tuplets in the order of their own errors
+// while they are compatible with the already taken ones
+
+std::vector<int> findGreedyTuplets(
+            const std::vector<TupletCommon> &tupletCommons,
+            const std::vector<TupletInfo> &tuplets,
+            const std::vector<std::pair<ReducedFraction, ReducedFraction> > &tupletIntervals)
+      {
+      std::multimap<TupletErrorResult, int> errors;
+      for (int i = 0; i != (int)tuplets.size(); ++i)
+            errors.insert({findSingleTupletError(tuplets[i]), i});
+
+      std::vector<int> selectedTuplets;
+      for (const auto &e: errors) {
+            const int i = e.second;
+            if (isInCommonIndexes(i, selectedTuplets, tupletCommons))
+                  continue;
+            const auto voiceIntervals = prepareVoiceIntervals(selectedTuplets, tupletIntervals);
+            const auto usedFirstChords = prepareUsedFirstChords(selectedTuplets, tuplets);
+            if (!canUseIndex(i, tuplets, tupletIntervals, voiceIntervals, usedFirstChords))
+                  continue;
+            selectedTuplets.push_back(i);
+            }
+      std::sort(selectedTuplets.begin(), selectedTuplets.end());
+      return selectedTuplets;
+      }
+
 std::vector<int> findBestTuplets(
             const std::vector<TupletCommon> &tupletCommons,
             const std::vector<TupletInfo> &tuplets,
@@ -651,11 +773,23 @@ std::vector<int> findBestTuplets(
       std::vector<int> selectedTuplets;
       TupletErrorResult minCurrentError;
       const auto tupletIntervals = findTupletIntervals(tuplets, basicQuant);
+      const TupletChords tupletChords(tuplets, basicQuant);
 
+      auto &opers = preferences.midiImportOperations;
+      SearchLimit searchLimit(opers.tupletSearchMaxSteps(), opers.tupletSearchMaxTime());
       ValidTuplets validTuplets(tuplets.size());
 
       findNextTuplet(selectedTuplets, validTuplets, bestTupletIndexes, minCurrentError,
-                     tupletCommons, tuplets, tupletIntervals, commonsSize, basicQuant);
+                     tupletCommons, tuplets, tupletIntervals, commonsSize,
+                     tupletChords, searchLimit);
+
+      bool isGreedy = false;
+      if (searchLimit.isReached() && bestTupletIndexes.empty()) {
+            bestTupletIndexes = findGreedyTuplets(tupletCommons, tuplets, tupletIntervals);
+            isGreedy = true;
+            }
+      // stopped searches are counted in the import statistics
+      opers.addTupletSearch(searchLimit.steps(), searchLimit.isReached(), isGreedy);
 
       return bestTupletIndexes;
       }
@@ -668,17 +802,8 @@ void removeExtraTuplets(std::vector<TupletInfo> &tuplets)
             return;
 
       std::map<TupletErrorResult, size_t> errors;
-      for (size_t i = 0; i != tuplets.size(); ++i) {
-            auto tupletError = TupletErrorResult{
-                        tuplets[i].tupletSumError.numerator() * 1.0
-                              / (tuplets[i].tupletSumError.denominator() * tuplets[i].chords.size()),
-                        tuplets[i].chords.size() * 1.0 / tuplets[i].tupletNumber,
-                        tuplets[i].sumLengthOfRests,
-                        1,
-                        1
-                  };
-            errors.insert({tupletError, i});
-            }
+      for (size_t i = 0; i != tuplets.size(); ++i)
+            errors.insert({findSingleTupletError(tuplets[i]), i});
       std::vector<TupletInfo> newTuplets;
       size_t count = 0;
       for (const auto &e: errors) {
@@ -10,6 +10,8 @@
 #include "mscore/preferences.h"
 #include "libmscore/durationtype.h"
 
+#include <atomic>
+
 
 namespace Ms {
 namespace MidiVoice {
@@ -998,15 +1000,14 @@ void sortVoices(
 bool separateVoices(std::multimap<int, MTrack> &tracks, const TimeSigMap *sigmap)
       {
       auto &opers = preferences.midiImportOperations;
-      bool changed = false;
+      std::atomic<bool> changed(false);
 
-      for (auto &track: tracks) {
-            MTrack &mtrack = track.second;
+      MidiThreads::forEachTrack(tracks, [&](MTrack &mtrack) {
             if (mtrack.mtrack->drumTrack())
-                  continue;
-            auto &chords = track.second.chords;
+                  return;
+            auto &chords = mtrack.chords;
             if (chords.empty())
-                  continue;
+                  return;
             const int userVoiceCount = toIntVoiceCount(
                         opers.data()->trackOpers.maxVoiceCount.value(mtrack.indexOfOperation));
                         // pass current track index through MidiImportOperations
@@ -1044,7 +1045,7 @@ bool separateVoices(std::multimap<int, MTrack> &tracks, const TimeSigMap *sigmap
                              "MidiVoice::separateVoices", "Different voices of chord and tuplet "
                              "after voice sort");
                   }
-            }
+            });
 
       return changed;
       }
@@ -688,7 +688,8 @@ void JackAudio::checkTransportSeek(int cur_frame, int nframes, bool inCountIn)
                   if (60 * seq->curTempo() == 0.0)
                         return;
                   qreal newRelTempo = pos.beats_per_minute / (60* seq->curTempo());
-                  seq->setRelTempo(newRelTempo);
+                  // the time map is rebuilt in the gui thread
+                  QMetaObject::invokeMethod(seq, "setRelTempo", Qt::QueuedConnection, Q_ARG(double, newRelTempo));
                   // Update UI
                   if (mscore->getPlayPanel()) {
                         mscore->getPlayPanel()->setRelTempo(newRelTempo);
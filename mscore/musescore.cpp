@@ -90,6 +90,7 @@
 #include "libmscore/volta.h"
 #include "libmscore/lasso.h"
 #include "libmscore/excerpt.h"
+#include "libmscore/profiler.h"
 
 #include "driver.h"
 
@@ -140,6 +141,8 @@ static QString outFileName;
 static QString audioDriver;
 static QString pluginName;
 static QString styleFile;
+static QString profileFileName;
+static QString jobFileName;
 static bool scoresOnCommandline { false };
 
 QString localeName;
@@ -2027,6 +2030,245 @@ static void loadScores(const QStringList& argv)
       mscore->setCurrentView(1, currentScoreView);
       }
 
+//---------------------------------------------------------
+//   writeProfile
+//    write the timings collected in converter mode
+//---------------------------------------------------------
+
+static void writeProfile()
+      {
+      QJsonObject info;
+      Score* cs = mscore->currentScore();
+      if (cs) {
+            info["score"]    = cs->fileInfo()->absoluteFilePath();
+            info["pages"]    = cs->npages();
+            info["measures"] = cs->nmeasures();
+            info["staves"]   = cs->nstaves();
+            }
+      if (!jobFileName.isEmpty())
+            info["job"] = jobFileName;
+      else
+            info["output"] = outFileName;
+      Profiler::writeJson(profileFileName, info);
+      }
+
+extern Score::FileError readScore(Score* score, QString name, bool ignoreVersionError);
+
+//---------------------------------------------------------
+//   convert
+//    export score cs to file fn, format depends on the
+//    file extension; style is an optional style file
+//---------------------------------------------------------
+
+static bool convert(Score* cs, const QString& fn, const QString& style)
+      {
+      if (!cs)
+            return false;
+      ProfileScope profile("export");
+      if (!style.isEmpty()) {
+            QFile f(style);
+            if (f.open(QIODevice::ReadOnly)) {
+                  cs->style()->load(&f);
+                  }
+            }
+      if (fn.endsWith(".mscx")) {
+            QFileInfo fi(fn);
+            try {
+                  cs->saveFile(fi);
+                  }
+            catch(QString) {
+                  return false;
+                  }
+            return true;
+            }
+      if (fn.endsWith(".mscz")) {
+            QFileInfo fi(fn);
+            try {
+                  cs->saveCompressedFile(fi, false);
+                  }
+            catch(QString) {
+                  return false;
+                  }
+            return true;
+            }
+      if (fn.endsWith(".xml"))
+            return saveXml(cs, fn);
+      if (fn.endsWith(".mxl"))
+            return saveMxl(cs, fn);
+      if (fn.endsWith(".mid"))
+            return mscore->saveMidi(cs, fn);
+      if (fn.endsWith(".pdf")) {
+            if (!exportScoreParts)
+                  return mscore->savePdf(cs, fn);
+            else {
+                  if (cs->excerpts().size() == 0) {
+                        QList<Excerpt*> exceprts = Excerpt::createAllExcerpt(cs);
+                        
+                        foreach(Excerpt* e, exceprts) {
+                              Score* nscore = new Score(e->oscore());
+                              e->setPartScore(nscore);
+                              nscore->setName(e->title()); // needed before AddExcerpt
+                              nscore->style()->set(StyleIdx::createMultiMeasureRests, true);
+                              cs->startCmd();
+                              cs->undo(new AddExcerpt(nscore));
+                              createExcerpt(e);
+                              cs->endCmd();
+                              }
+                        }
+                  QList<Score*> scores;
+                  scores.append(cs);
+                  foreach(Excerpt* e, cs->excerpts())
+                        scores.append(e->partScore());
+                  return mscore->savePdf(scores, fn);
+                  }
+            }
+      if (fn.endsWith(".png"))
+            return mscore->savePng(cs, fn);
+      if (fn.endsWith(".svg"))
+            return mscore->saveSvg(cs, fn);
+#ifdef HAS_AUDIOFILE
+      if (fn.endsWith(".wav") || fn.endsWith(".ogg") || fn.endsWith(".flac"))
+            return mscore->saveAudio(cs, fn, exportScoreParts);
+#endif
+#ifdef USE_LAME
+      if (fn.endsWith(".mp3"))
+            return mscore->saveMp3(cs, fn);
+#endif
+      if (fn.endsWith(".spos"))
+            return savePositions(cs, fn, true);
+      if (fn.endsWith(".mpos"))
+            return savePositions(cs, fn, false);
+      if (fn.endsWith(".mlog"))
+            return cs->sanityCheck(fn);
+      else {
+            qDebug("dont know how to convert to %s", qPrintable(fn));
+            return false;
+            }
+      }
+
+//---------------------------------------------------------
+//   ConversionJob
+//---------------------------------------------------------
+
+struct ConversionJob {
+      int n;                  // position in the job file, for messages
+      QString in;
+      QStringList out;
+      QString style;
+      bool ok;
+      };
+
+//---------------------------------------------------------
+//   runJob
+//    read, lay out and export one score on a thread of the
+//    pool. Every job has its own Score; scores are read
+//    and laid out concurrently. Importers use global
+//    import options, the exporters the global printing
+//    state and the shared synthesizer: these parts run
+//    one job at a time.
+//---------------------------------------------------------
+
+static void runJob(ConversionJob& job)
+      {
+      static QMutex importMutex;
+      static QMutex exportMutex;
+
+      QString suffix = QFileInfo(job.in).suffix().toLower();
+      bool native    = suffix == "mscz" || suffix == "mscx";
+      Score* score   = new Score(MScore::baseStyle());
+      Score::FileError rv;
+      if (native)
+            rv = readScore(score, job.in, false);
+      else {
+            QMutexLocker locker(&importMutex);
+            rv = readScore(score, job.in, false);
+            }
+      if (rv != Score::FileError::FILE_NO_ERROR) {
+            qDebug("job %d: cannot read <%s>: %s", job.n, qPrintable(job.in), qPrintable(MScore::lastError));
+            delete score;
+            job.ok = false;
+            return;
+            }
+
+      QMutexLocker locker(&exportMutex);
+      for (int i = 0; i < job.out.size(); ++i) {
+            // load the style once per score
+            if (!convert(score, job.out[i], i == 0 ? job.style : QString())) {
+                  qDebug("job %d: conversion of <%s> to <%s> failed", job.n, qPrintable(job.in), qPrintable(job.out[i]));
+                  job.ok = false;
+                  }
+            }
+      locker.unlock();
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   processJob
+//    convert all scores listed in a JSON job file:
+//    [ { "in": "a.mscz", "out": [ "a.pdf", "a.mid" ], "style": "a.mss" }, ... ]
+//    "out" may also be a single file name, "style" is optional
+//    and defaults to the -S style; relative paths are resolved
+//    against the directory of the job file.
+//    All jobs run in this process on a thread pool, so fonts,
+//    instrument templates and the synthesizer are loaded only
+//    once.
+//---------------------------------------------------------
+
+static bool processJob(const QString& fileName)
+      {
+      QFile f(fileName);
+      if (!f.open(QIODevice::ReadOnly)) {
+            qDebug("cannot open job file <%s>", qPrintable(fileName));
+            return false;
+            }
+      QJsonParseError error;
+      QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &error);
+      if (error.error != QJsonParseError::NoError || !doc.isArray()) {
+            qDebug("bad job file <%s>: %s", qPrintable(fileName), qPrintable(error.errorString()));
+            return false;
+            }
+      QDir dir(QFileInfo(fileName).absolutePath());
+      bool result = true;
+      QList<ConversionJob> jobs;
+      int n = 0;
+      for (const QJsonValue& v : doc.array()) {
+            QJsonObject o = v.toObject();
+            ConversionJob job;
+            job.n  = ++n;
+            job.ok = true;
+            QString in = o.value("in").toString();
+            QJsonValue ov = o.value("out");
+            QStringList out;
+            if (ov.isArray()) {
+                  for (const QJsonValue& file : ov.toArray())
+                        out.append(file.toString());
+                  }
+            else
+                  out.append(ov.toString());
+            if (in.isEmpty() || out.contains(QString())) {
+                  qDebug("job %d: missing input or output file", job.n);
+                  result = false;
+                  continue;
+                  }
+            job.in = dir.absoluteFilePath(in);
+            for (const QString& s : out)
+                  job.out.append(dir.absoluteFilePath(s));
+            QString style = o.value("style").toString();
+            job.style = style.isEmpty() ? styleFile : dir.absoluteFilePath(style);
+            jobs.append(job);
+            }
+
+      // score fonts are loaded on first use; load them before
+      // the jobs share them
+      for (const ScoreFont& sf : ScoreFont::scoreFonts())
+            ScoreFont::fontFactory(sf.name());
+
+      QtConcurrent::blockingMap(jobs, runJob);
+      for (const ConversionJob& job : jobs)
+            result = result && job.ok;
+      return result;
+      }
+
 //---------------------------------------------------------
 //   processNonGui
 //---------------------------------------------------------
@@ -2053,91 +2295,8 @@ static bool processNonGui()
                   return res;
             }
 
-      if (converterMode) {
-            QString fn(outFileName);
-            Score* cs = mscore->currentScore();
-            if (!cs)
-                  return false;
-            if (!styleFile.isEmpty()) {
-                  QFile f(styleFile);
-                  if (f.open(QIODevice::ReadOnly)) {
-                        cs->style()->load(&f);
-                        }
-                  }
-            if (fn.endsWith(".mscx")) {
-                  QFileInfo fi(fn);
-                  try {
-                        cs->saveFile(fi);
-                        }
-                  catch(QString) {
-                        return false;
-                        }
-                  return true;
-                  }
-            if (fn.endsWith(".mscz")) {
-                  QFileInfo fi(fn);
-                  try {
-                        cs->saveCompressedFile(fi, false);
-                        }
-                  catch(QString) {
-                        return false;
-                        }
-                  return true;
-                  }
-            if (fn.endsWith(".xml"))
-                  return saveXml(cs, fn);
-            if (fn.endsWith(".mxl"))
-                  return saveMxl(cs, fn);
-            if (fn.endsWith(".mid"))
-                  return mscore->saveMidi(cs, fn);
-            if (fn.endsWith(".pdf")) {
-                  if (!exportScoreParts)
-                        return mscore->savePdf(fn);
-                  else {
-                        if (cs->excerpts().size() == 0) {
-                              QList<Excerpt*> exceprts = Excerpt::createAllExcerpt(cs);
-                              
-                              foreach(Excerpt* e, exceprts) {
-                                    Score* nscore = new Score(e->oscore());
-                                    e->setPartScore(nscore);
-                                    nscore->setName(e->title()); // needed before AddExcerpt
-                                    nscore->style()->set(StyleIdx::createMultiMeasureRests, true);
-                                    cs->startCmd();
-                                    cs->undo(new AddExcerpt(nscore));
-                                    createExcerpt(e);
-                                    cs->endCmd();
-                                    }
-                              }
-                        QList<Score*> scores;
-                        scores.append(cs);
-                        foreach(Excerpt* e, cs->excerpts())
-                              scores.append(e->partScore());
-                        return mscore->savePdf(scores, fn);
-                        }
-                  }
-            if (fn.endsWith(".png"))
-                  return mscore->savePng(cs, fn);
-            if (fn.endsWith(".svg"))
-                  return mscore->saveSvg(cs, fn);
-#ifdef HAS_AUDIOFILE
-            if (fn.endsWith(".wav") || fn.endsWith(".ogg") || fn.endsWith(".flac"))
-                  return mscore->saveAudio(cs, fn);
-#endif
-#ifdef USE_LAME
-            if (fn.endsWith(".mp3"))
-                  return mscore->saveMp3(cs, fn);
-#endif
-            if (fn.endsWith(".spos"))
-                  return savePositions(cs, fn, true);
-            if (fn.endsWith(".mpos"))
-                  return savePositions(cs, fn, false);
-            if (fn.endsWith(".mlog"))
-                  return cs->sanityCheck(fn);
-            else {
-                  qDebug("dont know how to convert to %s", qPrintable(outFileName));
-                  return false;
-                  }
-            }
+      if (converterMode)
+            return convert(mscore->currentScore(), outFileName, styleFile);
       return true;
       }
 
@@ -3277,7 +3436,7 @@ bool MuseScore::restoreSession(bool always)
                   int v           = sl[0].toInt() * 100 + sl[1].toInt();
                   */
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "clean") {
                               if (!always)
                                     return false;
@@ -3299,7 +3458,7 @@ bool MuseScore::restoreSession(bool always)
                               QString name;
                               bool created = false;
                               while (e.readNextStartElement()) {
-                                    const QStringRef& tag(e.name());
+                                    const XmlTag& tag(e.name());
                                     if (tag == "name")
                                           name = e.readElementText();
                                     else if (tag == "created")
@@ -3330,7 +3489,7 @@ bool MuseScore::restoreSession(bool always)
                               MagIdx magIdx = MagIdx::MAG_FREE;
                               int tab = 0, idx = 0;
                               while (e.readNextStartElement()) {
-                                    const QStringRef& tag(e.name());
+                                    const XmlTag& tag(e.name());
                                     if (tag == "tab")
                                           tab = e.readInt();
                                     else if (tag == "idx")
@@ -4564,7 +4723,9 @@ int main(int argc, char* av[])
       parser.addOption(QCommandLineOption({"t", "test-mode"}, "Set testMode flag for all files"));
       parser.addOption(QCommandLineOption({"M", "midi-operations"}, "Specify MIDI import operations file", "file"));
       parser.addOption(QCommandLineOption({"w", "no-webview"}, "No web view in start center"));
-      parser.addOption(QCommandLineOption({"P", "export-score-parts"}, "used with -o <file>.pdf, export score + parts"));
+      parser.addOption(QCommandLineOption({"P", "export-score-parts"}, "used with -o <file>.pdf, export score + parts; with an audio file, also write one file per part"));
+      parser.addOption(QCommandLineOption({"j", "job"}, "Process a conversion job file (JSON)", "file"));
+      parser.addOption(QCommandLineOption(      "profile", "used with -o <file> or -j <file>, write read, layout and export timings as JSON to 'file'", "file"));
 
       parser.addPositionalArgument("scorefiles", "The files to open", "[scorefile...]");
 
@@ -4594,6 +4755,13 @@ int main(int argc, char* av[])
             if (outFileName.isEmpty())
                   parser.showHelp(EXIT_FAILURE);
             }
+      if (parser.isSet("j")) {
+            MScore::noGui = true;
+            converterMode = true;
+            jobFileName = parser.value("j");
+            if (jobFileName.isEmpty())
+                  parser.showHelp(EXIT_FAILURE);
+            }
       if ((pluginMode = parser.isSet("p"))) {
             MScore::noGui = true;
             pluginName = parser.value("p");
@@ -4647,6 +4815,21 @@ int main(int argc, char* av[])
             }
       noWebView = parser.isSet("w");
       exportScoreParts = parser.isSet("export-score-parts");
+      if (parser.isSet("profile")) {
+            profileFileName = parser.value("profile");
+            QString error;
+            if (profileFileName.isEmpty() || profileFileName.startsWith("-"))
+                  error = "--profile: missing file name";
+            else if (!converterMode)
+                  error = "--profile: can only be used with -o or -j";
+            else if (!QFileInfo(profileFileName).absoluteDir().exists())
+                  error = QString("--profile: directory of <%1> does not exist").arg(profileFileName);
+            if (!error.isEmpty()) {
+                  fprintf(stderr, "%s\n", qPrintable(error));
+                  parser.showHelp(EXIT_FAILURE);
+                  }
+            Profiler::setEnabled(true);
+            }
       if (exportScoreParts && !converterMode)
             parser.showHelp(EXIT_FAILURE);
 
@@ -4865,6 +5048,7 @@ int main(int argc, char* av[])
             MScore::seq    = seq;
             Driver* driver = driverFactory(seq, audioDriver);
             synti          = synthesizerFactory();
+            synti->setStreaming(true);
             if (driver) {
                   MScore::sampleRate = driver->sampleRate();
                   synti->setSampleRate(MScore::sampleRate);
@@ -4943,8 +5127,16 @@ int main(int argc, char* av[])
             // see issue #28706: Hangup in converter mode with MusicXML source
             qApp->processEvents();
 #endif
-            loadScores(argv);
-            exit(processNonGui() ? 0 : EXIT_FAILURE);
+            bool rv;
+            if (!jobFileName.isEmpty())
+                  rv = processJob(jobFileName);
+            else {
+                  loadScores(argv);
+                  rv = processNonGui();
+                  }
+            if (!profileFileName.isEmpty())
+                  writeProfile();
+            exit(rv ? 0 : EXIT_FAILURE);
             }
       else {
             mscore->readSettings();
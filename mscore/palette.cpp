@@ -1017,7 +1017,7 @@ bool Palette::read(QFile* qf)
                   gscore->setMscVersion(versionId);
 
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "Palette") {
                               QString name = e.attribute("name");
                               setName(name);
@@ -1065,7 +1065,7 @@ bool Palette::read(const QString& p)
                         break;
                         }
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
 
                         if (tag == "rootfile") {
                               if (rootfile.isEmpty())
@@ -1205,7 +1205,7 @@ void Palette::write(const QString& p)
 void Palette::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& t(e.name());
+            const XmlTag& t(e.name());
             if (t == "gridWidth")
                   hgrid = e.readDouble() * guiScaling;
             else if (t == "gridHeight")
@@ -1225,7 +1225,7 @@ void Palette::read(XmlReader& e)
                   cell->name = e.attribute("name");
                   bool add = true;
                   while (e.readNextStartElement()) {
-                        const QStringRef& t(e.name());
+                        const XmlTag& t(e.name());
                         if (t == "staff")
                               cell->drawStaff = e.readInt();
                         else if (t == "xoffset")
@@ -323,7 +323,7 @@ QList<Palette*> PaletteBox::palettes()const
 bool PaletteBox::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "Palette") {
                   Palette* p = new Palette();
                   QString name = e.attribute("name");
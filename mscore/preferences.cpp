@@ -154,6 +154,7 @@ void Preferences::init()
       midiExpandRepeats        = true;
       MScore::playRepeats      = true;
       MScore::panPlayback      = true;
+      MScore::parallelLayout   = true;
       instrumentList1          = ":/data/instruments.xml";
       instrumentList2          = "";
 
@@ -215,6 +216,7 @@ void Preferences::init()
       nativeDialogs           = false;    // don't use system native file dialogs
 #endif
       exportAudioSampleRate   = exportAudioSampleRates[0];
+      exportAudioThreads      = 1;
 
       workspace               = "Basic";
       exportPdfDpi            = 300;
@@ -336,9 +338,12 @@ void Preferences::write()
       s.setValue("sfPath",  sfPath);
 
       s.setValue("hraster", MScore::hRaster());
+      s.setValue("glyphCacheSize", ScoreFont::glyphCacheSize());
+      s.setValue("parallelLayout", MScore::parallelLayout);
       s.setValue("vraster", MScore::vRaster());
       s.setValue("nativeDialogs", nativeDialogs);
       s.setValue("exportAudioSampleRate", exportAudioSampleRate);
+      s.setValue("exportAudioThreads", exportAudioThreads);
 
       s.setValue("workspace", workspace);
       s.setValue("exportPdfDpi", exportPdfDpi);
@@ -486,10 +491,18 @@ void Preferences::read()
             dir.mkpath(path);
 
       MScore::setHRaster(s.value("hraster", MScore::hRaster()).toInt());
+      // the glyph cache size is in bytes per score font; keep it
+      // between 1MB and 256MB
+      bool ok;
+      int glyphCacheSize = s.value("glyphCacheSize", ScoreFont::glyphCacheSize()).toInt(&ok);
+      if (ok)
+            ScoreFont::setGlyphCacheSize(qBound(1024 * 1024, glyphCacheSize, 256 * 1024 * 1024));
+      MScore::parallelLayout = s.value("parallelLayout", MScore::parallelLayout).toBool();
       MScore::setVRaster(s.value("vraster", MScore::vRaster()).toInt());
 
       nativeDialogs    = s.value("nativeDialogs", nativeDialogs).toBool();
       exportAudioSampleRate = s.value("exportAudioSampleRate", exportAudioSampleRate).toInt();
+      exportAudioThreads = s.value("exportAudioThreads", exportAudioThreads).toInt();
 
       workspace          = s.value("workspace", workspace).toString();
       exportPdfDpi       = s.value("exportPdfDpi", exportPdfDpi).toInt();
@@ -1731,11 +1744,11 @@ bool Preferences::readPluginList()
       while (e.readNextStartElement()) {
             if (e.name() == "museScore") {
                   while (e.readNextStartElement()) {
-                        const QStringRef& tag(e.name());
+                        const XmlTag& tag(e.name());
                         if (tag == "Plugin") {
                               PluginDescription d;
                               while (e.readNextStartElement()) {
-                                    const QStringRef& tag(e.name());
+                                    const XmlTag& tag(e.name());
                                     if (tag == "path")
                                           d.path = e.readElementText();
                                     else if (tag == "load")
@@ -168,6 +168,7 @@ struct Preferences {
       bool nativeDialogs;
 
       int exportAudioSampleRate;
+      int exportAudioThreads;       // synthesizer instances for audio export, 0: one per core
 
       QString workspace;
       int exportPdfDpi;
@@ -11,6 +11,7 @@
 //=============================================================================
 
 #include "scoreBrowser.h"
+#include "scoreInfoCache.h"
 #include "musescore.h"
 #include "icons.h"
 #include "libmscore/score.h"
@@ -44,6 +45,7 @@ class ScoreItem : public QListWidgetItem
    public:
       ScoreItem(const ScoreInfo& i) : QListWidgetItem(), _info(i) {}
       const ScoreInfo& info() const { return _info; }
+      void setPixmap(const QPixmap& pm) { _info.setPixmap(pm); setIcon(QIcon(pm)); }
       };
 
 //---------------------------------------------------------
@@ -58,6 +60,7 @@ ScoreBrowser::ScoreBrowser(QWidget* parent)
       scoreList->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
       scoreList->layout()->setMargin(0);
       connect(preview, SIGNAL(doubleClicked(QString)), SIGNAL(scoreActivated(QString)));
+      connect(ScoreInfoCache::instance(), SIGNAL(thumbnailReady(QString)), SLOT(thumbnailReady(QString)));
       if (!_showPreview)
             preview->setVisible(false);
       }
@@ -95,39 +98,72 @@ ScoreListWidget* ScoreBrowser::createScoreList()
       return sl;
       }
 
+//---------------------------------------------------------
+//   pixmapKey
+//---------------------------------------------------------
+
+static QString pixmapKey(const QFileInfo& fi)
+      {
+      return fi.filePath() + "@" + fi.lastModified().toString(Qt::ISODate);
+      }
+
+//---------------------------------------------------------
+//   scorePixmap
+//    draw thumbnail with a border into a pixmap of
+//    icon size
+//---------------------------------------------------------
+
+QPixmap ScoreBrowser::scorePixmap(const QFileInfo& fi, QPixmap pixmap, const QSize& size) const
+      {
+      QPixmap pm(size * qApp->devicePixelRatio());
+      if (pixmap.isNull())
+            pixmap = icons[int(Icons::file_ICON)]->pixmap(QSize(50,60));
+      pixmap = pixmap.scaled(pm.width() - 2, pm.height() - 2, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+      // draw pixmap and add border
+      pm.fill(Qt::transparent);
+      QPainter painter( &pm );
+      painter.setRenderHint(QPainter::Antialiasing);
+      painter.setRenderHint(QPainter::TextAntialiasing);
+      painter.drawPixmap(0, 0, pixmap);
+      painter.setPen(QPen(QColor(0, 0, 0, 128), 1));
+      painter.setBrush(Qt::white);
+      if (fi.baseName() == "00-Blank" || fi.baseName() == "Create_New_Score") {
+            qreal round = 8.0 * qApp->devicePixelRatio();
+            painter.drawRoundedRect(QRectF(0, 0, pm.width() - 1 , pm.height() - 1), round, round);
+            }
+      else
+            painter.drawRect(0, 0, pm.width()  - 1, pm.height()  - 1);
+      if (fi.baseName() != "00-Blank")
+            painter.drawPixmap(1, 1, pixmap);
+      painter.end();
+      return pm;
+      }
+
 //---------------------------------------------------------
 //   genScoreItem
+//    thumbnails of .mscz files which are not in the
+//    ScoreInfoCache are extracted in background, the item
+//    shows the file icon until thumbnailReady()
 //---------------------------------------------------------
 
 ScoreItem* ScoreBrowser::genScoreItem(const QFileInfo& fi, ScoreListWidget* l)
       {
       ScoreInfo si(fi);
 
-      QPixmap pm(l->iconSize() * qApp->devicePixelRatio());
-      if (!QPixmapCache::find(fi.filePath(), &pm)) {
-            //load and scale pixmap
-            QPixmap pixmap = mscore->extractThumbnail(fi.filePath());
-            if (pixmap.isNull())
-                  pixmap = icons[int(Icons::file_ICON)]->pixmap(QSize(50,60));
-            pixmap = pixmap.scaled(pm.width() - 2, pm.height() - 2, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-            // draw pixmap and add border
-            pm.fill(Qt::transparent);
-            QPainter painter( &pm );
-            painter.setRenderHint(QPainter::Antialiasing);
-            painter.setRenderHint(QPainter::TextAntialiasing);
-            painter.drawPixmap(0, 0, pixmap);
-            painter.setPen(QPen(QColor(0, 0, 0, 128), 1));
-            painter.setBrush(Qt::white);
-            if (fi.baseName() == "00-Blank" || fi.baseName() == "Create_New_Score") {
-                  qreal round = 8.0 * qApp->devicePixelRatio();
-                  painter.drawRoundedRect(QRectF(0, 0, pm.width() - 1 , pm.height() - 1), round, round);
+      ScoreInfoCache* cache = ScoreInfoCache::instance();
+      bool pending = false;
+      QPixmap pm;
+      if (!QPixmapCache::find(pixmapKey(fi), &pm)) {
+            QPixmap thumbnail;
+            if (!cache->find(fi, &thumbnail)) {
+                  if (ScoreInfoCache::isCached(fi) && fi.suffix() == "mscz")
+                        pending = true;
+                  else
+                        thumbnail = cache->thumbnail(fi);
                   }
-            else
-                  painter.drawRect(0, 0, pm.width()  - 1, pm.height()  - 1);
-            if (fi.baseName() != "00-Blank")
-                  painter.drawPixmap(1, 1, pixmap);
-            painter.end();
-            QPixmapCache::insert(fi.filePath(), pm);
+            pm = scorePixmap(fi, thumbnail, l->iconSize());
+            if (!pending)
+                  QPixmapCache::insert(pixmapKey(fi), pm);
             }
 
       si.setPixmap(pm);
@@ -160,15 +196,37 @@ ScoreItem* ScoreBrowser::genScoreItem(const QFileInfo& fi, ScoreListWidget* l)
       item->setTextAlignment(Qt::AlignHCenter | Qt::AlignTop);
       item->setIcon(QIcon(pm));
       item->setSizeHint(l->cellSize());
+      if (pending) {
+            _pending.insert(fi.filePath(), item);
+            cache->request(fi);
+            }
       return item;
       }
 
+//---------------------------------------------------------
+//   thumbnailReady
+//---------------------------------------------------------
+
+void ScoreBrowser::thumbnailReady(const QString& path)
+      {
+      ScoreItem* item = _pending.take(path);
+      if (!item)
+            return;
+      const ScoreInfo& fi = item->info();
+      QPixmap pm = scorePixmap(fi, ScoreInfoCache::instance()->thumbnail(fi), item->listWidget()->iconSize());
+      QPixmapCache::insert(pixmapKey(fi), pm);
+      item->setPixmap(pm);
+      if (_showPreview && item->isSelected())
+            preview->setScore(item->info());
+      }
+
 //---------------------------------------------------------
 //   setScores
 //---------------------------------------------------------
 
 void ScoreBrowser::setScores(QFileInfoList& s)
       {
+      _pending.clear();
       qDeleteAll(scoreLists);
       scoreLists.clear();
 
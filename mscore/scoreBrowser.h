@@ -56,11 +56,15 @@ class ScoreBrowser : public QWidget, public Ui::ScoreBrowser
       bool _boldTitle     { false };      // score title are displayed in bold
       bool _showCustomCategory  { false };// show a custom category for files
 
+      QHash<QString, ScoreItem*> _pending;      // items waiting for their thumbnail
+
       ScoreListWidget* createScoreList();
       ScoreItem* genScoreItem(const QFileInfo&, ScoreListWidget*);
+      QPixmap scorePixmap(const QFileInfo&, QPixmap thumbnail, const QSize&) const;
 
    private slots:
       void scoreChanged(QListWidgetItem*);
+      void thumbnailReady(const QString& path);
       void setScoreActivated(QListWidgetItem*);
 
    signals:
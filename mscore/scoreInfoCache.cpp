@@ -0,0 +1,259 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "scoreInfoCache.h"
+#include "thirdparty/qzip/qzipreader_p.h"
+
+namespace Ms {
+
+static const quint32 CACHE_MAGIC   = 0x4d534943;      // "MSIC"
+static const quint32 CACHE_VERSION = 1;
+
+ScoreInfoCache* ScoreInfoCache::inst = 0;
+
+//---------------------------------------------------------
+//   ScoreInfoCache
+//    create is called by thumbnail() for files which are
+//    not cached
+//---------------------------------------------------------
+
+ScoreInfoCache::ScoreInfoCache(const QString& fileName, std::function<QPixmap(const QString&)> create)
+   : _fileName(fileName), _create(create)
+      {
+      _saveTimer = new QTimer(this);
+      _saveTimer->setSingleShot(true);
+      _saveTimer->setInterval(2000);
+      connect(_saveTimer, SIGNAL(timeout()), SLOT(save()));
+      connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+            if (_saveTimer->isActive())
+                  save();
+            });
+      load();
+      }
+
+//---------------------------------------------------------
+//   ~ScoreInfoCache
+//    files still queued are dropped; a running extraction
+//    is waited for as it uses the cache
+//---------------------------------------------------------
+
+ScoreInfoCache::~ScoreInfoCache()
+      {
+      {
+      QMutexLocker locker(&_mutex);
+      _queue.clear();
+      }
+      _worker.waitForFinished();
+      if (_saveTimer->isActive())
+            save();
+      if (inst == this)
+            inst = 0;
+      }
+
+//---------------------------------------------------------
+//   isCached
+//    scores compiled into the resources are not worth
+//    a cache entry
+//---------------------------------------------------------
+
+bool ScoreInfoCache::isCached(const QFileInfo& fi)
+      {
+      return !fi.filePath().startsWith(":/");
+      }
+
+//---------------------------------------------------------
+//   load
+//---------------------------------------------------------
+
+void ScoreInfoCache::load()
+      {
+      QFile f(fileName());
+      if (!f.open(QIODevice::ReadOnly))
+            return;
+      QDataStream s(&f);
+      quint32 magic, version;
+      s >> magic >> version;
+      if (magic != CACHE_MAGIC || version != CACHE_VERSION)
+            return;
+      qint32 n;
+      s >> n;
+      for (int i = 0; i < n && s.status() == QDataStream::Ok; ++i) {
+            QString path;
+            Entry e;
+            s >> path >> e.lastModified >> e.size >> e.thumbnail;
+            _entries.insert(path, e);
+            }
+      if (s.status() != QDataStream::Ok) {
+            qDebug("ScoreInfoCache: <%s> is corrupted", qPrintable(fileName()));
+            _entries.clear();
+            }
+      }
+
+//---------------------------------------------------------
+//   save
+//    entries of removed files are dropped
+//---------------------------------------------------------
+
+void ScoreInfoCache::save()
+      {
+      QHash<QString, Entry> entries;
+      {
+      QMutexLocker locker(&_mutex);
+      entries = _entries;
+      }
+      for (auto i = entries.begin(); i != entries.end();) {
+            if (QFileInfo(i.key()).exists())
+                  ++i;
+            else
+                  i = entries.erase(i);
+            }
+      QDir().mkpath(QFileInfo(_fileName).absolutePath());
+      QSaveFile f(_fileName);
+      if (!f.open(QIODevice::WriteOnly)) {
+            qDebug("ScoreInfoCache: cannot write <%s>", qPrintable(fileName()));
+            return;
+            }
+      QDataStream s(&f);
+      s << CACHE_MAGIC << CACHE_VERSION << qint32(entries.size());
+      for (auto i = entries.begin(); i != entries.end(); ++i) {
+            const Entry& e = i.value();
+            s << i.key() << e.lastModified << e.size << e.thumbnail;
+            }
+      f.commit();
+      }
+
+//---------------------------------------------------------
+//   insert
+//    an empty thumbnail marks a file without one
+//---------------------------------------------------------
+
+void ScoreInfoCache::insert(const QFileInfo& fi, const QByteArray& thumbnail)
+      {
+      Entry e;
+      e.lastModified = fi.lastModified();
+      e.size         = fi.size();
+      e.thumbnail    = thumbnail;
+      QMutexLocker locker(&_mutex);
+      _entries.insert(fi.absoluteFilePath(), e);
+      }
+
+//---------------------------------------------------------
+//   find
+//    return true if there is a current entry for fi;
+//    pm is null if the file has no thumbnail
+//---------------------------------------------------------
+
+bool ScoreInfoCache::find(const QFileInfo& fi, QPixmap* pm) const
+      {
+      if (!isCached(fi))
+            return false;
+      QByteArray thumbnail;
+      {
+      QMutexLocker locker(&_mutex);
+      auto i = _entries.find(fi.absoluteFilePath());
+      if (i == _entries.end())
+            return false;
+      const Entry& e = i.value();
+      if (e.lastModified != fi.lastModified() || e.size != fi.size())
+            return false;
+      thumbnail = e.thumbnail;
+      }
+      *pm = QPixmap();
+      if (!thumbnail.isEmpty())
+            pm->loadFromData(thumbnail, "PNG");
+      return true;
+      }
+
+//---------------------------------------------------------
+//   thumbnail
+//    return the thumbnail of fi, extract or create it
+//    if it is not cached
+//---------------------------------------------------------
+
+QPixmap ScoreInfoCache::thumbnail(const QFileInfo& fi)
+      {
+      QPixmap pm;
+      if (find(fi, &pm))
+            return pm;
+      pm = _create(fi.filePath());
+      if (isCached(fi)) {
+            QByteArray ba;
+            if (!pm.isNull()) {
+                  QBuffer b(&ba);
+                  b.open(QIODevice::WriteOnly);
+                  pm.save(&b, "PNG");
+                  }
+            insert(fi, ba);
+            _saveTimer->start();
+            }
+      return pm;
+      }
+
+//---------------------------------------------------------
+//   request
+//    extract the thumbnail of fi in the background;
+//    thumbnailReady() is emitted when done
+//---------------------------------------------------------
+
+void ScoreInfoCache::request(const QFileInfo& fi)
+      {
+      QMutexLocker locker(&_mutex);
+      _queue.append(fi);
+      if (!_running) {
+            _running = true;
+            _worker = QtConcurrent::run(this, &ScoreInfoCache::work);
+            }
+      }
+
+//---------------------------------------------------------
+//   work
+//    runs in a background thread; only the thumbnails
+//    stored in .mscz files are extracted here, for all
+//    other files thumbnailReady() asks the gui thread to
+//    call thumbnail()
+//---------------------------------------------------------
+
+void ScoreInfoCache::work()
+      {
+      for (;;) {
+            QFileInfo fi;
+            {
+            QMutexLocker locker(&_mutex);
+            if (_queue.isEmpty()) {
+                  _running = false;
+                  break;
+                  }
+            fi = _queue.takeFirst();
+            }
+            if (fi.suffix() == "mscz") {
+                  MQZipReader uz(fi.filePath());
+                  QByteArray ba = uz.exists() ? uz.fileData("Thumbnails/thumbnail.png") : QByteArray();
+                  if (!ba.isEmpty())
+                        insert(fi, ba);
+                  }
+            emit thumbnailReady(fi.filePath());
+            }
+      QMetaObject::invokeMethod(_saveTimer, "start", Qt::QueuedConnection);
+      }
+
+//---------------------------------------------------------
+//   size
+//---------------------------------------------------------
+
+int ScoreInfoCache::size() const
+      {
+      QMutexLocker locker(&_mutex);
+      return _entries.size();
+      }
+
+}
+
@@ -0,0 +1,80 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __SCOREINFOCACHE_H__
+#define __SCOREINFOCACHE_H__
+
+#include <functional>
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   ScoreInfoCache
+//    persistent cache of the score thumbnails shown by
+//    the score browser and the start center
+//
+//    Entries are keyed by file path and are only valid
+//    for the modification time and size of the file they
+//    were made from. Thumbnails of .mscz files are
+//    extracted in a background thread; files which need a
+//    layout to create a thumbnail are handled in the gui
+//    thread by the create function.
+//---------------------------------------------------------
+
+class ScoreInfoCache : public QObject
+      {
+      Q_OBJECT
+
+      struct Entry {
+            QDateTime lastModified;
+            qint64 size;
+            QByteArray thumbnail;         // PNG data
+            };
+
+      static ScoreInfoCache* inst;
+
+      QString _fileName;
+      std::function<QPixmap(const QString&)> _create;
+      QHash<QString, Entry> _entries;
+      QList<QFileInfo> _queue;            // files to extract in background
+      bool _running { false };
+      QFuture<void> _worker;
+      mutable QMutex _mutex;
+      QTimer* _saveTimer;
+
+      void load();
+      void insert(const QFileInfo&, const QByteArray& thumbnail);
+      void work();
+
+   private slots:
+      void save();
+
+   signals:
+      void thumbnailReady(const QString& path);
+
+   public:
+      ScoreInfoCache(const QString& fileName, std::function<QPixmap(const QString&)> create);
+      ~ScoreInfoCache();
+      static ScoreInfoCache* instance();
+      static bool isCached(const QFileInfo&);
+
+      bool find(const QFileInfo&, QPixmap*) const;
+      QPixmap thumbnail(const QFileInfo&);
+      void request(const QFileInfo&);
+      int size() const;
+      const QString& fileName() const { return _fileName; }
+      };
+
+}
+
+#endif
+
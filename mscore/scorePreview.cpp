@@ -14,6 +14,7 @@
 #include "libmscore/score.h"
 #include "musescore.h"
 #include "scoreInfo.h"
+#include "scoreInfoCache.h"
 
 namespace Ms {
 
@@ -34,7 +35,7 @@ ScorePreview::ScorePreview(QWidget* parent)
 void ScorePreview::setScore(const QString& s)
       {
       ScoreInfo fi(s);
-      fi.setPixmap(mscore->extractThumbnail(s));
+      fi.setPixmap(ScoreInfoCache::instance()->thumbnail(fi));
       setScore(fi);
       }
 
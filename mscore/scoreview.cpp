@@ -2326,6 +2326,9 @@ void ScoreView::setMag(qreal nmag)
          nmag, _matrix.m23(), _matrix.dx()*deltamag, _matrix.dy()*deltamag, _matrix.m33());
       imatrix = _matrix.inverted();
       emit scaleChanged(nmag * score()->spatium());
+      // rasterize the common symbols for the new magnification
+      score()->scoreFont()->preloadGlyphs(score()->spatium() / (MScore::DPI * SPATIUM20),
+         nmag * devicePixelRatio(), MScore::defaultColor);
       if (grips) {
             qreal w = 8.0 / nmag;
             qreal h = 8.0 / nmag;
@@ -249,6 +249,8 @@ void Seq::exit()
             stopWait();
             delete _driver;
             _driver = 0;
+            if (_synti)
+                  _synti->audioStopped();
             }
       }
 
@@ -424,6 +426,8 @@ void Seq::guiStop()
 
       cs->setPlayPos(cs->repeatList()->utick2tick(cs->utime2utick(qreal(playTime) / qreal(MScore::sampleRate))));
       cs->end();
+      if (MScore::debugMode)
+            qDebug("Seq: %d audio blocks dropped or late since start", _synti->dropouts());
       emit stopped();
       }
 
@@ -550,16 +554,12 @@ void Seq::processMessages()
                         {
                         if (!cs)
                               continue;
-                        if (playTime != 0) {
-                              int utick = cs->utime2utick(qreal(playTime) / qreal(MScore::sampleRate));
-                              cs->tempomap()->setRelTempo(msg.realVal);
-                              playTime = cs->utick2utime(utick) * MScore::sampleRate;
-                              if (preferences.jackTimebaseMaster && preferences.useJackTransport)
-                                    _driver->seekTransport(utick + 2 * cs->utime2utick(qreal((_driver->bufferSize()) + 1) / qreal(MScore::sampleRate)));
+                        // the gui has already published the new time map
+                        std::shared_ptr<const TimeMap> timeMap = updateTimeMap();
+                        if (playTime != 0 && preferences.jackTimebaseMaster && preferences.useJackTransport) {
+                              int utick = timeMap->utime2utick(qreal(playTime) / qreal(MScore::sampleRate));
+                              _driver->seekTransport(utick + 2 * timeMap->utime2utick(qreal((_driver->bufferSize()) + 1) / qreal(MScore::sampleRate)));
                               }
-                        else
-                              cs->tempomap()->setRelTempo(msg.realVal);
-                        cs->repeatList()->update();
                         prevTempo = curTempo();
                         emit tempoChanged();
                         }
@@ -791,12 +791,14 @@ void Seq::process(unsigned n, float* buffer)
             //
             unsigned framePos = 0;
             int endTime = *pPlayTime + frames;
-            int utickEnd = cs->repeatList()->tick2utick(cs->lastMeasure()->endTick()) - 1;
+            // one consistent time map for this cycle
+            std::shared_ptr<const TimeMap> timeMap = updateTimeMap();
+            int utickEnd = timeMap->tick2utick(cs->lastMeasure()->endTick()) - 1;
             for ( ; *pPlayPos != pEvents->cend(); ) {
                   int n;
                   if (inCountIn) {
 
-                        qreal bps = curTempo() * cs->tempomap()->relTempo();
+                        qreal bps = curTempo() * timeMap->relTempo();
                         // relTempo needed here to ensure that bps changes as we slide the tempo bar
 
                         qreal tickssec = bps * MScore::division;
@@ -811,7 +813,7 @@ void Seq::process(unsigned n, float* buffer)
                               }
                         }
                   else {
-                        int f = cs->utick2utime(playPos->first) * MScore::sampleRate;
+                        int f = timeMap->utick2utime(playPos->first) * MScore::sampleRate;
                         if (f >= endTime)
                               break;
                         n = f - *pPlayTime;
@@ -820,7 +822,7 @@ void Seq::process(unsigned n, float* buffer)
                               n = 0;
                               }
                         if (mscore->loop()) {
-                              int utickLoop = cs->repeatList()->tick2utick(cs->loopOutTick());
+                              int utickLoop = timeMap->tick2utick(cs->loopOutTick());
                               if (utickLoop < utickEnd)
                                     if ((*pPlayPos)->first >= utickLoop) {
                                           qDebug ("Process playPos = %d  in/out tick = %d/%d  getCurTick() = %d   tickLoop = %d   playTime = %d",
@@ -1018,13 +1020,39 @@ int Seq::getCurTick()
 //---------------------------------------------------------
 //   setRelTempo
 //    relTempo = 1.0 = normal tempo
+//    the time map is rebuilt here in the gui thread, the
+//    sequencer picks it up with its next cycle
 //---------------------------------------------------------
 
 void Seq::setRelTempo(double relTempo)
       {
+      if (cs) {
+            cs->tempomap()->setRelTempo(relTempo);
+            cs->repeatList()->update();
+            }
       guiToSeq(SeqMsg(SeqMsgId::TEMPO_CHANGE, relTempo));
       }
 
+//---------------------------------------------------------
+//   updateTimeMap
+//    switch to the time map last published by the gui;
+//    if the relative tempo has changed, playTime is moved
+//    so that playback continues at the same utick
+//    realtime environment
+//---------------------------------------------------------
+
+std::shared_ptr<const TimeMap> Seq::updateTimeMap()
+      {
+      std::shared_ptr<const TimeMap> timeMap = cs->repeatList()->timeMap();
+      if (playTimeMap && timeMap != playTimeMap && playTime != 0
+         && timeMap->relTempo() != playTimeMap->relTempo()) {
+            int utick = playTimeMap->utime2utick(qreal(playTime) / qreal(MScore::sampleRate));
+            playTime  = timeMap->utick2utime(utick) * MScore::sampleRate;
+            }
+      playTimeMap = timeMap;
+      return timeMap;
+      }
+
 //---------------------------------------------------------
 //   setPos
 //    seek
@@ -1045,7 +1073,8 @@ void Seq::setPos(int utick)
       if (utick != ucur)
             updateSynthesizerState(ucur, utick);
 
-      playTime  = cs->utick2utime(utick) * MScore::sampleRate;
+      playTimeMap = cs->repeatList()->timeMap();
+      playTime    = playTimeMap->utick2utime(utick) * MScore::sampleRate;
       mutex.lock();
       playPos   = events.lower_bound(utick);
       mutex.unlock();
@@ -28,12 +28,15 @@
 #include "libmscore/fifo.h"
 #include "libmscore/tempo.h"
 
+#include <memory>
+
 class QTimer;
 
 namespace Ms {
 
 class Note;
 class Score;
+class TimeMap;
 class Painter;
 class Measure;
 class Fraction;
@@ -136,6 +139,7 @@ class Seq : public QObject, public Sequencer {
       EventMap countInEvents;
 
       int playTime;                       // current play position in samples
+      std::shared_ptr<const TimeMap> playTimeMap; // map playTime was computed with, real time thread
       int countInPlayTime;
       int endTick;
 
@@ -213,6 +217,7 @@ class Seq : public QObject, public Sequencer {
       bool isStopped() const    { return state == Transport::STOP; }
 
       void processMessages();
+      std::shared_ptr<const TimeMap> updateTimeMap();
       void process(unsigned, float*);
       int getEndTick() const    { return endTick;  }
       bool isRealtime() const   { return true;     }
@@ -3538,7 +3538,7 @@ void Shortcut::write(Xml& xml) const
 void Shortcut::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "key")
                   _key = e.readElementText().toLocal8Bit();
             else if (tag == "std")
@@ -3584,7 +3584,7 @@ void Shortcut::load()
                         if (e.name() == "SC") {
                               Shortcut* sc = 0;
                               while (e.readNextStartElement()) {
-                                    const QStringRef& tag(e.name());
+                                    const XmlTag& tag(e.name());
                                     if (tag == "key") {
                                           QString val(e.readElementText());
                                           sc = getShortcut(qPrintable(val));
@@ -3646,7 +3646,7 @@ static QList<Shortcut1> loadDefaultShortcuts()
                         if (e.name() == "SC") {
                               Shortcut1 sc;
                               while (e.readNextStartElement()) {
-                                    const QStringRef& tag(e.name());
+                                    const XmlTag& tag(e.name());
                                     if (tag == "key")
                                           sc.key = e.readElementText().toLocal8Bit();
                                     else if (tag == "std")
@@ -373,7 +373,7 @@ void Workspace::read()
 void Workspace::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
             if (tag == "name")
                   e.readElementText();
             else if (tag == "PaletteBox") {
@@ -12,6 +12,9 @@
 
 #include <QtTest/QtTest>
 
+#include <set>
+#include <tuple>
+
 #include "libmscore/mscore.h"
 #include "libmscore/score.h"
 #include "libmscore/durationtype.h"
@@ -20,6 +23,8 @@
 #include "libmscore/chord.h"
 #include "libmscore/note.h"
 #include "libmscore/keysig.h"
+#include "libmscore/tuplet.h"
+#include "libmscore/undo.h"
 #include "mscore/exportmidi.h"
 
 #include "libmscore/mcursor.h"
@@ -56,6 +61,7 @@ class TestImportMidi : public QObject, public MTest
       QString midiFilePath(const QString &fileName) const;
       QString midiFilePath(const char* fileName) const;
       void mf(const char* name) const;
+      void importDenseFile(int channel, int divisor);
 
                   // functions that modify default settings
       void dontSimplify(const char *file)
@@ -404,6 +410,22 @@ class TestImportMidi : public QObject, public MTest
 
       // gui - tracks model
       void testGuiTracksModel();
+
+      // tracks are processed in parallel by default,
+      // serial processing should give the same scores
+      void serialTracks();
+
+      // long scores
+      void longScore();
+      void benchmarkLongScore();
+
+      // pathological files for the tuplet search
+      void denseTupletsPiano()     { importDenseFile(0, 6); }
+      void denseTupletsDrums()     { importDenseFile(9, 6); }
+      void denseTupletsNonuplets() { importDenseFile(0, 9); }
+      // a search stopped at once should still find the tuplets of simple files
+      void greedyTuplets_data();
+      void greedyTuplets();
       };
 
 //---------------------------------------------------------
@@ -1199,6 +1221,333 @@ void TestImportMidi::testGuiTracksModel()
       QCOMPARE(model.flags(model.index(0, channelCol)), notEditableFlags);
       }
 
+//---------------------------------------------------------
+//   serialTracks
+//---------------------------------------------------------
+
+void TestImportMidi::serialTracks()
+      {
+      auto &opers = preferences.midiImportOperations;
+      opers.setParallelTracks(false);
+      for (const char* name : { "instrument_3staff_organ", "instrument_channels" }) {
+                        // import a copy to process it as a newly opened file
+            const QString path = QDir::temp().absoluteFilePath(QString("mtest_serial_") + name + ".mid");
+            QFile::remove(path);
+            QVERIFY(QFile::copy(midiFilePath(name), path));
+            Score* score = new Score(mscore->baseStyle());
+            score->setName(name);
+            QCOMPARE(importMidi(score, path), Score::FileError::FILE_NO_ERROR);
+            const QString mscorename = QString(name) + ".mscx";
+            QVERIFY(saveCompareScore(score, mscorename, DIR + mscorename));
+            delete score;
+            QFile::remove(path);
+            }
+      opers.setParallelTracks(true);
+      }
+
+//---------------------------------------------------------
+//   writeMidiFile
+//    single track file with 480 ticks per quarter, 4/4,
+//    120 bpm and the given notes
+//---------------------------------------------------------
+
+struct TestNote {
+      int onTime;
+      int len;
+      int pitch;
+      int channel;
+      };
+
+static bool writeMidiFile(const QString& path, const std::vector<TestNote>& notes)
+      {
+      const int division = 480;
+                  // <tick, note on/off, status, pitch, velocity>, note offs first
+      std::vector<std::tuple<int, int, int, int, int>> events;
+      for (const TestNote& n : notes) {
+            events.push_back(std::make_tuple(n.onTime, 1, 0x90 | n.channel, n.pitch, 80));
+            events.push_back(std::make_tuple(n.onTime + n.len, 0, 0x80 | n.channel, n.pitch, 0));
+            }
+      std::stable_sort(events.begin(), events.end(),
+                       [](const std::tuple<int, int, int, int, int>& e1,
+                          const std::tuple<int, int, int, int, int>& e2) {
+            if (std::get<0>(e1) != std::get<0>(e2))
+                  return std::get<0>(e1) < std::get<0>(e2);
+            return std::get<1>(e1) < std::get<1>(e2);
+            });
+
+      QByteArray track;
+      auto putvl = [&track](unsigned val) {
+            unsigned buf = val & 0x7f;
+            while ((val >>= 7) > 0) {
+                  buf <<= 8;
+                  buf |= 0x80;
+                  buf += (val & 0x7f);
+                  }
+            for (;;) {
+                  track.append(char(buf & 0xff));
+                  if (buf & 0x80)
+                        buf >>= 8;
+                  else
+                        break;
+                  }
+            };
+      const char timeSig[] = { 0x00, char(0xff), 0x58, 0x04, 0x04, 0x02, 0x18, 0x08 };
+      const char tempo[]   = { 0x00, char(0xff), 0x51, 0x03, 0x07, char(0xa1), 0x20 };
+      track.append(timeSig, sizeof(timeSig));
+      track.append(tempo, sizeof(tempo));
+      int tick = 0;
+      for (const auto& e : events) {
+            putvl(std::get<0>(e) - tick);
+            tick = std::get<0>(e);
+            track.append(char(std::get<2>(e)));
+            track.append(char(std::get<3>(e)));
+            track.append(char(std::get<4>(e)));
+            }
+      const char end[] = { 0x00, char(0xff), 0x2f, 0x00 };
+      track.append(end, sizeof(end));
+
+      QFile f(path);
+      if (!f.open(QIODevice::WriteOnly))
+            return false;
+      QDataStream ds(&f);
+      ds.setByteOrder(QDataStream::BigEndian);
+      ds.writeRawData("MThd", 4);
+      ds << qint32(6) << qint16(0) << qint16(1) << qint16(division);
+      ds.writeRawData("MTrk", 4);
+      ds << qint32(track.size());
+      ds.writeRawData(track.constData(), track.size());
+      return f.error() == QFile::NoError;
+      }
+
+//---------------------------------------------------------
+//   writeLongMidiFile
+//    a quarter note on every beat of the given number
+//    of measures
+//---------------------------------------------------------
+
+static bool writeLongMidiFile(const QString& path, int measures)
+      {
+      std::vector<TestNote> notes;
+      for (int i = 0; i < measures * 4; ++i)
+            notes.push_back({ i * 480, 480, 60 + (i % 12), 0 });
+      return writeMidiFile(path, notes);
+      }
+
+//---------------------------------------------------------
+//   writeDenseMidiFile
+//    pathological input for the tuplet detection: every
+//    beat has onsets on the straight, triplet, quintuplet
+//    and septuplet grids (with a small deterministic jitter),
+//    so each bar has many overlapping tuplet candidates
+//---------------------------------------------------------
+
+static bool writeDenseMidiFile(const QString& path, int measures, int channel, int divisor)
+      {
+      const int beat = 480;
+      std::set<int> positions;
+      for (int d : { 4, 3, 5, 7, divisor }) {
+            for (int k = 0; k < d; ++k)
+                  positions.insert(k * beat / d);
+            }
+      std::vector<TestNote> notes;
+      int n = 0;
+      for (int b = 0; b < measures * 4; ++b) {
+            for (int pos : positions) {
+                  const int jitter = (n * 7919) % 11 - 5;
+                  const int onTime = qMax(0, b * beat + pos + jitter);
+                  const int pitch = (channel == 9) ? 35 + (n % 12) : 48 + (n * 5) % 36;
+                  notes.push_back({ onTime, beat / 12, pitch, channel });
+                  if (n % 3 == 0)
+                        notes.push_back({ onTime, beat / 12, pitch + 7, channel });
+                  ++n;
+                  }
+            }
+      return writeMidiFile(path, notes);
+      }
+
+//---------------------------------------------------------
+//   countTuplets
+//---------------------------------------------------------
+
+static int countTuplets(Score* score)
+      {
+      std::set<Tuplet*> tuplets;
+      for (Segment* s = score->firstSegment(Segment::Type::ChordRest); s; s = s->next1(Segment::Type::ChordRest)) {
+            for (int track = 0; track < score->ntracks(); ++track) {
+                  ChordRest* cr = static_cast<ChordRest*>(s->element(track));
+                  if (cr && cr->tuplet())
+                        tuplets.insert(cr->tuplet());
+                  }
+            }
+      return tuplets.size();
+      }
+
+//---------------------------------------------------------
+//   importDenseFile
+//    the search of dense files is bounded by the step
+//    limit alone; with a limit of one step it has to use
+//    the greedy tuplet selection
+//---------------------------------------------------------
+
+void TestImportMidi::importDenseFile(int channel, int divisor)
+      {
+      const int measures = 16;
+      auto &opers = preferences.midiImportOperations;
+      const int maxSteps = opers.tupletSearchMaxSteps();
+      QCOMPARE(opers.tupletSearchMaxTime(), 0);
+
+      for (int steps : { maxSteps, 1 }) {
+            const QString path = QDir::temp().absoluteFilePath(
+                              QString("mtest_dense_%1_%2_%3.mid").arg(channel).arg(divisor).arg(steps));
+            QVERIFY(writeDenseMidiFile(path, measures, channel, divisor));
+            opers.setTupletSearchMaxSteps(steps);
+            opers.resetTupletSearchStats();
+
+            QElapsedTimer timer;
+            timer.start();
+            Score* score = new Score(mscore->baseStyle());
+            QCOMPARE(importMidi(score, path), Score::FileError::FILE_NO_ERROR);
+            const auto stats = opers.tupletSearchStats();
+            qDebug("dense file, channel %d, divisor %d, steps %d: %lld ms, "
+                   "%d searches, %d stopped, %d greedy, %d tuplets",
+                   channel, divisor, steps, timer.elapsed(),
+                   stats.searches, stats.stopped, stats.greedy, countTuplets(score));
+
+            QVERIFY(score->nmeasures() >= measures);
+            QVERIFY(stats.searches > 0);
+                        // a stopped search has taken one step more than allowed
+            QVERIFY(stats.maxSteps <= steps + 1);
+            if (steps == 1) {
+                  QCOMPARE(stats.maxSteps, 2);
+                  QVERIFY(stats.stopped > 0);
+                  QVERIFY(stats.greedy > 0);
+                  QVERIFY(countTuplets(score) > 0);
+                  }
+            delete score;
+            QFile::remove(path);
+            }
+      opers.setTupletSearchMaxSteps(maxSteps);
+      opers.resetTupletSearchStats();
+      }
+
+//---------------------------------------------------------
+//   greedyTuplets
+//    import with a search limit of one step; the number
+//    of tuplets is the one of the reference score
+//---------------------------------------------------------
+
+void TestImportMidi::greedyTuplets_data()
+      {
+      QTest::addColumn<QString>("file");
+      QTest::addColumn<int>("tupletCount");
+
+      QTest::newRow("triplet")       << "tuplet_triplet"        << 1;
+      QTest::newRow("tripletsMixed") << "tuplet_triplets_mixed" << 5;
+      }
+
+void TestImportMidi::greedyTuplets()
+      {
+      QFETCH(QString, file);
+      QFETCH(int, tupletCount);
+
+      auto &opers = preferences.midiImportOperations;
+      opers.addNewMidiFile(midiFilePath(file));
+      MidiOperations::CurrentMidiFileSetter setCurrentMidiFile(opers, midiFilePath(file));
+      auto &data = *opers.data();
+                        // the options of the reference score, see dontSimplify()
+      data.trackOpers.simplifyDurations.setDefaultValue(false, false);
+      data.trackOpers.maxVoiceCount.setDefaultValue(MidiOperations::VoiceCount::V_1, false);
+      data.trackOpers.doStaffSplit.setDefaultValue(false, false);
+      data.trackOpers.showTempoText.setDefaultValue(false);
+
+      const int maxSteps = opers.tupletSearchMaxSteps();
+      opers.setTupletSearchMaxSteps(1);
+      opers.resetTupletSearchStats();
+
+      Score* score = new Score(mscore->baseStyle());
+      QCOMPARE(importMidi(score, midiFilePath(file)), Score::FileError::FILE_NO_ERROR);
+      const auto stats = opers.tupletSearchStats();
+      opers.setTupletSearchMaxSteps(maxSteps);
+      opers.resetTupletSearchStats();
+
+      QVERIFY(stats.searches > 0);
+      QVERIFY(stats.maxSteps <= 2);
+      QCOMPARE(countTuplets(score), tupletCount);
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   longScore
+//    tick lookups in a long imported score
+//---------------------------------------------------------
+
+void TestImportMidi::longScore()
+      {
+      const QString path = QDir::temp().absoluteFilePath("mtest_long_score.mid");
+      QVERIFY(writeLongMidiFile(path, 2000));
+
+      auto &opers = preferences.midiImportOperations;
+      opers.addNewMidiFile(path);
+      MidiOperations::CurrentMidiFileSetter setCurrentMidiFile(opers, path);
+
+      Score* score = new Score(mscore->baseStyle());
+      QCOMPARE(importMidi(score, path), Score::FileError::FILE_NO_ERROR);
+      QVERIFY(score->nmeasures() >= 2000);
+
+      auto checkLookups = [score]() {
+            for (Measure* m = score->firstMeasure(); m; m = m->nextMeasure()) {
+                  QCOMPARE(score->tick2measure(m->tick()), m);
+                  QCOMPARE(score->tick2measure(m->endTick() - 1), m);
+                  for (Segment* s = m->first(Segment::Type::ChordRest); s; s = s->next(Segment::Type::ChordRest))
+                        QCOMPARE(score->tick2segment(s->tick(), true, Segment::Type::ChordRest), s);
+                  }
+            Measure* lm = score->lastMeasure();
+            QCOMPARE(score->tick2measure(lm->endTick()), lm);
+            QVERIFY(score->tick2measure(lm->endTick() + 1) == 0);
+            };
+      checkLookups();
+      if (QTest::currentTestFailed())
+            return;
+
+      // the indexes follow edits of the lists
+      int n = score->nmeasures();
+      score->startCmd();
+      score->insertMeasure(Element::Type::MEASURE, score->tick2measure(MScore::division * 4 * 1000));
+      score->endCmd();
+      QCOMPARE(score->nmeasures(), n + 1);
+      checkLookups();
+      if (QTest::currentTestFailed())
+            return;
+      score->undo()->undo();
+      score->endUndoRedo();
+      QCOMPARE(score->nmeasures(), n);
+      checkLookups();
+
+      delete score;
+      QFile::remove(path);
+      }
+
+//---------------------------------------------------------
+//   benchmarkLongScore
+//    import a 2000 measure file
+//---------------------------------------------------------
+
+void TestImportMidi::benchmarkLongScore()
+      {
+      const QString path = QDir::temp().absoluteFilePath("mtest_long_score.mid");
+      QVERIFY(writeLongMidiFile(path, 2000));
+
+      auto &opers = preferences.midiImportOperations;
+      opers.addNewMidiFile(path);
+      MidiOperations::CurrentMidiFileSetter setCurrentMidiFile(opers, path);
+
+      QBENCHMARK {
+            Score* score = new Score(mscore->baseStyle());
+            importMidi(score, path);
+            delete score;
+            }
+      QFile::remove(path);
+      }
 
 QTEST_MAIN(TestImportMidi)
 
@@ -14,6 +14,15 @@
 #include <QtTest/QtTest>
 #include "mtest/testutils.h"
 #include "libmscore/score.h"
+#include "libmscore/measure.h"
+#include "libmscore/segment.h"
+#include "libmscore/chord.h"
+#include "libmscore/note.h"
+#include "libmscore/undo.h"
+#include "libmscore/page.h"
+#include "libmscore/system.h"
+#include "libmscore/midicache.h"
+#include "synthesizer/event.h"
 
 #define DIR QString("libmscore/layout/")
 
@@ -33,12 +42,24 @@ class TestBenchmark : public QObject, public MTest
 
       Score* score;
       void beam(const char* path);
+      Chord* middleChord();
+      void editNote(Chord*, bool add);
 
    private slots:
       void initTestCase();
       void benchmark3();
       void benchmark1();
       void benchmark2();
+      void benchmark4_data();
+      void benchmark4();
+      void incrementalLayout();
+      void benchmark5_data();
+      void benchmark5();
+      void benchmark6();
+      void benchmark7_data();
+      void benchmark7();
+      void benchmark8_data();
+      void benchmark8();
       };
 
 //---------------------------------------------------------
@@ -82,6 +103,292 @@ void TestBenchmark::benchmark2()
             }
       }
 
+//---------------------------------------------------------
+//   layoutState
+//    system, page and position of every measure
+//---------------------------------------------------------
+
+static QStringList layoutState(Score* score)
+      {
+      QStringList state;
+      for (Measure* m = score->firstMeasureMM(); m; m = m->nextMeasureMM()) {
+            System* system = m->system();
+            state.append(QString("%1: system %2 page %3 x %4 y %5 width %6")
+               .arg(m->no())
+               .arg(score->systems()->indexOf(system))
+               .arg(score->pages().indexOf(system->page()))
+               .arg(m->pagePos().x())
+               .arg(m->pagePos().y())
+               .arg(m->width()));
+            }
+      return state;
+      }
+
+//---------------------------------------------------------
+//   middleChord
+//    first chord of the middle measure
+//---------------------------------------------------------
+
+Chord* TestBenchmark::middleChord()
+      {
+      Measure* m = score->firstMeasure();
+      for (int i = 0; i < score->nmeasures() / 2; ++i)
+            m = m->nextMeasure();
+      for (Segment* s = m->first(Segment::Type::ChordRest); s; s = s->next1(Segment::Type::ChordRest)) {
+            if (s->element(0) && s->element(0)->type() == Element::Type::CHORD)
+                  return static_cast<Chord*>(s->element(0));
+            }
+      return 0;
+      }
+
+//---------------------------------------------------------
+//   editNote
+//    single note edit in the middle of the score: enter a
+//    note into the chord or change the pitch of its top
+//    note, then undo it so that every run starts from the
+//    same score
+//---------------------------------------------------------
+
+void TestBenchmark::editNote(Chord* chord, bool add)
+      {
+      Note* note = chord->upNote();
+      score->startCmd();
+      if (add) {
+            NoteVal nval(note->pitch() + 3);
+            score->addNote(chord, nval);
+            }
+      else
+            score->undoChangePitch(note, note->pitch() + 2, note->tpc1(), note->tpc2());
+      score->endCmd();
+      score->undo()->undo();
+      score->endUndoRedo();
+      }
+
+//---------------------------------------------------------
+//   benchmark4
+//    layout after a single note edit and its undo, full
+//    vs. incremental
+//---------------------------------------------------------
+
+void TestBenchmark::benchmark4_data()
+      {
+      QTest::addColumn<bool>("incremental");
+      QTest::addColumn<bool>("add");
+      QTest::newRow("full pitch")        << false << false;
+      QTest::newRow("incremental pitch") << true  << false;
+      QTest::newRow("full note")         << false << true;
+      QTest::newRow("incremental note")  << true  << true;
+      }
+
+void TestBenchmark::benchmark4()
+      {
+      QFETCH(bool, incremental);
+      QFETCH(bool, add);
+      score = readScore(DIR + "goldberg.mscx");
+      score->doLayout();
+      Chord* chord = middleChord();
+      QVERIFY(chord);
+      const int notes = chord->notes().size();
+      const int pitch = chord->upNote()->pitch();
+      QStringList state = layoutState(score);
+      bool saved = MScore::incrementalLayout;
+      MScore::incrementalLayout = incremental;
+      QBENCHMARK {
+            editNote(chord, add);
+            }
+      MScore::incrementalLayout = saved;
+      QCOMPARE(chord->notes().size(), notes);
+      QCOMPARE(chord->upNote()->pitch(), pitch);
+      QCOMPARE(layoutState(score), state);
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   incrementalLayout
+//    after an edit which widens some measures, and after
+//    its undo, the incremental layout of systems and pages
+//    is the same as a full layout
+//---------------------------------------------------------
+
+void TestBenchmark::incrementalLayout()
+      {
+      score = readScore(DIR + "goldberg.mscx");
+      score->doLayout();
+      QStringList state = layoutState(score);
+      Chord* chord = middleChord();
+      QVERIFY(chord);
+
+      bool saved = MScore::incrementalLayout;
+      MScore::incrementalLayout = true;
+      score->startCmd();
+      Measure* m = chord->measure();
+      for (Segment* s = m->first(Segment::Type::ChordRest); s; s = s->next(Segment::Type::ChordRest)) {
+            ChordRest* cr = static_cast<ChordRest*>(s->element(0));
+            if (cr && cr->type() == Element::Type::CHORD) {
+                  Chord* c = static_cast<Chord*>(cr);
+                  NoteVal nval(c->downNote()->pitch() - 1);
+                  score->addNote(c, nval);
+                  }
+            }
+      score->endCmd();
+      QStringList incremental = layoutState(score);
+
+      MScore::incrementalLayout = false;
+      score->doLayout();
+      QCOMPARE(incremental, layoutState(score));
+
+      MScore::incrementalLayout = true;
+      score->undo()->undo();
+      score->endUndoRedo();
+      MScore::incrementalLayout = saved;
+      QCOMPARE(layoutState(score), state);
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   benchmark5
+//    spatial index queries: hit tests and viewport sized
+//    rectangles over every page, as done by paint and
+//    elementNear()
+//---------------------------------------------------------
+
+void TestBenchmark::benchmark5_data()
+      {
+      QTest::addColumn<QString>("file");
+      QTest::addColumn<bool>("visit");
+      QTest::newRow("goldberg list")   << QString(DIR + "goldberg.mscx")       << false;
+      QTest::newRow("goldberg visit")  << QString(DIR + "goldberg.mscx")       << true;
+      QTest::newRow("gonville list")   << QString("../vtest/gonville-10.mscz") << false;
+      QTest::newRow("gonville visit")  << QString("../vtest/gonville-10.mscz") << true;
+      QTest::newRow("beams list")      << QString("../vtest/beams-14.mscz")    << false;
+      QTest::newRow("beams visit")     << QString("../vtest/beams-14.mscz")    << true;
+      }
+
+void TestBenchmark::benchmark5()
+      {
+      QFETCH(QString, file);
+      QFETCH(bool, visit);
+      score = readScore(file);
+      QVERIFY(score);
+      score->doLayout();
+      const int n = 16;
+      int found   = 0;
+      QBENCHMARK {
+            for (Page* page : score->pages()) {
+                  QRectF r(page->abbox());
+                  qreal w = r.width() / n;
+                  qreal h = r.height() / n;
+                  for (int row = 0; row < n; ++row) {
+                        for (int col = 0; col < n; ++col) {
+                              QRectF q(r.x() + col * w, r.y() + row * h, w * 4, h * 2);
+                              if (visit)
+                                    page->visitItems(q, [&found](Element*) { ++found; });
+                              else
+                                    found += page->items(q).size();
+                              found += page->items(q.center()).size();
+                              }
+                        }
+                  }
+            }
+      QVERIFY(found > 0);
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   benchmark6
+//    complete playback rendering
+//---------------------------------------------------------
+
+void TestBenchmark::benchmark6()
+      {
+      score = readScore(DIR + "goldberg.mscx");
+      QVERIFY(score);
+      score->doLayout();
+      QBENCHMARK {
+            EventMap events;
+            score->midiCache()->clear();
+            score->renderMidi(&events);
+            }
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   benchmark7
+//    walk the playlist as the sequencer does: seek to
+//    the start of every measure and play some events;
+//    compares the event array with a std::multimap
+//---------------------------------------------------------
+
+void TestBenchmark::benchmark7_data()
+      {
+      QTest::addColumn<bool>("multimap");
+      QTest::newRow("array")    << false;
+      QTest::newRow("multimap") << true;
+      }
+
+void TestBenchmark::benchmark7()
+      {
+      QFETCH(bool, multimap);
+      score = readScore(DIR + "goldberg.mscx");
+      QVERIFY(score);
+      score->doLayout();
+      EventMap events;
+      score->renderMidi(&events);
+      std::multimap<int, NPlayEvent> mm(events.begin(), events.end());
+      QVector<int> seeks;
+      for (Measure* m = score->firstMeasure(); m; m = m->nextMeasure())
+            seeks.append(m->tick());
+
+      int sum = 0;
+      QBENCHMARK {
+            for (int tick : seeks) {
+                  if (multimap) {
+                        auto i = mm.lower_bound(tick);
+                        for (int k = 0; k < 64 && i != mm.cend(); ++k, ++i)
+                              sum += i->second.dataA();
+                        }
+                  else {
+                        auto i = events.lower_bound(tick);
+                        for (int k = 0; k < 64 && i != events.cend(); ++k, ++i)
+                              sum += i->second.dataA();
+                        }
+                  }
+            }
+      QVERIFY(sum != 0);
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   benchmark8
+//    save throughput: write the score as uncompressed
+//    xml into memory
+//---------------------------------------------------------
+
+void TestBenchmark::benchmark8_data()
+      {
+      QTest::addColumn<QString>("file");
+      QTest::newRow("goldberg") << QString(DIR + "goldberg.mscx");
+      QTest::newRow("gonville") << QString("../vtest/gonville-10.mscz");
+      QTest::newRow("beams")    << QString("../vtest/beams-14.mscz");
+      }
+
+void TestBenchmark::benchmark8()
+      {
+      QFETCH(QString, file);
+      score = readScore(file);
+      QVERIFY(score);
+      score->doLayout();
+      qint64 size = 0;
+      QBENCHMARK {
+            QBuffer buffer;
+            buffer.open(QIODevice::WriteOnly);
+            score->saveFile(&buffer, false);
+            size = buffer.size();
+            }
+      QVERIFY(size > 0);
+      delete score;
+      }
+
 QTEST_MAIN(TestBenchmark)
 #include "tst_benchmark.moc"
 
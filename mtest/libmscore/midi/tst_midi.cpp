@@ -23,6 +23,8 @@
 #include "libmscore/chord.h"
 #include "libmscore/note.h"
 #include "libmscore/keysig.h"
+#include "libmscore/midicache.h"
+#include "libmscore/undo.h"
 #include "mscore/exportmidi.h"
 #include <QIODevice>
 
@@ -51,6 +53,7 @@ class TestMidi : public QObject, public MTest
       void midi03();
       void events_data();
       void events();
+      void incrementalRender();
       };
 
 //---------------------------------------------------------
@@ -369,6 +372,91 @@ void TestMidi::events()
      // QVERIFY(saveCompareScore(score, writeFile, reference));
       }
 
+//---------------------------------------------------------
+//   sameEvents
+//---------------------------------------------------------
+
+static bool sameEvents(const EventMap& e1, const EventMap& e2)
+      {
+      if (e1.size() != e2.size())
+            return false;
+      for (auto i1 = e1.begin(), i2 = e2.begin(); i1 != e1.end(); ++i1, ++i2) {
+            if (i1->first != i2->first || !(i1->second == i2->second))
+                  return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   incrementalRender
+//    render after a pitch change in one measure must
+//    only render the changed measures and match a
+//    complete render
+//---------------------------------------------------------
+
+void TestMidi::incrementalRender()
+      {
+      Score* score = readScore(DIR + "testKantataBWV140Excerpts.mscx");
+      score->doLayout();
+      MidiCache* cache = score->midiCache();
+      EventMap events1;
+      score->renderMidi(&events1);
+      int fragments = cache->size();
+      QVERIFY(fragments > 0);
+      QCOMPARE(cache->rendered(), fragments);
+      QCOMPARE(cache->reused(), 0);
+
+      // a note in the middle of the score
+      Note* note = 0;
+      Measure* m = score->tick2measure(score->lastMeasure()->tick() / 2);
+      for (Segment* s = m->first(Segment::Type::ChordRest); s && !note; s = s->next1(Segment::Type::ChordRest)) {
+            Element* e = s->element(0);
+            if (e && e->type() == Element::Type::CHORD)
+                  note = static_cast<Chord*>(e)->upNote();
+            }
+      QVERIFY(note);
+      m = note->chord()->measure();
+
+      score->startCmd();
+      score->undoChangePitch(note, note->pitch() + 2, note->tpc1(), note->tpc2());
+      score->endCmd();
+
+      // only the measure of the note is invalid
+      int stick;
+      int etick;
+      QVERIFY(cache->valid());
+      QVERIFY(cache->dirtyRange(&stick, &etick));
+      QCOMPARE(stick, m->tick());
+      QCOMPARE(etick, m->endTick());
+
+      EventMap events2;
+      score->renderMidi(&events2);
+      QVERIFY(!sameEvents(events1, events2));
+
+      // the changed measure and its neighbours are rendered,
+      // the fragments of all other measures are reused
+      QCOMPARE(cache->size(), fragments);
+      QCOMPARE(cache->rendered() + cache->reused(), fragments);
+      QVERIFY(cache->rendered() >= score->nstaves());
+      QVERIFY(cache->rendered() < fragments / 2);
+
+      cache->clear();
+      EventMap events3;
+      score->renderMidi(&events3);
+      QVERIFY(sameEvents(events2, events3));
+      QCOMPARE(cache->rendered(), fragments);
+
+      score->undo()->undo();
+      score->endUndoRedo();
+      QVERIFY(cache->valid());
+      EventMap events4;
+      score->renderMidi(&events4);
+      QVERIFY(sameEvents(events1, events4));
+      QVERIFY(cache->reused() > 0);
+
+      delete score;
+      }
+
 QTEST_MAIN(TestMidi)
 
 #include "tst_midi.moc"
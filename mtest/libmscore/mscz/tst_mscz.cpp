@@ -0,0 +1,133 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "libmscore/mscore.h"
+#include "libmscore/score.h"
+#include "libmscore/audio.h"
+#include "libmscore/imageStore.h"
+#include "libmscore/scorearchive.h"
+#include "thirdparty/qzip/qzipwriter_p.h"
+#include "mtest/testutils.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestMscz
+//---------------------------------------------------------
+
+class TestMscz : public QObject, public MTest
+      {
+      Q_OBJECT
+
+   private slots:
+      void initTestCase();
+      void lazyPictures();
+      void lazyAudio();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestMscz::initTestCase()
+      {
+      initMTest();
+      }
+
+//---------------------------------------------------------
+//   hashName
+//---------------------------------------------------------
+
+static QString hashName(const QByteArray& data, const QString& suffix)
+      {
+      return QString(QCryptographicHash::hash(data, QCryptographicHash::Md4).toHex()) + "." + suffix;
+      }
+
+//---------------------------------------------------------
+//   lazyPictures
+//    pictures are added without decompressing them and
+//    keep their store name
+//---------------------------------------------------------
+
+void TestMscz::lazyPictures()
+      {
+      QByteArray picture1(1000, 'a');
+      QByteArray picture2("not stored under its hash");
+      QString name1 = hashName(picture1, "png");
+
+      QByteArray zip;
+      QBuffer b(&zip);
+      b.open(QIODevice::WriteOnly);
+      MQZipWriter uz(&b);
+      uz.addFile("Pictures/" + name1, picture1);
+      uz.addFile("Pictures/picture2.png", picture2);
+      uz.close();
+      b.close();
+
+      QSharedPointer<ScoreArchive> archive(new ScoreArchive(zip));
+      ImageStoreItem* item1 = imageStore.add("Pictures/" + name1, archive);
+      ImageStoreItem* item2 = imageStore.add("Pictures/picture2.png", archive);
+
+      QVERIFY(item1->loaded());
+      QCOMPARE(item1->hashName(), name1);
+      QCOMPARE(imageStore.getImage(name1), item1);
+      QCOMPARE(imageStore.add("Pictures/" + name1, archive), item1);
+      QCOMPARE(item1->buffer(), picture1);
+      QCOMPARE(imageStore.add(name1, picture1), item1);
+
+      QCOMPARE(item2->buffer(), picture2);
+      QCOMPARE(item2->hashName(), hashName(picture2, "png"));
+      }
+
+//---------------------------------------------------------
+//   lazyAudio
+//    the archive is not kept open: a score can be saved
+//    over its own file before the audio was decompressed
+//---------------------------------------------------------
+
+void TestMscz::lazyAudio()
+      {
+      QByteArray ogg(4096, 0);
+      for (int i = 0; i < ogg.size(); ++i)
+            ogg[i] = char(i * 7);
+
+      Score* score = readScore("/test.mscx");
+      QVERIFY(score);
+      score->doLayout();
+      Audio* audio = new Audio;
+      audio->setData(ogg);
+      score->setAudio(audio);
+
+      QFileInfo fi(QDir::tempPath() + "/tst_mscz.mscz");
+      score->saveCompressedFile(fi, false);
+      delete score;
+
+      score = readCreatedScore(fi.filePath());
+      QVERIFY(score);
+      QVERIFY(score->audio());
+      score->doLayout();
+      score->saveCompressedFile(fi, false);
+      QCOMPARE(score->audio()->data(), ogg);
+      delete score;
+
+      score = readCreatedScore(fi.filePath());
+      QVERIFY(score);
+      QVERIFY(score->audio());
+      QCOMPARE(score->audio()->data(), ogg);
+      delete score;
+      QFile::remove(fi.filePath());
+      }
+
+QTEST_MAIN(TestMscz)
+#include "tst_mscz.moc"
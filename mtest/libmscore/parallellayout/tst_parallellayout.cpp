@@ -0,0 +1,100 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "libmscore/mscore.h"
+#include "libmscore/score.h"
+#include "libmscore/note.h"
+#include "libmscore/chord.h"
+#include "libmscore/segment.h"
+#include "mtest/testutils.h"
+
+#define DIR QString("libmscore/concertpitch/")
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestParallelLayout
+//---------------------------------------------------------
+
+class TestParallelLayout : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QList<QPointF> positions(Score*);
+
+   private slots:
+      void initTestCase();
+      void determinism();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestParallelLayout::initTestCase()
+      {
+      initMTest();
+      }
+
+//---------------------------------------------------------
+//   positions
+//    collect chord and note head positions of the score
+//---------------------------------------------------------
+
+QList<QPointF> TestParallelLayout::positions(Score* score)
+      {
+      QList<QPointF> pl;
+      for (Segment* s = score->firstSegment(Segment::Type::ChordRest); s; s = s->next1(Segment::Type::ChordRest)) {
+            for (int track = 0; track < score->ntracks(); ++track) {
+                  Element* e = s->element(track);
+                  if (!e || e->type() != Element::Type::CHORD)
+                        continue;
+                  Chord* chord = static_cast<Chord*>(e);
+                  pl.append(chord->pos());
+                  for (Note* note : chord->notes())
+                        pl.append(note->pos());
+                  }
+            }
+      return pl;
+      }
+
+//---------------------------------------------------------
+//   determinism
+//    parallel layout must give the same result as the
+//    serial layout
+//---------------------------------------------------------
+
+void TestParallelLayout::determinism()
+      {
+      MScore::parallelLayout = false;
+      Score* score = readScore(DIR + "concertpitchbenchmark.mscx");
+      score->doLayout();
+      QList<QPointF> serial = positions(score);
+      delete score;
+
+      MScore::parallelLayout = true;
+      score = readScore(DIR + "concertpitchbenchmark.mscx");
+      score->doLayout();
+      QList<QPointF> parallel = positions(score);
+      delete score;
+      MScore::parallelLayout = false;
+
+      QVERIFY(!serial.isEmpty());
+      QCOMPARE(parallel.size(), serial.size());
+      for (int i = 0; i < serial.size(); ++i)
+            QCOMPARE(parallel[i], serial[i]);
+      }
+
+QTEST_MAIN(TestParallelLayout)
+#include "tst_parallellayout.moc"
@@ -16,6 +16,7 @@
 #include "libmscore/score.h"
 #include "libmscore/measure.h"
 #include "libmscore/repeatlist.h"
+#include "libmscore/tempo.h"
 
 #define DIR QString("libmscore/repeat/")
 
@@ -63,7 +64,8 @@ class TestRepeat : public QObject, public MTest
       void repeat23() { repeat("repeat23.mscx", "1;2;1;2;3;2;3;4;5;6;7;6;7;8;9;10;11;9;10;12;12;13;14;13;14;15;16;13;14"); }
       
       void repeat24() { repeat("repeat24.mscx", "1;2;3;4;2;3;4;5;3;4;5;6"); } // imbricated DS and ||: :||
-      
+
+      void timeMap();
       };
 
 //---------------------------------------------------------
@@ -103,6 +105,90 @@ void TestRepeat::repeat(const char* f1, const QString & ref)
       delete score;
       }
 
+//---------------------------------------------------------
+//   linear scans of the repeat list, as done before the
+//   TimeMap
+//---------------------------------------------------------
+
+static int refTick2utick(const RepeatList* rl, int tick)
+      {
+      for (const RepeatSegment* s : *rl) {
+            if (tick >= s->tick && tick < (s->tick + s->len))
+                  return s->utick + (tick - s->tick);
+            }
+      return rl->last()->utick + (tick - rl->last()->tick);
+      }
+
+static qreal refUtick2utime(const RepeatList* rl, const TempoMap* tl, int tick)
+      {
+      int n = rl->size();
+      for (int i = 0; i < n; ++i) {
+            if ((tick >= rl->at(i)->utick) && ((i + 1 == n) || (tick < rl->at(i+1)->utick)))
+                  return tl->tick2time(tick - (rl->at(i)->utick - rl->at(i)->tick)) + rl->at(i)->timeOffset;
+            }
+      return 0.0;
+      }
+
+static int refUtime2utick(const RepeatList* rl, const TempoMap* tl, qreal t)
+      {
+      int n = rl->size();
+      for (int i = 0; i < n; ++i) {
+            if ((t >= rl->at(i)->utime) && ((i + 1 == n) || (t < rl->at(i+1)->utime)))
+                  return tl->time2tick(t - rl->at(i)->timeOffset) + (rl->at(i)->utick - rl->at(i)->tick);
+            }
+      return 0;
+      }
+
+//---------------------------------------------------------
+//   timeMap
+//    the binary searches of the TimeMap give the same
+//    results as linear scans, also with tempo changes,
+//    pauses and a relative tempo
+//---------------------------------------------------------
+
+void TestRepeat::timeMap()
+      {
+      Score* score = readScore(DIR + "repeat14.mscx");
+      QVERIFY(score);
+      score->doLayout();
+      score->setTempo(MScore::division * 10, 3.0);
+      score->setTempo(MScore::division * 37, 1.5);
+      score->setPause(MScore::division * 37, 0.75);
+      score->setTempo(MScore::division * 60, 2.25);
+      score->tempomap()->setRelTempo(1.2);
+      score->updateRepeatList(true);
+
+      const RepeatList* rl = score->repeatList();
+      const TempoMap* tl   = score->tempomap();
+      std::shared_ptr<const TimeMap> tm = rl->timeMap();
+      QCOMPARE(tm->tempoSN(), tl->tempoSN());
+
+      int ticks = rl->ticks();
+      for (int utick = 0; utick < ticks + MScore::division; utick += MScore::division / 8) {
+            QCOMPARE(tm->utick2utime(utick), refUtick2utime(rl, tl, utick));
+            int tick = tm->utick2tick(utick);
+            QCOMPARE(tm->tick2utick(tick), refTick2utick(rl, tick));
+            }
+      qreal endTime = score->utick2utime(ticks);
+      for (qreal t = 0.0; t < endTime + 1.0; t += 0.01)
+            QCOMPARE(tm->utime2utick(t), refUtime2utick(rl, tl, t));
+
+      // a tempo change through the score publishes a new map
+      score->setTempo(0, 4.0);
+      QVERIFY(rl->timeMap() != tm);
+      QCOMPARE(rl->timeMap()->tempoSN(), tl->tempoSN());
+
+      // reading the map never rebuilds it, changes to the tempo
+      // map itself are published by the next fixTicks()
+      tm = rl->timeMap();
+      score->tempomap()->setTempo(MScore::division * 20, 1.0);
+      QVERIFY(rl->timeMap() == tm);
+      QVERIFY(tm->tempoSN() != tl->tempoSN());
+      score->fixTicks();
+      QVERIFY(rl->timeMap() != tm);
+      QCOMPARE(rl->timeMap()->tempoSN(), tl->tempoSN());
+      delete score;
+      }
 
 QTEST_MAIN(TestRepeat)
 #include "tst_repeat.moc"
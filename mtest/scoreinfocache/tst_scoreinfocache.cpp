@@ -0,0 +1,227 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "mscore/scoreInfoCache.h"
+#include "thirdparty/qzip/qzipwriter_p.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestScoreInfoCache
+//---------------------------------------------------------
+
+class TestScoreInfoCache : public QObject
+      {
+      Q_OBJECT
+
+      QTemporaryDir dir;
+      int created;
+
+      QString cacheFile() const { return dir.path() + "/scoreinfo.cache"; }
+      std::function<QPixmap(const QString&)> create();
+
+   private slots:
+      void initTestCase();
+      void init();
+      void hit();
+      void modified();
+      void pendingLoad();
+      };
+
+//---------------------------------------------------------
+//   writeFile
+//---------------------------------------------------------
+
+static void writeFile(const QString& path, const QByteArray& data)
+      {
+      QFile f(path);
+      QVERIFY(f.open(QIODevice::WriteOnly));
+      QCOMPARE(f.write(data), qint64(data.size()));
+      }
+
+//---------------------------------------------------------
+//   writeMscz
+//    a compressed score containing only a thumbnail
+//---------------------------------------------------------
+
+static void writeMscz(const QString& path, const QColor& color)
+      {
+      QImage image(20, 30, QImage::Format_RGB32);
+      image.fill(color);
+      QByteArray png;
+      QBuffer b(&png);
+      b.open(QIODevice::WriteOnly);
+      image.save(&b, "PNG");
+      MQZipWriter uz(path);
+      uz.addFile("Thumbnails/thumbnail.png", png);
+      uz.close();
+      }
+
+//---------------------------------------------------------
+//   create
+//    counts the thumbnails made in the gui thread
+//---------------------------------------------------------
+
+std::function<QPixmap(const QString&)> TestScoreInfoCache::create()
+      {
+      return [this](const QString&) {
+            ++created;
+            QPixmap pm(20, 30);
+            pm.fill(Qt::red);
+            return pm;
+            };
+      }
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestScoreInfoCache::initTestCase()
+      {
+      QVERIFY(dir.isValid());
+      }
+
+//---------------------------------------------------------
+//   init
+//---------------------------------------------------------
+
+void TestScoreInfoCache::init()
+      {
+      created = 0;
+      QFile::remove(cacheFile());
+      }
+
+//---------------------------------------------------------
+//   hit
+//    a thumbnail is made once; it is found in the cache
+//    afterwards, also when the cache is reloaded from disk
+//---------------------------------------------------------
+
+void TestScoreInfoCache::hit()
+      {
+      QString path = dir.path() + "/hit.mscx";
+      writeFile(path, QByteArray(100, 'a'));
+      QFileInfo fi(path);
+      QPixmap pm;
+
+      ScoreInfoCache* cache = new ScoreInfoCache(cacheFile(), create());
+      QVERIFY(!cache->find(fi, &pm));
+      QVERIFY(!cache->thumbnail(fi).isNull());
+      QCOMPARE(created, 1);
+      QVERIFY(cache->find(fi, &pm));
+      QVERIFY(!pm.isNull());
+      QVERIFY(!cache->thumbnail(fi).isNull());
+      QCOMPARE(created, 1);
+      delete cache;                       // saves the pending entry
+
+      cache = new ScoreInfoCache(cacheFile(), create());
+      QCOMPARE(cache->size(), 1);
+      QVERIFY(cache->find(fi, &pm));
+      QCOMPARE(pm.size(), QSize(20, 30));
+      QCOMPARE(created, 1);
+      delete cache;
+
+      // thumbnails of .mscz files are extracted in background
+      QString mscz = dir.path() + "/hit.mscz";
+      writeMscz(mscz, Qt::blue);
+      QFileInfo msczInfo(mscz);
+      cache = new ScoreInfoCache(cacheFile(), create());
+      cache->request(msczInfo);
+      QTRY_VERIFY(cache->find(msczInfo, &pm));
+      QCOMPARE(pm.toImage().pixel(0, 0), QColor(Qt::blue).rgb());
+      QCOMPARE(created, 0);
+      delete cache;
+      }
+
+//---------------------------------------------------------
+//   modified
+//    an entry is not used once the modification time
+//    of its file changed, even if the size did not
+//---------------------------------------------------------
+
+void TestScoreInfoCache::modified()
+      {
+      QString path = dir.path() + "/modified.mscx";
+      QByteArray data(100, 'b');
+      writeFile(path, data);
+      QPixmap pm;
+
+      ScoreInfoCache* cache = new ScoreInfoCache(cacheFile(), create());
+      cache->thumbnail(QFileInfo(path));
+      QCOMPARE(created, 1);
+      QVERIFY(cache->find(QFileInfo(path), &pm));
+
+      QDateTime lastModified = QFileInfo(path).lastModified();
+      do {
+            QTest::qSleep(10);
+            writeFile(path, data);
+            } while (QFileInfo(path).lastModified() == lastModified);
+      QFileInfo fi(path);
+      QCOMPARE(fi.size(), qint64(data.size()));
+
+      QVERIFY(!cache->find(fi, &pm));
+      cache->thumbnail(fi);
+      QCOMPARE(created, 2);
+      QVERIFY(cache->find(fi, &pm));
+      delete cache;
+
+      // the saved entry is the one for the new modification time
+      cache = new ScoreInfoCache(cacheFile(), create());
+      QVERIFY(cache->find(fi, &pm));
+      QCOMPARE(created, 2);
+      delete cache;
+      }
+
+//---------------------------------------------------------
+//   pendingLoad
+//    the cache can be destroyed while files are queued
+//    for extraction; it waits for the background thread
+//---------------------------------------------------------
+
+void TestScoreInfoCache::pendingLoad()
+      {
+      QList<QFileInfo> files;
+      for (int i = 0; i < 50; ++i) {
+            QString path = dir.path() + QString("/pending%1.mscz").arg(i);
+            writeMscz(path, Qt::green);
+            files.append(QFileInfo(path));
+            }
+
+      ScoreInfoCache* cache = new ScoreInfoCache(cacheFile(), create());
+      QAtomicInt ready;
+      connect(cache, &ScoreInfoCache::thumbnailReady, this, [&ready](const QString&) { ready.ref(); }, Qt::DirectConnection);
+      for (const QFileInfo& fi : files)
+            cache->request(fi);
+      delete cache;
+
+      // nothing runs after the destructor returned
+      int n = ready.load();
+      QVERIFY(n <= files.size());
+      QTest::qWait(100);
+      QCOMPARE(ready.load(), n);
+
+      // the entries extracted before are valid
+      cache = new ScoreInfoCache(cacheFile(), create());
+      QVERIFY(cache->size() <= n);
+      QPixmap pm;
+      for (const QFileInfo& fi : files) {
+            if (cache->find(fi, &pm))
+                  QVERIFY(!pm.isNull());
+            }
+      QCOMPARE(created, 0);
+      delete cache;
+      }
+
+QTEST_MAIN(TestScoreInfoCache)
+#include "tst_scoreinfocache.moc"
@@ -0,0 +1,234 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2016 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "fluid/dspkernels.h"
+#include "mtest/testutils.h"
+
+using namespace FluidS;
+using namespace Ms;
+
+Q_DECLARE_METATYPE(FluidS::DspKernels::Type)
+
+//---------------------------------------------------------
+//   TestFluidDsp
+//    the SIMD voice kernels against the scalar ones
+//---------------------------------------------------------
+
+class TestFluidDsp : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      static const int SAMPLES = 1 << 16;
+      static const int TAPS    = 7;
+      std::vector<short> data;
+      std::vector<float> table;
+
+      void addKernelRows();
+      void compare(const float* a, const float* b, unsigned n);
+
+   private slots:
+      void initTestCase();
+      void frames();
+      void interpolate_data();
+      void interpolate();
+      void mix_data();
+      void mix();
+      void voicesPerCore_data();
+      void voicesPerCore();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//    random sample points and coefficients, including the
+//    extreme values
+//---------------------------------------------------------
+
+void TestFluidDsp::initTestCase()
+      {
+      initMTest();
+      qsrand(1);
+      data.resize(SAMPLES);
+      for (short& s : data)
+            s = qrand() % 65536 - 32768;
+      data[100] = -32768;
+      data[101] = 32767;
+      table.resize(FLUID_INTERP_MAX * TAPS);
+      for (float& f : table)
+            f = qrand() / float(RAND_MAX) * 2.0f - 1.0f;
+      }
+
+//---------------------------------------------------------
+//   addKernelRows
+//---------------------------------------------------------
+
+void TestFluidDsp::addKernelRows()
+      {
+      QTest::addColumn<DspKernels::Type>("type");
+      QTest::newRow("sse2") << DspKernels::Type::SSE2;
+      QTest::newRow("avx2") << DspKernels::Type::AVX2;
+      }
+
+//---------------------------------------------------------
+//   compare
+//    the kernels compute the same sums in the same order;
+//    the tolerance only allows for a compiler contracting
+//    multiply and add differently
+//---------------------------------------------------------
+
+void TestFluidDsp::compare(const float* a, const float* b, unsigned n)
+      {
+      for (unsigned i = 0; i < n; ++i) {
+            float tolerance = 1e-5f * qMax(1.0f, qAbs(b[i]));
+            if (qAbs(a[i] - b[i]) > tolerance)
+                  QFAIL(qPrintable(QString("frame %1: %2 != %3").arg(i).arg(a[i]).arg(b[i])));
+            }
+      }
+
+//---------------------------------------------------------
+//   frames
+//---------------------------------------------------------
+
+void TestFluidDsp::frames()
+      {
+      Phase one;
+      one.setInt(1);
+      Phase p;
+      p.setInt(10);
+      QCOMPARE(DspKernels::frames(p, one, 20, 64), 11u);
+      QCOMPARE(DspKernels::frames(p, one, 20, 5), 5u);
+      QCOMPARE(DspKernels::frames(p, one, 9, 64), 0u);
+      Phase two;
+      two.setInt(2);
+      p.data += 1;
+      QCOMPARE(DspKernels::frames(p, two, 20, 64), 6u);
+      Phase slow;
+      slow.setFloat(0.25);
+      QCOMPARE(DspKernels::frames(p, slow, 10, 64), 4u);
+      }
+
+//---------------------------------------------------------
+//   interpolate
+//---------------------------------------------------------
+
+void TestFluidDsp::interpolate_data()
+      {
+      addKernelRows();
+      }
+
+void TestFluidDsp::interpolate()
+      {
+      QFETCH(DspKernels::Type, type);
+      const DspKernels* k = DspKernels::get(type);
+      if (!k)
+            QSKIP("not supported on this cpu");
+      const DspKernels* s = DspKernels::get(DspKernels::Type::SCALAR);
+
+      const unsigned n = 4099;      // not a multiple of the vector size
+      std::vector<float> out1(n), out2(n);
+      for (double speed : { 0.13, 0.5, 1.0, 1.7, 3.95 }) {
+            for (int order = 0; order < 3; ++order) {
+                  DspKernels::Interpolate f1 = order == 0 ? s->linear : order == 1 ? s->fourthOrder : s->seventhOrder;
+                  DspKernels::Interpolate f2 = order == 0 ? k->linear : order == 1 ? k->fourthOrder : k->seventhOrder;
+                  Phase incr;
+                  incr.setFloat(speed);
+                  Phase p1, p2;
+                  p1.setFloat(7.3);
+                  p2 = p1;
+                  float a1 = 0.25f;
+                  float a2 = a1;
+                  f1(data.data(), table.data(), &p1, incr.data, &a1, 1e-5f, out1.data(), n);
+                  f2(data.data(), table.data(), &p2, incr.data, &a2, 1e-5f, out2.data(), n);
+                  QCOMPARE(p2.data, p1.data);
+                  QCOMPARE(a2, a1);
+                  compare(out2.data(), out1.data(), n);
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   mix
+//---------------------------------------------------------
+
+void TestFluidDsp::mix_data()
+      {
+      addKernelRows();
+      }
+
+void TestFluidDsp::mix()
+      {
+      QFETCH(DspKernels::Type, type);
+      const DspKernels* k = DspKernels::get(type);
+      if (!k)
+            QSKIP("not supported on this cpu");
+      const DspKernels* s = DspKernels::get(DspKernels::Type::SCALAR);
+
+      const unsigned n = 63;
+      std::vector<float> in(n);
+      for (unsigned i = 0; i < n; ++i)
+            in[i] = data[i] / 32768.0f;
+      std::vector<float> b1(n * 6, 0.5f), b2(n * 6, 0.5f);
+      s->mix(in.data(), n, 0.3f, 0.7f, 0.2f, 0.1f, &b1[0], &b1[n * 2], &b1[n * 4]);
+      k->mix(in.data(), n, 0.3f, 0.7f, 0.2f, 0.1f, &b2[0], &b2[n * 2], &b2[n * 4]);
+      compare(b2.data(), b1.data(), n * 6);
+      }
+
+//---------------------------------------------------------
+//   voicesPerCore
+//    render one second of 64 voices with cubic
+//    interpolation and mixing; the number of voices a
+//    single core could render in realtime is printed
+//---------------------------------------------------------
+
+void TestFluidDsp::voicesPerCore_data()
+      {
+      QTest::addColumn<DspKernels::Type>("type");
+      QTest::newRow("scalar") << DspKernels::Type::SCALAR;
+      QTest::newRow("sse2")   << DspKernels::Type::SSE2;
+      QTest::newRow("avx2")   << DspKernels::Type::AVX2;
+      }
+
+void TestFluidDsp::voicesPerCore()
+      {
+      QFETCH(DspKernels::Type, type);
+      const DspKernels* k = DspKernels::get(type);
+      if (!k)
+            QSKIP("not supported on this cpu");
+
+      const int VOICES     = 64;
+      const int SAMPLERATE = 44100;
+      const unsigned BLOCK = 64;
+      float buf[BLOCK];
+      std::vector<float> out(BLOCK * 2), reverb(BLOCK * 2), chorus(BLOCK * 2);
+
+      QElapsedTimer timer;
+      timer.start();
+      for (int voice = 0; voice < VOICES; ++voice) {
+            Phase p;
+            p.setInt(8);
+            Phase incr;
+            incr.setFloat(0.5 + voice / 32.0);
+            float amp = 0.5f;
+            for (int frame = 0; frame < SAMPLERATE; frame += BLOCK) {
+                  if (p.index() > SAMPLES - 1024)
+                        p.setInt(8);
+                  k->fourthOrder(data.data(), table.data(), &p, incr.data, &amp, 0.0f, buf, BLOCK);
+                  k->mix(buf, BLOCK, 0.5f, 0.5f, 0.2f, 0.1f, out.data(), reverb.data(), chorus.data());
+                  }
+            }
+      qint64 ms = qMax(timer.elapsed(), qint64(1));
+      qDebug("%s: %d voices per core", k->name, int(VOICES * 1000 / ms));
+      }
+
+QTEST_MAIN(TestFluidDsp)
+#include "tst_fluiddsp.moc"
@@ -0,0 +1,424 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2016 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include <QtEndian>
+#include <thread>
+
+#include "fluid/fluid.h"
+#include "fluid/sfont.h"
+#include "fluid/samplepool.h"
+#include "fluid/sampleloader.h"
+#include "fluid/voice.h"
+#include "mtest/testutils.h"
+
+using namespace FluidS;
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestFluid
+//    makes soundfont loading accessible to the tests
+//---------------------------------------------------------
+
+class TestFluid : public Fluid {
+   public:
+      using Fluid::sfload;
+      };
+
+//---------------------------------------------------------
+//   TestFluidPool
+//    sample data shared between synthesizer instances and
+//    streamed into voices; requests from other threads
+//    while process() runs
+//---------------------------------------------------------
+
+class TestFluidPool : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      static const int SAMPLERATE = 44100;
+
+      QTemporaryDir dir;
+
+      QString writeSoundFont(const QList<int>& frames);
+      void loadShared(const QString& path, int maxSamples, bool decoded);
+
+   private slots:
+      void initTestCase();
+      void sf2();
+      void sf3();
+      void streaming();
+      void overflow();
+      void crossThread();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestFluidPool::initTestCase()
+      {
+      initMTest();
+      QVERIFY(dir.isValid());
+      }
+
+//---------------------------------------------------------
+//   chunk
+//    a RIFF chunk; LIST chunks get their type in front
+//    of the data
+//---------------------------------------------------------
+
+static QByteArray chunk(const char* id, const QByteArray& data, const char* type = 0)
+      {
+      QByteArray body = type ? QByteArray(type, 4) + data : data;
+      uchar size[4];
+      qToLittleEndian(quint32(body.size()), size);
+      return QByteArray(id, 4) + QByteArray((const char*)size, 4) + body;
+      }
+
+//---------------------------------------------------------
+//   writeSoundFont
+//    write a sf2 file with one mono sample per entry of
+//    frames and neither instruments nor presets
+//---------------------------------------------------------
+
+QString TestFluidPool::writeSoundFont(const QList<int>& frames)
+      {
+      QByteArray info;
+      QDataStream ds(&info, QIODevice::WriteOnly);
+      ds.setByteOrder(QDataStream::LittleEndian);
+      ds << quint16(2) << quint16(1);
+
+      QByteArray smpl;
+      QDataStream ss(&smpl, QIODevice::WriteOnly);
+      ss.setByteOrder(QDataStream::LittleEndian);
+      for (int n : frames) {
+            for (int i = 0; i < n; ++i)
+                  ss << qint16((i % 100 - 50) * 200);
+            for (int i = 0; i < 46; ++i)  // the spec asks for 46 zero frames after each sample
+                  ss << qint16(0);
+            }
+
+      QByteArray shdr;
+      QDataStream sh(&shdr, QIODevice::WriteOnly);
+      sh.setByteOrder(QDataStream::LittleEndian);
+      quint32 start = 0;
+      for (int n : frames) {
+            sh.writeRawData(QByteArray("sample").leftJustified(20, '\0').constData(), 20);
+            sh << start << quint32(start + n) << quint32(start + 8) << quint32(start + n - 8)
+               << quint32(SAMPLERATE) << quint8(60) << qint8(0) << quint16(0) << quint16(1);
+            start += n + 46;
+            }
+      sh.writeRawData(QByteArray("EOS").leftJustified(46, '\0').constData(), 46);
+
+      QByteArray pdta = chunk("phdr", QByteArray("EOP").leftJustified(38, '\0'))
+         + chunk("pbag", QByteArray(4, '\0'))
+         + chunk("pmod", QByteArray(10, '\0'))
+         + chunk("pgen", QByteArray(4, '\0'))
+         + chunk("inst", QByteArray("EOI").leftJustified(22, '\0'))
+         + chunk("ibag", QByteArray(4, '\0'))
+         + chunk("imod", QByteArray(10, '\0'))
+         + chunk("igen", QByteArray(4, '\0'))
+         + chunk("shdr", shdr);
+
+      QByteArray body = chunk("LIST", chunk("ifil", info), "INFO")
+         + chunk("LIST", chunk("smpl", smpl), "sdta")
+         + chunk("LIST", pdta, "pdta");
+
+      QString path = dir.path() + "/pool.sf2";
+      QFile f(path);
+      if (!f.open(QIODevice::WriteOnly) || f.write(chunk("RIFF", body, "sfbk")) < 0)
+            return QString();
+      return path;
+      }
+
+//---------------------------------------------------------
+//   loadShared
+//    load the first maxSamples samples of the soundfont
+//    in two synthesizer instances; both must use the same
+//    data, which is released with the last instance
+//---------------------------------------------------------
+
+void TestFluidPool::loadShared(const QString& path, int maxSamples, bool decoded)
+      {
+      SamplePool* pool = SamplePool::instance();
+      int files        = pool->mappedFiles();
+      int samples      = pool->decodedSamples();
+
+      TestFluid* fluid1 = new TestFluid;
+      fluid1->init(SAMPLERATE);
+      TestFluid* fluid2 = new TestFluid;
+      fluid2->init(SAMPLERATE);
+
+      SFont* sf1 = fluid1->sfload(path);
+      SFont* sf2 = fluid2->sfload(path);
+      QVERIFY(sf1);
+      QVERIFY(sf2);
+      QCOMPARE(sf1->map(), sf2->map());
+      QCOMPARE(pool->mappedFiles(), files + 1);
+
+      int n = qMin(maxSamples, sf1->samples().size());
+      QVERIFY(n > 0);
+      QCOMPARE(sf2->samples().size(), sf1->samples().size());
+      for (int i = 0; i < n; ++i) {
+            Sample* s1 = sf1->samples()[i];
+            Sample* s2 = sf2->samples()[i];
+            s1->load();
+            s2->load();
+            QVERIFY(s1->loaded());
+            QVERIFY(s2->loaded());
+            QVERIFY(s1->data.load() != 0);
+            QCOMPARE(s2->data.load(), s1->data.load());
+            QCOMPARE(s2->available(), s1->available());
+            }
+      QCOMPARE(pool->decodedSamples(), samples + (decoded ? n : 0));
+
+      // the data stays valid while the second instance uses it
+      delete sf1;
+      delete fluid1;
+      QCOMPARE(pool->mappedFiles(), files + 1);
+      QCOMPARE(pool->decodedSamples(), samples + (decoded ? n : 0));
+      Sample* last = sf2->samples()[n - 1];
+      const short* p = last->data;
+      volatile short sink = p[0] + p[last->available() - 1];
+      Q_UNUSED(sink);
+
+      delete sf2;
+      delete fluid2;
+      QCOMPARE(pool->mappedFiles(), files);
+      QCOMPARE(pool->decodedSamples(), samples);
+      }
+
+//---------------------------------------------------------
+//   sf2
+//    samples are used in place in the shared mapping
+//---------------------------------------------------------
+
+void TestFluidPool::sf2()
+      {
+      if (QSysInfo::ByteOrder != QSysInfo::LittleEndian)
+            QSKIP("sf2 samples are only mapped on little endian hosts");
+      QString path = writeSoundFont({ 3000, 20000, 500 });
+      QVERIFY(!path.isEmpty());
+      loadShared(path, 3, false);
+      }
+
+//---------------------------------------------------------
+//   sf3
+//    samples are decoded once and pooled
+//---------------------------------------------------------
+
+void TestFluidPool::sf3()
+      {
+#ifdef SOUNDFONT3
+      QString path = root + "/../share/sound/FluidR3Mono_GM.sf3";
+      if (!QFileInfo(path).exists())
+            QSKIP("FluidR3Mono_GM.sf3 not found");
+      loadShared(path, 8, true);
+#else
+      QSKIP("built without SOUNDFONT3");
+#endif
+      }
+
+//---------------------------------------------------------
+//   streaming
+//    a voice plays the head of a sample which is not fully
+//    loaded, is held where the head ends and continues
+//    when the rest of the sample is loaded. The pitch is
+//    raised by the modulation envelope, so the voice reads
+//    faster than its unmodulated pitch suggests.
+//---------------------------------------------------------
+
+void TestFluidPool::streaming()
+      {
+      const unsigned FRAMES = 40000;
+      const unsigned BLOCK  = 64;
+      QString path = writeSoundFont({ int(FRAMES) });
+      QVERIFY(!path.isEmpty());
+
+      TestFluid* fluid = new TestFluid;
+      fluid->init(SAMPLERATE);
+      SFont* sf = fluid->sfload(path);
+      QVERIFY(sf);
+      Sample* s = sf->samples()[0];
+      s->loadHead();
+      QVERIFY(!s->loaded());
+      unsigned head = s->available();
+      QCOMPARE(head, unsigned(Sample::HEAD_FRAMES));
+
+      // the first event for channel 0 creates it
+      fluid->play(PlayEvent(ME_CONTROLLER, 0, CTRL_VOLUME, 127));
+      Voice* v = fluid->alloc_voice(0, s, 0, 60, 127, 0.0);
+      QVERIFY(v);
+      v->gen_set(GEN_MODENVTOPITCH, 2400.0f);         // two octaves up
+      fluid->start_voice(v);
+
+      std::vector<float> out(BLOCK * 2), reverb(BLOCK * 2), chorus(BLOCK * 2);
+      SampleLoader* loader = SampleLoader::instance();
+
+      // play the head until the voice stalls
+      int stalls = loader->statistics().stalls;
+      for (int i = 0; i < 1000 && loader->statistics().stalls == stalls; ++i) {
+            fluid->process(BLOCK, out.data(), reverb.data(), chorus.data());
+            QVERIFY(v->isPlaying());
+            QVERIFY(unsigned(v->phase.index()) < head);
+            }
+      QCOMPARE(loader->statistics().stalls, stalls + 1);
+      unsigned held = v->phase.index();
+      QVERIFY(held > head - BLOCK * 8);
+
+      // the voice stays where it is while the sample is missing
+      fluid->process(BLOCK, out.data(), reverb.data(), chorus.data());
+      QCOMPARE(loader->statistics().stalls, stalls + 2);
+      QCOMPARE(unsigned(v->phase.index()), held);
+      QVERIFY(v->isPlaying());
+
+      // and plays through the rest once it is loaded
+      s->load();
+      QVERIFY(s->loaded());
+      unsigned last = held;
+      for (int i = 0; i < 1000 && v->isPlaying(); ++i) {
+            last = v->phase.index();
+            fluid->process(BLOCK, out.data(), reverb.data(), chorus.data());
+            }
+      QVERIFY(!v->isPlaying());
+      QVERIFY(last > FRAMES - BLOCK * 8);
+      QCOMPARE(loader->statistics().stalls, stalls + 2);
+
+      delete sf;
+      delete fluid;
+      }
+
+//---------------------------------------------------------
+//   overflow
+//    requests which do not fit into the command fifo are
+//    applied with the next block, in order; no note stays
+//    on and the last program change wins
+//---------------------------------------------------------
+
+void TestFluidPool::overflow()
+      {
+      const unsigned BLOCK = 64;
+      QString path = writeSoundFont({ 20000 });
+      QVERIFY(!path.isEmpty());
+
+      TestFluid* fluid = new TestFluid;
+      fluid->init(SAMPLERATE);
+      SFont* sf = fluid->sfload(path);
+      QVERIFY(sf);
+      Sample* s = sf->samples()[0];
+      s->load();
+      std::vector<float> out(BLOCK * 2), reverb(BLOCK * 2), chorus(BLOCK * 2);
+
+      fluid->play(PlayEvent(ME_CONTROLLER, 0, CTRL_VOLUME, 127));
+      QList<Voice*> voices;
+      for (int key = 60; key < 64; ++key) {
+            Voice* v = fluid->alloc_voice(0, s, 0, key, 127, 0.0);
+            QVERIFY(v);
+            fluid->start_voice(v);
+            voices.append(v);
+            }
+      // from now on requests are posted to process()
+      fluid->process(BLOCK, out.data(), reverb.data(), chorus.data());
+      for (Voice* v : voices)
+            QVERIFY(v->ON());
+
+      for (int i = 0; i < FLUID_CMD_FIFO_SIZE * 2; ++i)
+            fluid->play(PlayEvent(ME_CONTROLLER, 0, CTRL_EXPRESSION, i & 0x7f));
+      for (int key = 60; key < 64; ++key)
+            fluid->play(PlayEvent(ME_NOTEON, 0, key, 0));
+      fluid->play(PlayEvent(ME_CONTROLLER, 0, CTRL_PROGRAM, 5));
+      for (Voice* v : voices)
+            QVERIFY(v->ON());
+
+      fluid->process(BLOCK, out.data(), reverb.data(), chorus.data());
+      for (Voice* v : voices)
+            QVERIFY(!v->ON());
+      unsigned sfontId, bank, program;
+      fluid->get_program(0, &sfontId, &bank, &program);
+      QCOMPARE(program, 5u);
+      QCOMPARE(fluid->get_cc(0, CTRL_EXPRESSION), (FLUID_CMD_FIFO_SIZE * 2 - 1) & 0x7f);
+
+      delete sf;
+      delete fluid;
+      }
+
+//---------------------------------------------------------
+//   crossThread
+//    program changes and soundfont changes from this
+//    thread while other threads render; every few blocks
+//    are rendered by a new thread
+//---------------------------------------------------------
+
+void TestFluidPool::crossThread()
+      {
+      const unsigned BLOCK = 64;
+      const int CHANNELS   = 16;
+      const int CHANGES    = 400;
+      QString path = writeSoundFont({ 3000 });
+      QVERIFY(!path.isEmpty());
+      QString name = QFileInfo(path).fileName();
+
+      TestFluid* fluid = new TestFluid;
+      fluid->init(SAMPLERATE);
+      for (int ch = 0; ch < CHANNELS; ++ch)
+            fluid->play(PlayEvent(ME_CONTROLLER, ch, CTRL_VOLUME, 100));
+
+      std::atomic<bool> stop { false };
+      std::atomic<int> blocks { 0 };
+      std::thread renderer([&]() {
+            std::vector<float> out(BLOCK * 2), reverb(BLOCK * 2), chorus(BLOCK * 2);
+            while (!stop) {
+                  std::thread t([&]() {
+                        for (int i = 0; i < 8; ++i) {
+                              fluid->process(BLOCK, out.data(), reverb.data(), chorus.data());
+                              ++blocks;
+                              }
+                        });
+                  t.join();
+                  }
+            });
+      while (blocks == 0)
+            QThread::yieldCurrentThread();
+
+      int failed = 0;
+      for (int i = 0; i < CHANGES; ++i) {
+            fluid->play(PlayEvent(ME_CONTROLLER, i % CHANNELS, CTRL_PROGRAM, i & 0x7f));
+            if (i % 20 == 0 && !fluid->addSoundFont(path))
+                  ++failed;
+            else if (i % 20 == 10 && !fluid->removeSoundFont(name))
+                  ++failed;
+            if (i % 50 == 0) {
+                  int b = blocks;
+                  while (blocks == b)
+                        QThread::yieldCurrentThread();
+                  }
+            }
+      stop = true;
+      renderer.join();
+      // applies what the last block did not take
+      fluid->audioStopped();
+
+      QCOMPARE(failed, 0);
+      QVERIFY(fluid->soundFonts().isEmpty());
+      for (int ch = 0; ch < CHANNELS; ++ch) {
+            unsigned sfontId, bank, program;
+            fluid->get_program(ch, &sfontId, &bank, &program);
+            int last = CHANGES - CHANNELS + ch;
+            QCOMPARE(program, unsigned(last & 0x7f));
+            QVERIFY(!fluid->get_channel_preset(ch));
+            }
+      delete fluid;
+      }
+
+QTEST_MAIN(TestFluidPool)
+#include "tst_fluidpool.moc"
@@ -0,0 +1,289 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+
+#include "synthesizer/event.h"
+#include "synthesizer/synthesizer.h"
+#include "synthesizer/msynthesizer.h"
+#include "synthesizer/parallelrenderer.h"
+#include "mtest/testutils.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   SineSynth
+//    minimal deterministic synthesizer: one sine
+//    oscillator per sounding note
+//---------------------------------------------------------
+
+class SineSynth : public Synthesizer {
+      struct Voice {
+            int channel;
+            int pitch;
+            float amplitude;
+            double phase;
+            double step;
+            };
+      std::vector<Voice> voices;
+      QList<MidiPatch*> patches;
+
+   public:
+      virtual const char* name() const                  { return "Sine"; }
+      virtual bool loadSoundFonts(const QStringList&)   { return true; }
+      virtual QStringList soundFonts() const            { return QStringList(); }
+      virtual const QList<MidiPatch*>& getPatchInfo() const { return patches; }
+      virtual SynthesizerGroup state() const {
+            SynthesizerGroup g;
+            g.setName(name());
+            return g;
+            }
+      virtual bool setState(const SynthesizerGroup&)    { return true; }
+
+      virtual void process(unsigned n, float* p, float*, float*) {
+            for (Voice& v : voices) {
+                  for (unsigned i = 0; i < n; ++i) {
+                        float val = v.amplitude * sin(v.phase);
+                        p[i * 2]     += val;
+                        p[i * 2 + 1] += val * 0.5f;
+                        v.phase += v.step;
+                        }
+                  }
+            }
+      virtual void play(const PlayEvent& e) {
+            if (e.type() == ME_NOTEON && e.velo() > 0) {
+                  Voice v;
+                  v.channel   = e.channel();
+                  v.pitch     = e.pitch();
+                  v.amplitude = e.velo() / 1270.0;
+                  v.phase     = 0.0;
+                  v.step      = 2.0 * M_PI * 440.0 * pow(2.0, (e.pitch() - 69) / 12.0) / _sampleRate;
+                  voices.push_back(v);
+                  }
+            else if (e.type() == ME_NOTEON || e.type() == ME_NOTEOFF) {
+                  for (auto i = voices.begin(); i != voices.end(); ++i) {
+                        if (i->channel == e.channel() && i->pitch == e.pitch()) {
+                              voices.erase(i);
+                              break;
+                              }
+                        }
+                  }
+            }
+      virtual void allNotesOff(int channel) {
+            std::vector<Voice> vl;
+            for (const Voice& v : voices) {
+                  if (channel != -1 && v.channel != channel)
+                        vl.push_back(v);
+                  }
+            voices = vl;
+            }
+      virtual void allSoundsOff(int channel) { allNotesOff(channel); }
+      };
+
+//---------------------------------------------------------
+//   TestParallelRender
+//---------------------------------------------------------
+
+class TestParallelRender : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      static const unsigned FRAMES = 1024;
+      static const int CHANNELS    = 8;
+      static const int LENGTH      = 48000;
+      std::vector<std::pair<int, NPlayEvent>> events;
+
+      MasterSynthesizer* createSynthesizer();
+      std::vector<float> renderSerial();
+      std::vector<float> renderParallel(int instances, std::vector<float>* stems = 0);
+
+   private slots:
+      void initTestCase();
+      void serial();
+      void determinism();
+      void stems();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//    overlapping notes on all channels, sorted by frame
+//---------------------------------------------------------
+
+void TestParallelRender::initTestCase()
+      {
+      initMTest();
+      for (int frame = 0; frame < LENGTH - 8000; frame += 5000) {
+            for (int c = 0; c < CHANNELS; ++c) {
+                  int on = frame + c * 311;
+                  events.push_back(std::make_pair(on, NPlayEvent(ME_NOTEON, c, 60 + c * 2, 100 - c * 5)));
+                  events.push_back(std::make_pair(on + 3000, NPlayEvent(ME_NOTEOFF, c, 60 + c * 2, 0)));
+                  }
+            }
+      std::stable_sort(events.begin(), events.end(),
+         [](const std::pair<int, NPlayEvent>& a, const std::pair<int, NPlayEvent>& b) { return a.first < b.first; });
+      }
+
+//---------------------------------------------------------
+//   createSynthesizer
+//---------------------------------------------------------
+
+MasterSynthesizer* TestParallelRender::createSynthesizer()
+      {
+      MasterSynthesizer* ms = new MasterSynthesizer();
+      ms->registerSynthesizer(new SineSynth);
+      ms->setSampleRate(44100);
+      return ms;
+      }
+
+//---------------------------------------------------------
+//   renderSerial
+//    the way saveAudio() renders with one synthesizer
+//---------------------------------------------------------
+
+std::vector<float> TestParallelRender::renderSerial()
+      {
+      MasterSynthesizer* synti = createSynthesizer();
+      std::vector<float> out;
+      float buffer[FRAMES * 2];
+      auto ev = events.cbegin();
+      for (int playTime = 0; playTime < LENGTH;) {
+            memset(buffer, 0, sizeof(buffer));
+            int endTime = playTime + FRAMES;
+            float* p = buffer;
+            for (; ev != events.cend() && ev->first < endTime; ++ev) {
+                  int n = ev->first - playTime;
+                  if (n) {
+                        synti->process(n, p);
+                        p += 2 * n;
+                        playTime += n;
+                        }
+                  synti->play(ev->second, 0);
+                  }
+            if (endTime > playTime)
+                  synti->process(endTime - playTime, p);
+            playTime = endTime;
+            out.insert(out.end(), buffer, buffer + FRAMES * 2);
+            }
+      delete synti;
+      return out;
+      }
+
+//---------------------------------------------------------
+//   renderParallel
+//---------------------------------------------------------
+
+std::vector<float> TestParallelRender::renderParallel(int instances, std::vector<float>* stems)
+      {
+      std::vector<MasterSynthesizer*> sl;
+      for (int i = 0; i < instances; ++i)
+            sl.push_back(createSynthesizer());
+      ParallelRenderer renderer(sl);
+      if (stems) {
+            // first half of the channels to the first instance
+            renderer.setStems(true);
+            for (int c = 0; c < CHANNELS; ++c)
+                  renderer.setGroup(c, c < CHANNELS / 2 ? 0 : 1);
+            }
+      std::vector<float> out;
+      float buffer[FRAMES * 2];
+      auto ev = events.cbegin();
+      for (int playTime = 0; playTime < LENGTH; playTime += FRAMES) {
+            for (; ev != events.cend() && ev->first < playTime + int(FRAMES); ++ev)
+                  renderer.play(ev->first - playTime, ev->second, 0);
+            renderer.process(FRAMES, buffer);
+            out.insert(out.end(), buffer, buffer + FRAMES * 2);
+            if (stems) {
+                  for (int i = 0; i < instances; ++i)
+                        stems[i].insert(stems[i].end(), renderer.stem(i), renderer.stem(i) + FRAMES * 2);
+                  }
+            }
+      for (MasterSynthesizer* s : sl)
+            delete s;
+      return out;
+      }
+
+//---------------------------------------------------------
+//   serial
+//    parallel rendering matches the serial renderer up
+//    to float rounding of the mix
+//---------------------------------------------------------
+
+void TestParallelRender::serial()
+      {
+      std::vector<float> ref = renderSerial();
+      for (int instances : { 1, 2, 3, CHANNELS }) {
+            std::vector<float> out = renderParallel(instances);
+            QCOMPARE(out.size(), ref.size());
+            float peak = 0.0;
+            float diff = 0.0;
+            for (size_t i = 0; i < ref.size(); ++i) {
+                  peak = qMax(peak, qAbs(ref[i]));
+                  diff = qMax(diff, qAbs(ref[i] - out[i]));
+                  }
+            QVERIFY(peak > 0.1);
+            QVERIFY(diff < peak * 1e-5);
+            }
+      }
+
+//---------------------------------------------------------
+//   determinism
+//    the mix does not depend on thread scheduling
+//---------------------------------------------------------
+
+void TestParallelRender::determinism()
+      {
+      std::vector<float> ref = renderParallel(4);
+      for (int i = 0; i < 5; ++i)
+            QVERIFY(renderParallel(4) == ref);
+      }
+
+//---------------------------------------------------------
+//   stems
+//    the mix is the full mix rendered without stems, the
+//    stems add up to it and contain only the channels
+//    routed to them
+//---------------------------------------------------------
+
+void TestParallelRender::stems()
+      {
+      std::vector<float> stems[2];
+      std::vector<float> mix = renderParallel(2, stems);
+      std::vector<float> ref = renderSerial();
+      QCOMPARE(mix.size(), ref.size());
+      QCOMPARE(stems[0].size(), mix.size());
+      QCOMPARE(stems[1].size(), mix.size());
+      float peak = 0.0;
+      float diff = 0.0;
+      for (size_t i = 0; i < mix.size(); ++i) {
+            peak = qMax(peak, qAbs(ref[i]));
+            diff = qMax(diff, qAbs(ref[i] - mix[i]));
+            QCOMPARE(mix[i], stems[0][i] + stems[1][i]);
+            }
+      QVERIFY(peak > 0.1);
+      QVERIFY(diff < peak * 1e-5);
+
+      // before the first note of the second half of the channels,
+      // the second stem is silent
+      int firstFrame = (CHANNELS / 2) * 311;
+      float first  = 0.0;
+      float second = 0.0;
+      for (int i = 0; i < firstFrame * 2; ++i) {
+            first  = qMax(first, qAbs(stems[0][i]));
+            second = qMax(second, qAbs(stems[1][i]));
+            }
+      QVERIFY(first > 0.0);
+      QCOMPARE(second, 0.0f);
+      }
+
+QTEST_MAIN(TestParallelRender)
+#include "tst_parallelrender.moc"
+
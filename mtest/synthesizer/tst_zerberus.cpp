@@ -0,0 +1,203 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2016 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <cmath>
+#include <QtTest/QtTest>
+
+#include "zerberus/zerberus.h"
+#include "zerberus/channel.h"
+#include "zerberus/voice.h"
+#include "zerberus/zone.h"
+#include "zerberus/sample.h"
+#include "mtest/testutils.h"
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestZerberus
+//    voice rendering with synthetic samples
+//---------------------------------------------------------
+
+class TestZerberus : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      static const int SAMPLERATE = 44100;
+
+      Zerberus* zerberus;
+
+      Zone* createZone(int channels, int frames);
+      int render(Voice*, int frames, std::vector<float>* out);
+
+   private slots:
+      void initTestCase();
+      void cleanupTestCase();
+      void sampleEnd_data();
+      void sampleEnd();
+      void release();
+      void maxPolyphony_data();
+      void maxPolyphony();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestZerberus::initTestCase()
+      {
+      initMTest();
+      zerberus = new Zerberus;
+      zerberus->init(SAMPLERATE);
+      }
+
+void TestZerberus::cleanupTestCase()
+      {
+      delete zerberus;
+      }
+
+//---------------------------------------------------------
+//   createZone
+//    a zone with a decaying saw tooth sample at middle C
+//---------------------------------------------------------
+
+Zone* TestZerberus::createZone(int channels, int frames)
+      {
+      std::vector<short> data(frames * channels);
+      for (int i = 0; i < frames; ++i) {
+            float decay = 1.0f - float(i) / frames;
+            for (int c = 0; c < channels; ++c)
+                  data[i * channels + c] = short(((i * (c + 3)) % 200 - 100) * 300 * decay);
+            }
+      Zone* z   = new Zone;
+      z->sample = new Sample(channels, data.data(), frames, SAMPLERATE);
+      z->keyBase = 60;
+      return z;
+      }
+
+//---------------------------------------------------------
+//   render
+//    process the voice in blocks of 64 frames until it is
+//    off or frames have been rendered; returns the number
+//    of frames rendered
+//---------------------------------------------------------
+
+int TestZerberus::render(Voice* v, int frames, std::vector<float>* out)
+      {
+      out->assign(frames * 2, 0.0f);
+      int n = 0;
+      while (n < frames && !v->isOff()) {
+            v->process(qMin(64, frames - n), out->data() + n * 2);
+            n += 64;
+            }
+      return qMin(n, frames);
+      }
+
+//---------------------------------------------------------
+//   sampleEnd
+//    a voice played at its root key stops at the end of
+//    the sample
+//---------------------------------------------------------
+
+void TestZerberus::sampleEnd_data()
+      {
+      QTest::addColumn<int>("channels");
+      QTest::newRow("mono")   << 1;
+      QTest::newRow("stereo") << 2;
+      }
+
+void TestZerberus::sampleEnd()
+      {
+      QFETCH(int, channels);
+      Zone* z = createZone(channels, 1000);
+      Voice v(zerberus);
+      v.start(zerberus->channel(0), 60, 100, z);
+      std::vector<float> out;
+      int n = render(&v, 4096, &out);
+      QVERIFY(v.isOff());
+      QVERIFY(n >= 1000 && n < 1100);
+      float peak = 0.0f;
+      for (int i = 0; i < 2000; ++i) {
+            QVERIFY(std::isfinite(out[i]));
+            peak = qMax(peak, qAbs(out[i]));
+            }
+      QVERIFY(peak > 0.01f);
+      for (int i = 2000; i < 4096 * 2; ++i)
+            QCOMPARE(out[i], 0.0f);
+      delete z;
+      }
+
+//---------------------------------------------------------
+//   release
+//    a stopped voice fades out within its release time
+//---------------------------------------------------------
+
+void TestZerberus::release()
+      {
+      Zone* z = createZone(2, SAMPLERATE * 2);
+      z->ampegRelease = 100;
+      Voice v(zerberus);
+      v.start(zerberus->channel(0), 60, 100, z);
+      std::vector<float> out;
+      render(&v, 1024, &out);
+      QVERIFY(!v.isOff());
+      v.stop(100.0);
+      render(&v, SAMPLERATE / 10 + 64, &out);
+      QVERIFY(v.isOff());
+      delete z;
+      }
+
+//---------------------------------------------------------
+//   maxPolyphony
+//    render one second of 256 voices with the sample
+//    transposed over four octaves; prints how many voices
+//    one core can render in realtime
+//---------------------------------------------------------
+
+void TestZerberus::maxPolyphony_data()
+      {
+      QTest::addColumn<int>("channels");
+      QTest::newRow("mono")   << 1;
+      QTest::newRow("stereo") << 2;
+      }
+
+void TestZerberus::maxPolyphony()
+      {
+      QFETCH(int, channels);
+      const int VOICES = 256;
+      const int BLOCK  = 256;
+      Zone* z = createZone(channels, SAMPLERATE * 6);
+      std::vector<Voice*> voices;
+      for (int i = 0; i < VOICES; ++i) {
+            Voice* v = new Voice(zerberus);
+            v->start(zerberus->channel(0), 36 + i % 48, 100, z);
+            voices.push_back(v);
+            }
+      std::vector<float> out(BLOCK * 2);
+
+      QElapsedTimer timer;
+      timer.start();
+      for (int frame = 0; frame < SAMPLERATE; frame += BLOCK) {
+            for (Voice* v : voices)
+                  v->process(BLOCK, out.data());
+            }
+      qint64 ms = qMax(timer.elapsed(), qint64(1));
+
+      for (Voice* v : voices) {
+            QVERIFY(!v->isOff());
+            delete v;
+            }
+      qDebug("%s: %d voices in realtime", channels == 1 ? "mono" : "stereo", int(VOICES * 1000 / ms));
+      delete z;
+      }
+
+QTEST_MAIN(TestZerberus)
+#include "tst_zerberus.moc"
@@ -89,6 +89,7 @@ Element* MTest::writeReadElement(Element* element)
       Xml xml(&buffer);
       xml.header();
       element->write(xml);
+      xml.flush();
       buffer.close();
 
       //
@@ -105,7 +105,7 @@ void Omr::read(XmlReader& e)
       _ocr->init();
 #endif
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "path")
                   _path = e.readElementText();
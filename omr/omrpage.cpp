@@ -30,6 +30,7 @@
 #include "libmscore/measurebase.h"
 #include "libmscore/box.h"
 #include "libmscore/sym.h"
+#include "libmscore/scorearchive.h"
 #include "pattern.h"
 
 namespace Ms {
@@ -80,6 +81,39 @@ OmrPage::OmrPage(Omr* parent)
       cropL = cropR = cropT = cropB = 0;
       }
 
+//---------------------------------------------------------
+//   setImage
+//    the page image is read from archive on first access
+//---------------------------------------------------------
+
+void OmrPage::setImage(QSharedPointer<ScoreArchive> archive, const QString& path)
+      {
+      _image       = QImage();
+      _archive     = archive;
+      _archivePath = path;
+      }
+
+//---------------------------------------------------------
+//   archivedImage
+//    PNG data of a page image which was not decoded yet
+//---------------------------------------------------------
+
+QByteArray OmrPage::archivedImage() const
+      {
+      return _archive ? _archive->fileData(_archivePath) : QByteArray();
+      }
+
+//---------------------------------------------------------
+//   loadImage
+//---------------------------------------------------------
+
+void OmrPage::loadImage() const
+      {
+      if (!_image.loadFromData(_archive->fileData(_archivePath), "PNG"))
+            qDebug("load image failed");
+      _archive.clear();
+      }
+
 //---------------------------------------------------------
 //   dot
 //---------------------------------------------------------
@@ -625,14 +659,14 @@ void OmrPage::readHeader(Score*)
       //
       // assume that highest slice contains header text
       //
-      OcrImage img = OcrImage(_image.bits(), _slices[maxIdx], (_image.width() + 31)/32);
+      OcrImage img = OcrImage(image().bits(), _slices[maxIdx], (image().width() + 31)/32);
       QString s    = _omr->ocr()->readLine(img).trimmed();
       if (!s.isEmpty())
             score->addText("title", s);
 
       QString subTitle;
       for (int i = maxIdx + 1; i < slice; ++i) {
-            OcrImage img = OcrImage(_image.bits(), _slices[i], (_image.width() + 31)/32);
+            OcrImage img = OcrImage(image().bits(), _slices[i], (image().width() + 31)/32);
             QString s = _omr->ocr()->readLine(img).trimmed();
             if (!s.isEmpty()) {
                   if (!subTitle.isEmpty())
@@ -644,17 +678,17 @@ void OmrPage::readHeader(Score*)
             score->addText("subtitle", subTitle);
 #endif
 #if 0
-      OcrImage img = OcrImage(_image.bits(), _slices[0], (_image.width() + 31)/32);
+      OcrImage img = OcrImage(image().bits(), _slices[0], (image().width() + 31)/32);
       QString s = _omr->ocr()->readLine(img).trimmed();
       if (!s.isEmpty())
             addText(score, TEXT_TITLE, s);
 
-      img = OcrImage(_image.bits(), _slices[1], (_image.width() + 31)/32);
+      img = OcrImage(image().bits(), _slices[1], (image().width() + 31)/32);
       s = _omr->ocr()->readLine(img).trimmed();
       if (!s.isEmpty())
             addText(score, TEXT_SUBTITLE, s);
 
-      img = OcrImage(_image.bits(), _slices[2], (_image.width() + 31)/32);
+      img = OcrImage(image().bits(), _slices[2], (image().width() + 31)/32);
       s = _omr->ocr()->readLine(img).trimmed();
       if (!s.isEmpty())
             addText(score, TEXT_COMPOSER, s);
@@ -832,7 +866,7 @@ void OmrPage::deSkew()
                         }
                   }
             }
-      memcpy(_image.bits(), db, wl * h * sizeof(uint));
+      memcpy(image().bits(), db, wl * h * sizeof(uint));
       delete[] db;
       }
 
@@ -1155,7 +1189,7 @@ void OmrPage::write(Xml& xml) const
 void OmrPage::read(XmlReader& e)
       {
       while (e.readNextStartElement()) {
-            const QStringRef& tag(e.name());
+            const XmlTag& tag(e.name());
 
             if (tag == "cropL")
                   cropL = e.readInt();
@@ -33,6 +33,7 @@ class Xml;
 class XmlReader;
 class Pattern;
 class OmrPage;
+class ScoreArchive;
 
 //---------------------------------------------------------
 //   HLine
@@ -181,7 +182,9 @@ class OmrSystem {
 
 class OmrPage {
       Omr* _omr;
-      QImage _image;
+      mutable QImage _image;
+      mutable QSharedPointer<ScoreArchive> _archive;  // source of a not yet decoded page image
+      QString _archivePath;
       double _spatium;
 
       int cropL, cropR;       // crop values in words (32 bit) units
@@ -206,18 +209,22 @@ class OmrPage {
       OmrClef searchClef(OmrSystem* system, OmrStaff* staff);
       void searchKeySig(OmrSystem* system, OmrStaff* staff);
       OmrPattern searchPattern(const std::vector<Pattern*>& pl, int y, int x1, int x2);
+      void loadImage() const;
 
    public:
       OmrPage(Omr* _parent);
-      void setImage(const QImage& i)     { _image = i; }
-      const QImage& image() const        { return _image; }
-      QImage& image()                    { return _image; }
+      void setImage(const QImage& i)     { _image = i; _archive.clear(); }
+      void setImage(QSharedPointer<ScoreArchive>, const QString& path);
+      bool imageLoaded() const           { return !_archive; }
+      QByteArray archivedImage() const;
+      const QImage& image() const        { if (_archive) loadImage(); return _image; }
+      QImage& image()                    { if (_archive) loadImage(); return _image; }
       void read();
-      int width() const                  { return _image.width(); }
-      int height() const                 { return _image.height(); }
-      const uint* scanLine(int y) const  { return (const uint*)_image.scanLine(y); }
-      const uint* bits() const           { return (const uint*)_image.bits(); }
-      int wordsPerLine() const           { return (_image.bytesPerLine() + 3)/4; }
+      int width() const                  { return image().width(); }
+      int height() const                 { return image().height(); }
+      const uint* scanLine(int y) const  { return (const uint*)image().scanLine(y); }
+      const uint* bits() const           { return (const uint*)image().bits(); }
+      int wordsPerLine() const           { return (image().bytesPerLine() + 3)/4; }
 
       const QList<QLine>& sl()           { return lines;    }
       const QList<HLine>& l()            { return slines;   }
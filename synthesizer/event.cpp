@@ -340,5 +340,112 @@ void EventList::insert(const Event& e)
             }
       append(e);
       }
-}
 
+//---------------------------------------------------------
+//   sort
+//---------------------------------------------------------
+
+void EventMap::sort() const
+      {
+      std::stable_sort(_events.begin(), _events.end(),
+         [](const value_type& a, const value_type& b) { return a.first < b.first; });
+      _sorted = true;
+      }
+
+//---------------------------------------------------------
+//   insert
+//    append a range of events
+//---------------------------------------------------------
+
+void EventMap::insert(const_iterator b, const_iterator e)
+      {
+      if (b == e)
+            return;
+      if (!_events.empty() && b->first < _events.back().first)
+            _sorted = false;
+      for (const_iterator i = b + 1; _sorted && i != e; ++i) {
+            if (i->first < (i - 1)->first)
+                  _sorted = false;
+            }
+      _events.insert(_events.end(), b, e);
+      }
+
+//---------------------------------------------------------
+//   merge
+//    k-way merge of maps into this map; for equal ticks,
+//    events of this map come first, then the events of
+//    maps in list order
+//---------------------------------------------------------
+
+void EventMap::merge(const std::vector<const EventMap*>& maps)
+      {
+      struct Source {
+            const_iterator i;
+            const_iterator e;
+            int idx;
+            };
+      std::vector<value_type> dst;
+      std::vector<Source> heap;
+      size_t n = size();
+      heap.push_back(Source { begin(), end(), 0 });
+      for (size_t k = 0; k < maps.size(); ++k) {
+            n += maps[k]->size();
+            heap.push_back(Source { maps[k]->begin(), maps[k]->end(), int(k) + 1 });
+            }
+      heap.erase(std::remove_if(heap.begin(), heap.end(), [](const Source& s) { return s.i == s.e; }), heap.end());
+      dst.reserve(n);
+
+      // min heap on (tick, source index)
+      auto greater = [](const Source& a, const Source& b) {
+            return a.i->first > b.i->first || (a.i->first == b.i->first && a.idx > b.idx);
+            };
+      std::make_heap(heap.begin(), heap.end(), greater);
+      while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            Source& s = heap.back();
+            // copy all events of the source up to the next tick
+            // of another source
+            int limit = INT_MAX;
+            int limitIdx = INT_MAX;
+            if (heap.size() > 1) {
+                  limit    = heap.front().i->first;
+                  limitIdx = heap.front().idx;
+                  }
+            do {
+                  dst.push_back(*s.i);
+                  ++s.i;
+                  } while (s.i != s.e && (s.i->first < limit || (s.i->first == limit && s.idx < limitIdx)));
+            if (s.i == s.e)
+                  heap.pop_back();
+            else
+                  std::push_heap(heap.begin(), heap.end(), greater);
+            }
+      _events.swap(dst);
+      _sorted = true;
+      }
+
+//---------------------------------------------------------
+//   lower_bound
+//    first event at or after tick
+//---------------------------------------------------------
+
+EventMap::const_iterator EventMap::lower_bound(int tick) const
+      {
+      const std::vector<value_type>& ev = events();
+      return std::lower_bound(ev.begin(), ev.end(), tick,
+         [](const value_type& a, int t) { return a.first < t; });
+      }
+
+//---------------------------------------------------------
+//   upper_bound
+//    first event after tick
+//---------------------------------------------------------
+
+EventMap::const_iterator EventMap::upper_bound(int tick) const
+      {
+      const std::vector<value_type>& ev = events();
+      return std::upper_bound(ev.begin(), ev.end(), tick,
+         [](int t, const value_type& a) { return t < a.first; });
+      }
+
+}
@@ -14,6 +14,7 @@
 #define __EVENT_H__
 
 #include <map>
+#include <vector>
 
 namespace Ms {
 
@@ -308,7 +309,56 @@ class EventList : public QList<Event> {
       void insertNote(int channel, Note*);
       };
 
-class EventMap : public std::multimap<int, NPlayEvent> {};
+//---------------------------------------------------------
+//   EventMap
+//    play events in one contiguous array sorted by tick.
+//    Events inserted out of order are sorted on the next
+//    access; events with the same tick keep their insertion
+//    order (like in a std::multimap).
+//    The sequencer reads the array from the realtime
+//    thread, so it must be accessed once from the thread
+//    which built it before it is handed over.
+//---------------------------------------------------------
+
+class EventMap {
+   public:
+      typedef std::pair<int, NPlayEvent> value_type;
+      typedef std::vector<value_type>::const_iterator const_iterator;
+      typedef const_iterator iterator;
+
+   private:
+      mutable std::vector<value_type> _events;
+      mutable bool _sorted;
+
+      void sort() const;
+      const std::vector<value_type>& events() const {
+            if (!_sorted)
+                  sort();
+            return _events;
+            }
+
+   public:
+      EventMap() : _sorted(true) {}
+
+      void insert(const value_type& e) {
+            if (!_events.empty() && e.first < _events.back().first)
+                  _sorted = false;
+            _events.push_back(e);
+            }
+      void insert(const_iterator b, const_iterator e);
+      void merge(const std::vector<const EventMap*>&);
+      void reserve(size_t n)                    { _events.reserve(n);   }
+      void clear()                              { _events.clear(); _sorted = true; }
+      bool empty() const                        { return _events.empty(); }
+      size_t size() const                       { return _events.size(); }
+
+      const_iterator begin() const              { return events().begin(); }
+      const_iterator end() const                { return events().end();   }
+      const_iterator cbegin() const             { return events().begin(); }
+      const_iterator cend() const               { return events().end();   }
+      const_iterator lower_bound(int tick) const;
+      const_iterator upper_bound(int tick) const;
+      };
 
 typedef EventList::iterator iEvent;
 typedef EventList::const_iterator ciEvent;
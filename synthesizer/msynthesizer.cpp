@@ -256,21 +256,85 @@ void MasterSynthesizer::setSampleRate(float val)
 
 void MasterSynthesizer::process(unsigned n, float* p)
       {
-      if (lock2)
+      if (lock2) {
+            ++_dropouts;
             return;
+            }
       lock1 = true;
       if (lock2) {
             lock1 = false;
+            ++_dropouts;
             return;
             }
       // avoid overflow
       if (n > MAX_BUFFERSIZE / 2)
             return;
+      processSynthesizers(n, p);
+      processEffects(n, p);
+      lock1 = false;
+      }
+
+//---------------------------------------------------------
+//   dropouts
+//    number of audio blocks which were skipped or not
+//    rendered in time, for monitoring
+//---------------------------------------------------------
+
+int MasterSynthesizer::dropouts() const
+      {
+      int n = _dropouts;
+      for (Synthesizer* s : _synthesizer)
+            n += s->dropouts();
+      return n;
+      }
+
+//---------------------------------------------------------
+//   setStreaming
+//    the realtime synthesizer loads sample data in the
+//    background instead of blocking the audio thread;
+//    offline renderers keep loading synchronously
+//---------------------------------------------------------
+
+void MasterSynthesizer::setStreaming(bool val)
+      {
+      for (Synthesizer* s : _synthesizer)
+            s->setStreaming(val);
+      }
+
+//---------------------------------------------------------
+//   audioStopped
+//    called after the driver is stopped; synthesizers
+//    apply changes directly from now on
+//---------------------------------------------------------
+
+void MasterSynthesizer::audioStopped()
+      {
+      for (Synthesizer* s : _synthesizer)
+            s->audioStopped();
+      }
+
+//---------------------------------------------------------
+//   processSynthesizers
+//    add the dry output of all active synthesizers to p;
+//    does not lock, only for offline rendering or from
+//    process()
+//---------------------------------------------------------
+
+void MasterSynthesizer::processSynthesizers(unsigned n, float* p)
+      {
       for (Synthesizer* s : _synthesizer) {
             if (s->active())
                   s->process(n, p, effect1Buffer, effect2Buffer);
             }
+      }
 
+//---------------------------------------------------------
+//   processEffects
+//    apply master effects and gain to p
+//---------------------------------------------------------
+
+void MasterSynthesizer::processEffects(unsigned n, float* p)
+      {
       if (_effect[0] && _effect[1]) {
             memset(effect1Buffer, 0, n * sizeof(float) * 2);
             _effect[0]->process(n, p, effect1Buffer);
@@ -286,7 +350,6 @@ void MasterSynthesizer::process(unsigned n, float* p)
       float g = _gain * _boost;
       for (unsigned i = 0; i < n * 2; ++i)
             *p++ *= g;
-      lock1 = false;
       }
 
 //---------------------------------------------------------
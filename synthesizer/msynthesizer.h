@@ -44,6 +44,7 @@ class MasterSynthesizer : public QObject {
    private:
       std::atomic<bool> lock1      { false };
       std::atomic<bool> lock2      { true  };
+      std::atomic<int> _dropouts   { 0 };      // blocks skipped in process()
       std::vector<Synthesizer*> _synthesizer;
       std::vector<Effect*> _effectList[MAX_EFFECTS];
       Effect* _effect[MAX_EFFECTS]  { nullptr, nullptr };
@@ -73,7 +74,12 @@ class MasterSynthesizer : public QObject {
       void setSampleRate(float val);
 
       void process(unsigned, float*);
+      void processSynthesizers(unsigned, float*);
+      void processEffects(unsigned, float*);
       void play(const NPlayEvent&, unsigned);
+      int dropouts() const;
+      void audioStopped();
+      void setStreaming(bool);
 
       void setMasterTuning(double val);
       double masterTuning() const      { return _masterTuning; }
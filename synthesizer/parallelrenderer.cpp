@@ -0,0 +1,155 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "parallelrenderer.h"
+#include "msynthesizer.h"
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   ParallelRenderer
+//    synthesizer instances must be initialized with the
+//    same state and sample rate; the first one provides
+//    the master effects
+//---------------------------------------------------------
+
+ParallelRenderer::ParallelRenderer(const std::vector<MasterSynthesizer*>& sl)
+      {
+      for (MasterSynthesizer* s : sl) {
+            Group g;
+            g.synti = s;
+            g.buffer.resize(MasterSynthesizer::MAX_BUFFERSIZE);
+            _groups.push_back(g);
+            }
+      }
+
+//---------------------------------------------------------
+//   group
+//    channels without explicit group are distributed
+//    round robin
+//---------------------------------------------------------
+
+int ParallelRenderer::group(int channel) const
+      {
+      if (channel >= 0 && channel < int(_channelGroup.size()) && _channelGroup[channel] >= 0)
+            return _channelGroup[channel];
+      return channel % groups();
+      }
+
+//---------------------------------------------------------
+//   setGroup
+//---------------------------------------------------------
+
+void ParallelRenderer::setGroup(int channel, int group)
+      {
+      if (channel < 0 || group < 0 || group >= groups())
+            return;
+      if (channel >= int(_channelGroup.size()))
+            _channelGroup.resize(channel + 1, -1);
+      _channelGroup[channel] = group;
+      }
+
+//---------------------------------------------------------
+//   play
+//    queue event for the next call of process();
+//    frame is the offset into that block
+//---------------------------------------------------------
+
+void ParallelRenderer::play(unsigned frame, const NPlayEvent& e, unsigned syntiIdx)
+      {
+      QueuedEvent qe;
+      qe.frame = frame;
+      qe.synti = syntiIdx;
+      qe.event = e;
+      _groups[group(e.channel())].events.push_back(qe);
+      }
+
+//---------------------------------------------------------
+//   render
+//    render the dry signal of one group, playing the
+//    queued events at their frames
+//---------------------------------------------------------
+
+void ParallelRenderer::render(Group& g, unsigned n)
+      {
+      float* p = g.buffer.data();
+      memset(p, 0, n * 2 * sizeof(float));
+      unsigned pos = 0;
+      for (const QueuedEvent& e : g.events) {
+            if (e.frame > pos) {
+                  g.synti->processSynthesizers(e.frame - pos, p + pos * 2);
+                  pos = e.frame;
+                  }
+            g.synti->play(e.event, e.synti);
+            }
+      if (pos < n)
+            g.synti->processSynthesizers(n - pos, p + pos * 2);
+      g.events.clear();
+      }
+
+//---------------------------------------------------------
+//   process
+//    render n frames of the mix into p (overwriting it)
+//---------------------------------------------------------
+
+void ParallelRenderer::process(unsigned n, float* p)
+      {
+      if (n > MasterSynthesizer::MAX_BUFFERSIZE / 2)
+            return;
+      QtConcurrent::blockingMap(_groups, [n](Group& g) { render(g, n); });
+
+      memcpy(p, _groups[0].buffer.data(), n * 2 * sizeof(float));
+      for (size_t i = 1; i < _groups.size(); ++i) {
+            const float* src = _groups[i].buffer.data();
+            for (unsigned k = 0; k < n * 2; ++k)
+                  p[k] += src[k];
+            }
+      MasterSynthesizer* master = _groups[0].synti;
+      master->processEffects(n, p);
+
+      // stems get the gain processEffects() applied to the mix
+      if (_stems) {
+            float g = master->gain() * master->boost();
+            for (Group& gr : _groups) {
+                  float* s = gr.buffer.data();
+                  for (unsigned k = 0; k < n * 2; ++k)
+                        s[k] *= g;
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   allSoundsOff
+//---------------------------------------------------------
+
+void ParallelRenderer::allSoundsOff(int channel)
+      {
+      for (int i = 0; i < groups(); ++i) {
+            if (channel == -1 || group(channel) == i)
+                  _groups[i].synti->allSoundsOff(channel);
+            }
+      }
+
+//---------------------------------------------------------
+//   allNotesOff
+//---------------------------------------------------------
+
+void ParallelRenderer::allNotesOff(int channel)
+      {
+      for (int i = 0; i < groups(); ++i) {
+            if (channel == -1 || group(channel) == i)
+                  _groups[i].synti->allNotesOff(channel);
+            }
+      }
+
+}
+
@@ -0,0 +1,73 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __PARALLELRENDERER_H__
+#define __PARALLELRENDERER_H__
+
+#include "event.h"
+
+namespace Ms {
+
+class MasterSynthesizer;
+
+//---------------------------------------------------------
+//   ParallelRenderer
+//    offline rendering with several MasterSynthesizer
+//    instances. MIDI channels are distributed over the
+//    instances, which render their dry signal on worker
+//    threads. The signals are summed in instance order and
+//    the effects of the first instance are applied once
+//    to the sum, so the result does not depend on thread
+//    scheduling.
+//    In stem mode the dry signal of every instance, scaled
+//    by the master gain, is available as stem() after
+//    process(). The mix is rendered as without stems, so
+//    the stems are pre-effect: without master effects they
+//    add up to the mix.
+//---------------------------------------------------------
+
+class ParallelRenderer {
+      struct QueuedEvent {
+            unsigned frame;               // offset in current block
+            unsigned synti;
+            NPlayEvent event;
+            };
+      struct Group {
+            MasterSynthesizer* synti;
+            std::vector<QueuedEvent> events;
+            std::vector<float> buffer;
+            };
+      std::vector<Group> _groups;
+      std::vector<int> _channelGroup;     // explicit channel to group mapping
+      bool _stems { false };
+
+      static void render(Group&, unsigned n);
+
+   public:
+      ParallelRenderer(const std::vector<MasterSynthesizer*>&);
+
+      int groups() const            { return int(_groups.size()); }
+      int group(int channel) const;
+      void setGroup(int channel, int group);
+
+      void setStems(bool val)       { _stems = val; }
+      const float* stem(int group) const { return _groups[group].buffer.data(); }
+
+      void play(unsigned frame, const NPlayEvent&, unsigned syntiIdx);
+      void process(unsigned n, float* p);
+      void allSoundsOff(int channel);
+      void allNotesOff(int channel);
+      };
+
+}
+#endif
+
@@ -52,6 +52,9 @@ class Synthesizer {
 
       virtual void process(unsigned, float*, float*, float*) = 0;
       virtual void play(const PlayEvent&) = 0;
+      virtual int dropouts() const { return 0; }   // blocks not rendered in time
+      virtual void audioStopped() {}               // the driver does not call process() anymore
+      virtual void setStreaming(bool) {}           // load sample data in the background
 
       virtual const QList<MidiPatch*>& getPatchInfo() const = 0;
 
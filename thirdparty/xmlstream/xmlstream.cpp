@@ -2094,17 +2094,30 @@ void XmlStreamReader::addExtraNamespaceDeclarations(const XmlStreamNamespaceDecl
  */
 QString XmlStreamReader::readElementText(ReadElementTextBehaviour behaviour)
 {
-    Q_D(XmlStreamReader);
     if (isStartElement()) {
         QString result;
+        readElementText(&result, behaviour);
+        return result;
+    }
+    return QString();
+}
+
+/*!  \overload
+  Appends the text to \a result instead of returning it. Reusing
+  \a result avoids allocating a new string for every element.
+ */
+void XmlStreamReader::readElementText(QString* result, ReadElementTextBehaviour behaviour)
+{
+    Q_D(XmlStreamReader);
+    if (isStartElement()) {
         forever {
             switch (readNext()) {
             case Characters:
             case EntityReference:
-                result.insert(result.size(), d->text.unicode(), d->text.size());
+                result->insert(result->size(), d->text.unicode(), d->text.size());
                 break;
             case EndElement:
-                return result;
+                return;
             case ProcessingInstruction:
             case Comment:
                 break;
@@ -2113,7 +2126,7 @@ QString XmlStreamReader::readElementText(ReadElementTextBehaviour behaviour)
                     skipCurrentElement();
                     break;
                 } else if (behaviour == IncludeChildElements) {
-                    result += readElementText(behaviour);
+                    readElementText(result, behaviour);
                     break;
                 }
                 // Fall through (for ErrorOnUnexpectedElement)
@@ -2121,12 +2134,11 @@ QString XmlStreamReader::readElementText(ReadElementTextBehaviour behaviour)
                 if (d->error || behaviour == ErrorOnUnexpectedElement) {
                     if (!d->error)
                         d->raiseError(UnexpectedElementError, XmlStream::tr("Expected character data."));
-                    return result;
+                    return;
                 }
             }
         }
     }
-    return QString();
 }
 
 /*!  Raises a custom error with an optional error \a message.
@@ -296,6 +296,7 @@ public:
         SkipChildElements
     };
     QString readElementText(ReadElementTextBehaviour behaviour = ErrorOnUnexpectedElement);
+    void readElementText(QString* result, ReadElementTextBehaviour behaviour = ErrorOnUnexpectedElement);
 
     QStringRef name() const;
     QStringRef namespaceUri() const;
@@ -12,6 +12,7 @@
 
 #include <stdio.h>
 #include <math.h>
+#include <vector>
 #include <QFile>
 #include <QFileInfo>
 #include <QStringList>
@@ -31,9 +32,27 @@ int ZInstrument::idx;
 //   Sample
 //---------------------------------------------------------
 
+Sample::Sample(int ch, const short* val, int f, int sr)
+   : _channel(ch), _frames(f), _sampleRate(sr)
+      {
+      _stride = PAD_BEGIN + f + PAD_END;
+      _planes = new float[_stride * ch];
+      for (int c = 0; c < ch; ++c) {
+            float* p = _planes + c * _stride + PAD_BEGIN;
+            for (int i = 0; i < f; ++i)
+                  p[i] = val[i * ch + c];
+            float first = f ? p[0] : 0.0f;
+            float last  = f ? p[f - 1] : 0.0f;
+            for (int i = 1; i <= PAD_BEGIN; ++i)
+                  p[-i] = first;
+            for (int i = 0; i < PAD_END; ++i)
+                  p[f + i] = last;
+            }
+      }
+
 Sample::~Sample()
       {
-      delete[] _data;
+      delete[] _planes;
       }
 
 //---------------------------------------------------------
@@ -70,19 +89,12 @@ Sample* ZInstrument::readSample(const QString& s, MQZipReader* uz)
       int frames  = a.frames();
       int sr      = a.samplerate();
 
-      short* data = new short[(frames + 3) * channel];
-      Sample* sa  = new Sample(channel, data, frames, sr);
-
-      if (frames != a.read(data + channel, frames)) {
+      std::vector<short> data(frames * channel);
+      if (frames != a.read(data.data(), frames)) {
             qDebug("Sample read failed: %s\n", a.error());
-            delete sa;
-            sa = 0;
-            }
-      for (int i = 0; i < channel; ++i) {
-            data[i]                        = data[channel + i];
-            data[(frames-1) * channel + i] = data[(frames-3) * channel + i];
-            data[(frames-2) * channel + i] = data[(frames-3) * channel + i];
+            return 0;
             }
+      Sample* sa = new Sample(channel, data.data(), frames, sr);
       return sa;
       }
 
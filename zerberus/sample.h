@@ -15,23 +15,29 @@
 
 //---------------------------------------------------------
 //   Sample
+//    one float plane per audio channel. Each plane is padded
+//    with copies of the first and last frame so that the
+//    cubic interpolation needs no range checks.
 //---------------------------------------------------------
 
 class Sample {
       int _channel;
-      short* _data;
+      float* _planes;
+      int _stride;            // floats per plane
       int _frames;
       int _sampleRate;
 
    public:
-      Sample(int ch, short* val, int f, int sr)
-         : _channel(ch), _data(val), _frames(f), _sampleRate(sr) {}
+      static const int PAD_BEGIN = 1;
+      static const int PAD_END   = 3;
+
+      Sample(int ch, const short* val, int f, int sr);
       ~Sample();
       bool read(const QString&);
-      int frames() const     { return _frames;          }
-      short* data() const    { return _data + _channel; }
-      int channel() const    { return _channel;         }
-      int sampleRate() const { return _sampleRate;      }
+      int frames() const                  { return _frames;          }
+      const float* data(int ch) const     { return _planes + ch * _stride + PAD_BEGIN; }
+      int channel() const                 { return _channel;         }
+      int sampleRate() const              { return _sampleRate;      }
       };
 
 #endif
@@ -20,6 +20,11 @@
 #include "sample.h"
 #include "synthesizer/msynthesizer.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ZERBERUS_SSE2
+#include <emmintrin.h>
+#endif
+
 float Voice::interpCoeff[INTERP_MAX][4];
 float Envelope::egPow[EG_SIZE];
 float Envelope::egLin[EG_SIZE];
@@ -99,8 +104,9 @@ void Voice::start(Channel* c, int key, int v, const Zone* z)
       _velocity = v;
       Sample* s = z->sample;
       audioChan = s->channel();
-      data      = s->data() + z->offset * audioChan;
-      eidx      = s->frames() * audioChan;
+      data[0]   = s->data(0) + z->offset;
+      data[1]   = s->data(audioChan > 1 ? 1 : 0) + z->offset;
+      eidx      = s->frames() - z->offset;
       _loopMode = z->loopMode;
 
       _offMode  = z->offMode;
@@ -208,8 +214,148 @@ void Voice::updateFilter(float _fres)
             }
       }
 
+//---------------------------------------------------------
+//   framesToEnd
+//    number of frames, at most n, which can be played
+//    before the phase index reaches end
+//---------------------------------------------------------
+
+static int framesToEnd(Phase phase, Phase incr, int end, int n)
+      {
+      int64_t limit = int64_t(end) << 8;
+      if (phase.data >= limit)
+            return 0;
+      if (incr.data <= 0)
+            return n;
+      int64_t steps = (limit - 1 - phase.data) / incr.data + 1;
+      return steps < n ? int(steps) : n;
+      }
+
+//---------------------------------------------------------
+//   interpolate
+//    cubic interpolation of n frames, scaled by amp. The
+//    sample planes are padded, so no range checks are needed.
+//---------------------------------------------------------
+
+static void interpolate(const float* data, const float (*table)[4], Phase phase, Phase incr,
+   const float* amp, int n, float* out)
+      {
+      int i = 0;
+#ifdef ZERBERUS_SSE2
+      // four frames at a time: points and coefficients are loaded
+      // per frame and transposed into one vector per tap
+      for (; i + 4 <= n; i += 4) {
+            const float* c[4];
+            const float* d[4];
+            for (int l = 0; l < 4; ++l) {
+                  c[l] = table[phase.fract()];
+                  d[l] = data + phase.index() - 1;
+                  phase += incr;
+                  }
+            __m128 c0 = _mm_loadu_ps(c[0]);
+            __m128 c1 = _mm_loadu_ps(c[1]);
+            __m128 c2 = _mm_loadu_ps(c[2]);
+            __m128 c3 = _mm_loadu_ps(c[3]);
+            __m128 d0 = _mm_loadu_ps(d[0]);
+            __m128 d1 = _mm_loadu_ps(d[1]);
+            __m128 d2 = _mm_loadu_ps(d[2]);
+            __m128 d3 = _mm_loadu_ps(d[3]);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _MM_TRANSPOSE4_PS(d0, d1, d2, d3);
+            __m128 v = _mm_mul_ps(c0, d0);
+            v = _mm_add_ps(v, _mm_mul_ps(c1, d1));
+            v = _mm_add_ps(v, _mm_mul_ps(c2, d2));
+            v = _mm_add_ps(v, _mm_mul_ps(c3, d3));
+            _mm_storeu_ps(out + i, _mm_mul_ps(v, _mm_loadu_ps(amp + i)));
+            }
+#endif
+      for (; i < n; ++i) {
+            const float* c = table[phase.fract()];
+            const float* d = data + phase.index();
+            out[i] = (c[0] * d[-1] + c[1] * d[0] + c[2] * d[1] + c[3] * d[2]) * amp[i];
+            phase += incr;
+            }
+      }
+
+//---------------------------------------------------------
+//   filter
+//    the biquad low pass in Direct-II form, with constant
+//    coefficients
+//---------------------------------------------------------
+
+static void filter(float* buf, int n, float a1, float a2, float b02, float b1, float& hist1, float& hist2)
+      {
+      float h1 = hist1;
+      float h2 = hist2;
+      for (int i = 0; i < n; ++i) {
+            float f = buf[i] - a1 * h1 - a2 * h2;
+            buf[i]  = b02 * (f + h2) + b1 * h1;
+            h2      = h1;
+            h1      = f;
+            }
+      hist1 = h1;
+      hist2 = h2;
+      }
+
+//---------------------------------------------------------
+//   mix
+//    add the panned left and right planes to the
+//    interleaved output
+//---------------------------------------------------------
+
+static void mix(const float* l, const float* r, int n, float leftGain, float rightGain, float* p)
+      {
+      int i = 0;
+#ifdef ZERBERUS_SSE2
+      __m128 lg = _mm_set1_ps(leftGain);
+      __m128 rg = _mm_set1_ps(rightGain);
+      for (; i + 4 <= n; i += 4) {
+            __m128 lv = _mm_mul_ps(_mm_loadu_ps(l + i), lg);
+            __m128 rv = _mm_mul_ps(_mm_loadu_ps(r + i), rg);
+            float* o  = p + i * 2;
+            _mm_storeu_ps(o,     _mm_add_ps(_mm_loadu_ps(o),     _mm_unpacklo_ps(lv, rv)));
+            _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), _mm_unpackhi_ps(lv, rv)));
+            }
+#endif
+      for (; i < n; ++i) {
+            p[i * 2]     += l[i] * leftGain;
+            p[i * 2 + 1] += r[i] * rightGain;
+            }
+      }
+
+//---------------------------------------------------------
+//   envelope
+//    gain of the next frames; returns the number of frames
+//    before the release is finished
+//---------------------------------------------------------
+
+int Voice::envelope(int frames, float* amp)
+      {
+      for (int i = 0; i < frames; ++i) {
+            float e = 1.0f;
+            if (_state == VoiceState::ATTACK) {
+                  if (attackEnv.step())
+                        _state = VoiceState::PLAYING;
+                  else
+                        e = attackEnv.val;
+                  }
+            else if (_state == VoiceState::STOP) {
+                  if (stopEnv.step()) {
+                        off();
+                        return i;
+                        }
+                  e = stopEnv.val;
+                  }
+            amp[i] = gain * e;
+            }
+      return frames;
+      }
+
 //---------------------------------------------------------
 //   process
+//    render in blocks: envelope, interpolation, filter and
+//    mixing each run over a whole block without per frame
+//    branches
 //---------------------------------------------------------
 
 void Voice::process(int frames, float* p)
@@ -232,111 +378,41 @@ void Voice::process(int frames, float* p)
             last_fres = _fres;
             }
 
-      if (audioChan == 1) {
-            while (frames--) {
-                  int idx = phase.index();
-                  if (idx >= eidx) {
-                        off();
-                        break;
-                        }
-                  const float* coeffs = interpCoeff[phase.fract()];
-                  float f;
-                  f =  (coeffs[0] * data[idx-1]
-                      + coeffs[1] * data[idx+0]
-                      + coeffs[2] * data[idx+1]
-                      + coeffs[3] * data[idx+2]) * gain
-                      - a1 * hist1l
-                      - a2 * hist2l;
-                  float v = b02 * (f + hist2l) + b1 * hist1l;
-                  hist2l  = hist1l;
-                  hist1l  = f;
-
-                  if (filter_coeff_incr_count) {
-                        --filter_coeff_incr_count;
-                        a1  += a1_incr;
-                        a2  += a2_incr;
-                        b02 += b02_incr;
-                        b1  += b1_incr;
-                        }
-
-                  if (_state == VoiceState::STOP) {
-                        if (stopEnv.step()) {
-                              off();
-                              break;
-                              }
-                        v *= stopEnv.val;
-                        }
-                  *p++  += v * _channel->panLeftGain();
-                  *p++  += v * _channel->panRightGain();
-                  phase += phaseIncr;
+      static const int BLOCK = 256;
+      float amp[BLOCK];
+      float left[BLOCK];
+      float right[BLOCK];
+      bool stereo = audioChan > 1;
+
+      while (frames > 0 && _state != VoiceState::OFF) {
+            int n     = qMin(frames, BLOCK);
+            int k     = framesToEnd(phase, phaseIncr, eidx, n);
+            bool done = k < n;            // end of sample
+            k         = envelope(k, amp);
+
+            // the filter coefficients move once per block
+            if (filter_coeff_incr_count) {
+                  int steps = qMin(filter_coeff_incr_count, k);
+                  a1  += a1_incr * steps;
+                  a2  += a2_incr * steps;
+                  b02 += b02_incr * steps;
+                  b1  += b1_incr * steps;
+                  filter_coeff_incr_count -= steps;
                   }
-            }
-      else {
-            //
-            // handle interleaved stereo samples
-            //
-            while (frames--) {
-                  int idx = phase.index() * 2;
-                  if (idx >= eidx) {
-                        off();
-                        // printf("end of sample\n");
-                        break;
-                        }
-
-                  const float* coeffs = interpCoeff[phase.fract()];
-                  float f1, f2;
-
-                  f1 = (coeffs[0] * data[idx-2]
-                      + coeffs[1] * data[idx]
-                      + coeffs[2] * data[idx+2]
-                      + coeffs[3] * data[idx+4])
-                      * gain * _channel->panLeftGain();
-
-                  f2 = (coeffs[0] * data[idx-1]
-                      + coeffs[1] * data[idx+1]
-                      + coeffs[2] * data[idx+3]
-                      + coeffs[3] * data[idx+5])
-                      * gain * _channel->panRightGain();
-
-                  if (_state == VoiceState::ATTACK) {
-                        if (attackEnv.step())
-                              _state = VoiceState::PLAYING;
-                        else {
-                              f1 *= attackEnv.val;
-                              f2 *= attackEnv.val;
-                              }
-                        }
-                  else if (_state == VoiceState::STOP) {
-                        if (stopEnv.step()) {
-                              off();
-                              break;
-                              }
-                        f1 *= stopEnv.val;
-                        f2 *= stopEnv.val;
-                        }
 
-                  f1      += -a1 * hist1l - a2 * hist2l;
-                  float vl = b02 * (f1 + hist2l) + b1 * hist1l;
-                  hist2l   = hist1l;
-                  hist1l   = f1;
-
-                  f2      +=  -a1 * hist1r - a2 * hist2r;
-                  float vr = b02 * (f2 + hist2r) + b1 * hist1r;
-                  hist2r   = hist1r;
-                  hist1r   = f2;
-
-                  if (filter_coeff_incr_count) {
-                        --filter_coeff_incr_count;
-                        a1  += a1_incr;
-                        a2  += a2_incr;
-                        b02 += b02_incr;
-                        b1  += b1_incr;
-                        }
-
-                  *p++  += vl;
-                  *p++  += vr;
-                  phase += phaseIncr;
+            interpolate(data[0], interpCoeff, phase, phaseIncr, amp, k, left);
+            filter(left, k, a1, a2, b02, b1, hist1l, hist2l);
+            if (stereo) {
+                  interpolate(data[1], interpCoeff, phase, phaseIncr, amp, k, right);
+                  filter(right, k, a1, a2, b02, b1, hist1r, hist2r);
                   }
+            mix(left, stereo ? right : left, k, _channel->panLeftGain(), _channel->panRightGain(), p);
+
+            phase.data += phaseIncr.data * k;
+            p          += k * 2;
+            frames     -= k;
+            if (done)
+                  off();
             }
       }
 
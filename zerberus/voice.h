@@ -102,8 +102,8 @@ class Voice {
       int _velocity;
       int audioChan;
 
-      short* data;
-      int eidx;
+      const float* data[2];   // sample planes, left and right
+      int eidx;               // frames to play
       LoopMode _loopMode;
       OffMode _offMode;
       int _offBy;
@@ -147,6 +147,7 @@ class Voice {
       static float interpCoeff[INTERP_MAX][4];
 
       void updateFilter(float fres);
+      int envelope(int frames, float* amp);
 
    public:
       Voice(Zerberus*);